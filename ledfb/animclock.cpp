@@ -0,0 +1,39 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include "animclock.hpp"
+
+unsigned AnimationClock::advance(uint32_t now){
+    if (!_running){
+        reset(now);
+        return 0;
+    }
+
+    // unsigned math is safe for timer wrap
+    _acc += now - _last;
+    _last = now;
+
+    unsigned steps = _acc / _step;
+    _acc -= steps * _step;
+    if (steps > _max_steps){
+        // catch-up limit reached, drop excess time
+        _dropped += (steps - _max_steps) * _step;
+        steps = _max_steps;
+    }
+    _ticks += steps;
+    return steps;
+}
+
+void AnimationClock::update(uint32_t now){
+    unsigned steps = advance(now);
+    if (_step_cb){
+        for (uint32_t t = _ticks - steps; t != _ticks; )
+            _step_cb(++t);
+    }
+    if (_render_cb)
+        _render_cb(alpha());
+}
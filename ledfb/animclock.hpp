@@ -0,0 +1,97 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <stdint.h>
+#include <functional>
+
+/**
+ * @brief Fixed-timestep animation clock
+ * decouples effect's simulation rate from display frame rate. Simulation is advanced in fixed time steps,
+ * so animation speed does not depend on render time, while rendering could interpolate between last two simulation states.
+ * If rendering overruns, a number of simulation steps per frame is limited by catch-up limit,
+ * excess time is dropped, i.e. animation slows down instead of stalling the display completely.
+ * 
+ * Clock could be driven manually with advance()/update() or attached to DisplayEngine, then it's updated on each show() call
+ */
+class AnimationClock {
+public:
+    // fixed step simulation callback, gets a sequence number of the simulated step
+    using step_cb_t = std::function<void(uint32_t tick)>;
+    // render callback, gets interpolation factor between previous and current simulation states
+    using render_cb_t = std::function<void(uint8_t alpha)>;
+
+    /**
+     * @brief Construct a new Animation Clock object
+     * 
+     * @param step_ms - simulation step, ms
+     * @param max_steps - catch-up limit, max number of simulation steps per frame
+     */
+    AnimationClock(uint32_t step_ms = 20, uint8_t max_steps = 4) : _step(step_ms ? step_ms : 1), _max_steps(max_steps) {}
+
+    // set simulation step, ms
+    void setStep(uint32_t ms){ _step = ms ? ms : 1; if (_acc >= _step) _acc = 0; }
+    // get simulation step, ms
+    uint32_t getStep() const { return _step; }
+
+    // set catch-up limit, max number of simulation steps per frame
+    void setMaxSteps(uint8_t steps){ _max_steps = steps; }
+
+    // set simulation step callback
+    void onStep(step_cb_t callback){ _step_cb = callback; }
+
+    // set render callback
+    void onRender(render_cb_t callback){ _render_cb = callback; }
+
+    /**
+     * @brief reset accumulated time
+     * 
+     * @param now - current timestamp, ms
+     */
+    void reset(uint32_t now){ _last = now; _acc = 0; _running = true; }
+
+    /**
+     * @brief advance clock to the specified time
+     * first call only sets a starting point
+     * 
+     * @param now - current timestamp, ms
+     * @return unsigned - number of simulation steps due
+     */
+    unsigned advance(uint32_t now);
+
+    /**
+     * @brief advance clock and run callbacks
+     * runs step callback for each simulation step due, then render callback with interpolation factor
+     * 
+     * @param now - current timestamp, ms
+     */
+    void update(uint32_t now);
+
+    /**
+     * @brief interpolation factor between previous and current simulation states
+     * i.e. a fraction of the simulation step passed since last step, 0-255
+     */
+    uint8_t alpha() const { return (_acc << 8) / _step; }
+
+    // total number of simulation steps made
+    uint32_t ticks() const { return _ticks; }
+
+    // amount of time dropped due to catch-up limit, ms
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    uint32_t _step;
+    uint8_t _max_steps;
+    bool _running{false};
+    uint32_t _last{0};
+    // time accumulated since last simulation step
+    uint32_t _acc{0};
+    uint32_t _ticks{0};
+    uint32_t _dropped{0};
+    step_cb_t _step_cb;
+    render_cb_t _render_cb;
+};
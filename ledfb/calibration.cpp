@@ -0,0 +1,35 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include <algorithm>
+#include "calibration.hpp"
+
+CalibrationMap::CalibrationMap(const std::vector<CRGB> &gains){
+    for (const auto &g : gains)
+        addRun(1, g);
+}
+
+void CalibrationMap::addRun(size_t len, CRGB gain){
+    if (!len) return;
+    if (_runs.size() && _runs.back().gain == gain){
+        _runs.back().end += len;
+        return;
+    }
+    _runs.push_back({static_cast<uint32_t>(size() + len), gain});
+}
+
+void CalibrationMap::setTiles(const LedTiles &tiles, const std::vector<CRGB> &gains){
+    clear();
+    size_t tile_size = tiles.tile_w() * tiles.tile_h();
+    for (const auto &g : gains)
+        addRun(tile_size, g);
+}
+
+CRGB CalibrationMap::gain(size_t idx) const {
+    auto r = std::upper_bound(_runs.cbegin(), _runs.cend(), idx, [](size_t i, const run_t &run){ return i < run.end; });
+    return r == _runs.cend() ? CRGB(255, 255, 255) : r->gain;
+}
@@ -0,0 +1,178 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <vector>
+#include "ledstripe.hpp"
+#include "FastLED.h"
+#include "colormath.h"
+
+/**
+ * @brief Per-pixel calibration map for the output stage
+ * holds 8-bit per channel gain values for LEDs in physical (buffer) order, 255 means 'no correction'.
+ * Map is stored run-length coded, i.e. a run of consecutive LEDs sharing same gain takes a single entry,
+ * so a per-tile/per-panel correction costs one entry per tile.
+ * Map is applied by DisplayEngine while converting data for the backend, canvas data stays untouched.
+ * LEDs beyond the end of the map are not corrected
+ */
+class CalibrationMap {
+public:
+    // a run of LEDs with same gain
+    struct run_t {
+        uint32_t end;       // index of the LED next to the last LED of the run
+        CRGB gain;          // per channel gain
+    };
+
+    /**
+     * @brief sequential map reader
+     * walks the runs while pixels are streamed in physical order, costs a single compare per pixel
+     */
+    class cursor {
+        const run_t *_run, *_end;
+        uint32_t _idx{0};
+
+    public:
+        // an empty cursor, yields 'no correction' gain for any pixel
+        cursor() : _run(nullptr), _end(nullptr) {}
+        cursor(const CalibrationMap &map) : _run(map._runs.data()), _end(map._runs.data() + map._runs.size()) {}
+
+        /**
+         * @brief return gain for the current pixel and step to the next one
+         */
+        CRGB next(){
+            if (_run == _end) return CRGB(255, 255, 255);
+            CRGB g(_run->gain);
+            if (++_idx == _run->end) ++_run;
+            return g;
+        }
+    };
+
+    CalibrationMap() = default;
+
+    /**
+     * @brief Construct a map from per-pixel gain values
+     * adjacent pixels with same gain are packed into runs
+     * @param gains - gain values in physical LED order
+     */
+    CalibrationMap(const std::vector<CRGB> &gains);
+
+    /**
+     * @brief append a run of LEDs with same gain to the end of the map
+     * run is merged with the previous one if gain matches
+     * @param len - number of LEDs
+     * @param gain - per channel gain
+     */
+    void addRun(size_t len, CRGB gain);
+
+    /**
+     * @brief Set gain for each tile of a tiled canvas
+     * tiles are contiguous in a physical LED chain, so map will have one run per tile
+     * @param tiles - canvas layout
+     * @param gains - gain values in tile chaining order
+     */
+    void setTiles(const LedTiles &tiles, const std::vector<CRGB> &gains);
+
+    // drop all runs
+    void clear(){ _runs.clear(); }
+
+    // number of LEDs covered by the map
+    size_t size() const { return _runs.size() ? _runs.back().end : 0; }
+
+    // number of runs in the map
+    size_t runs() const { return _runs.size(); }
+
+    /**
+     * @brief get gain for the LED at specified index
+     * random access lookup, for bulk streaming use a cursor
+     * @param idx - LED index in physical order
+     * @return CRGB - per channel gain
+     */
+    CRGB gain(size_t idx) const;
+
+private:
+    std::vector<run_t> _runs;
+};
+
+/// LED segment with it's own color correction and brightness
+/// used to chain strips with different properties on a single controller
+struct led_segment_t {
+    uint32_t start;         // index of the first LED in a segment
+    uint32_t len;           // number of LEDs in a segment
+    CRGB correction;        // color correction applied on top of controller's adjustment
+    uint8_t brightness;     // brightness scale applied on top of controller's brightness
+};
+
+/**
+ * @brief per-pixel output stage adjustment
+ * combines segment correction/brightness and calibration gain and extracts RGBW white channel
+ * while pixels are streamed into a driver in LED order, so no pre-pass over the buffer or scratch copy is needed.
+ * Segment gain is switched on segment boundaries, calibration runs are walked with a cursor,
+ * all lookups cost a couple of compares per pixel.
+ * Segments, calibration map and white point must outlive the adjuster
+ */
+class OutputAdjuster {
+    const led_segment_t *_seg, *_seg_end;
+    CalibrationMap::cursor _cal;
+    bool _has_cal;
+    color::rgbw_mode_t _rgbw;
+    const color::WhitePoint *_wp;
+    uint32_t _idx{0};
+    // gain of the current segment, no correction outside of segments
+    CRGB _seg_gain{255, 255, 255};
+
+public:
+    /**
+     * @brief Construct a new Output Adjuster object
+     * @param map - calibration map, nullptr for none
+     * @param segments - segments sorted by start index, non-overlapping
+     * @param rgbw - white channel extraction mode
+     * @param wp - white LED tint for whitepoint mode
+     */
+    OutputAdjuster(const CalibrationMap *map, const std::vector<led_segment_t> &segments, color::rgbw_mode_t rgbw, const color::WhitePoint &wp) :
+        _seg(segments.data()), _seg_end(segments.data() + segments.size()), _cal(map ? CalibrationMap::cursor(*map) : CalibrationMap::cursor()),
+        _has_cal(map), _rgbw(rgbw), _wp(&wp) {}
+
+    /**
+     * @brief return gain for the current pixel and step to the next one
+     */
+    CRGB next(){
+        if (_seg != _seg_end && _idx == _seg->start + _seg->len){
+            ++_seg;
+            _seg_gain = CRGB(255, 255, 255);
+        }
+        if (_seg != _seg_end && _idx == _seg->start){
+            _seg_gain = _seg->correction;
+            _seg_gain.nscale8(_seg->brightness);
+        }
+        ++_idx;
+        CRGB g(_seg_gain);
+        if (_has_cal) g.nscale8(_cal.next());
+        return g;
+    }
+
+    /**
+     * @brief adjust the next pixel loaded in wire order and extract it's white channel
+     * @param order - color order of the wire bytes
+     * @param b0, b1, b2 - color bytes in wire order, adjusted in place
+     * @return uint8_t - white channel value, 0 if RGBW is off
+     */
+    uint8_t apply(EOrder order, uint8_t &b0, uint8_t &b1, uint8_t &b2){
+        CRGB g(next());
+        b0 = scale8(b0, g.raw[RGB_BYTE0(order)]);
+        b1 = scale8(b1, g.raw[RGB_BYTE1(order)]);
+        b2 = scale8(b2, g.raw[RGB_BYTE2(order)]);
+        if (_rgbw == color::rgbw_mode_t::none) return 0;
+        // min extraction does not depend on channel order
+        if (_rgbw == color::rgbw_mode_t::min) return color::rgb2rgbw_min(b0, b1, b2);
+        // white point is defined in RGB order, so reorder channels back for extraction
+        CRGB c;
+        c.raw[RGB_BYTE0(order)] = b0; c.raw[RGB_BYTE1(order)] = b1; c.raw[RGB_BYTE2(order)] = b2;
+        uint8_t w = color::rgb2rgbw(c.r, c.g, c.b, _rgbw, *_wp);
+        b0 = c.raw[RGB_BYTE0(order)]; b1 = c.raw[RGB_BYTE1(order)]; b2 = c.raw[RGB_BYTE2(order)];
+        return w;
+    }
+};
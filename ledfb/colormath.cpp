@@ -1,3 +1,4 @@
+#include <string.h>
 #include "colormath.h"
 
 namespace color {
@@ -10,4 +11,27 @@ uint16_t alphaBlendRGB565( uint32_t fg, uint32_t bg, uint8_t alpha ){
     return (result >> 16) | result;
 }
 
+void lerp8_buffer(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t len, uint8_t frac){
+    const uint32_t fb = frac, fa = 256 - frac;
+    size_t i = 0;
+    // SWAR loop, even and odd bytes are blended in 16 bit lanes, no lane could overflow since a*fa + b*fb <= 255*256
+    for (; i + 4 <= len; i += 4){
+        uint32_t wa, wb;
+        memcpy(&wa, a + i, 4);
+        memcpy(&wb, b + i, 4);
+        uint32_t even = ((wa & 0x00ff00ff) * fa + (wb & 0x00ff00ff) * fb) >> 8;
+        uint32_t odd  = ((wa >> 8) & 0x00ff00ff) * fa + ((wb >> 8) & 0x00ff00ff) * fb;
+        uint32_t r = (even & 0x00ff00ff) | (odd & 0xff00ff00);
+        memcpy(dst + i, &r, 4);
+    }
+    // tail
+    for (; i != len; ++i)
+        dst[i] = (a[i] * fa + b[i] * fb) >> 8;
+}
+
+void lerp565_buffer(uint16_t *dst, const uint16_t *a, const uint16_t *b, size_t len, uint8_t frac){
+    for (size_t i = 0; i != len; ++i)
+        dst[i] = alphaBlendRGB565(b[i], a[i], frac);
+}
+
 } // namespace color
@@ -1,4 +1,6 @@
+#pragma once
 #include <stdint.h>
+#include <stddef.h>
 
 /*
     Some usefull links for color math
@@ -29,5 +31,109 @@ namespace color {
  **/
 uint16_t alphaBlendRGB565( uint32_t fg, uint32_t bg, uint8_t alpha );
 
+/**
+ * @brief linear interpolation of two byte arrays, i.e. a blend of two CRGB buffers
+ * dst = a + (b - a) * frac, processes 4 bytes per iteration in two 16-bit lanes
+ * dst could be the same as a or b
+ * 
+ * @param dst destination array
+ * @param a source array for frac == 0
+ * @param b source array for frac -> 255
+ * @param len number of bytes
+ * @param frac blend amount
+ */
+void lerp8_buffer(uint8_t *dst, const uint8_t *a, const uint8_t *b, size_t len, uint8_t frac);
+
+/**
+ * @brief linear interpolation of two RGB565 arrays
+ * 
+ * @param dst destination array
+ * @param a source array for frac == 0
+ * @param b source array for frac -> 255
+ * @param len number of pixels
+ * @param frac blend amount
+ */
+void lerp565_buffer(uint16_t *dst, const uint16_t *a, const uint16_t *b, size_t len, uint8_t frac);
+
+/**
+ * @brief RGB to RGBW white channel extraction modes
+ */
+enum class rgbw_mode_t : uint8_t {
+    none = 0,       // plain RGB, no white channel
+    min,            // white is the common part of R,G,B, i.e. min(r,g,b)
+    whitepoint      // white LED tint aware extraction, see WhitePoint
+};
+
+/**
+ * @brief White LED tint in RGB terms, i.e. what RGB color white LED looks like at full power
+ * keeps precomputed reciprocals to avoid divisions in extraction kernel
+ * Could be constructed from FastLED's ColorTemperature values, like Tungsten100W, etc...
+ */
+struct WhitePoint {
+    uint8_t r, g, b;
+    uint16_t inv_r, inv_g, inv_b;       // Q8.8 fixed point 255/c
+
+    WhitePoint(uint8_t r = 255, uint8_t g = 255, uint8_t b = 255) : r(r), g(g), b(b), inv_r(_inv(r)), inv_g(_inv(g)), inv_b(_inv(b)) {}
+
+private:
+    static uint16_t _inv(uint8_t c){ return c ? (255 * 256 + c / 2) / c : UINT16_MAX; }
+};
+
+/**
+ * @brief extract white channel from RGB values using min-based method
+ * common part of R,G,B is moved to white channel
+ * 
+ * @param r,g,b color channels, adjusted in place
+ * @return uint8_t white channel value
+ */
+inline uint8_t rgb2rgbw_min(uint8_t &r, uint8_t &g, uint8_t &b){
+    uint8_t w = r < g ? r : g;
+    w = w < b ? w : b;
+    r -= w; g -= w; b -= w;
+    return w;
+}
+
+/**
+ * @brief extract white channel from RGB values with respect to white LED's tint
+ * white is scaled to the most of what tinted white LED could reproduce,
+ * the rest is left to R,G,B channels
+ * 
+ * @param r,g,b color channels, adjusted in place
+ * @param wp white LED tint
+ * @return uint8_t white channel value
+ */
+inline uint8_t rgb2rgbw_whitepoint(uint8_t &r, uint8_t &g, uint8_t &b, const WhitePoint &wp){
+    uint32_t w = (r * wp.inv_r) >> 8;
+    uint32_t t = (g * wp.inv_g) >> 8;
+    w = t < w ? t : w;
+    t = (b * wp.inv_b) >> 8;
+    w = t < w ? t : w;
+    w = w > 255 ? 255 : w;
+    // subtract white LED contribution from each channel
+    t = (w * (wp.r + 1)) >> 8; r = r > t ? r - t : 0;
+    t = (w * (wp.g + 1)) >> 8; g = g > t ? g - t : 0;
+    t = (w * (wp.b + 1)) >> 8; b = b > t ? b - t : 0;
+    return w;
+}
+
+/**
+ * @brief extract white channel from RGB values with selected mode
+ * 
+ * @param r,g,b color channels, adjusted in place
+ * @param mode extraction mode
+ * @param wp white LED tint for whitepoint mode
+ * @return uint8_t white channel value
+ */
+inline uint8_t rgb2rgbw(uint8_t &r, uint8_t &g, uint8_t &b, rgbw_mode_t mode, const WhitePoint &wp){
+    switch (mode){
+        case rgbw_mode_t::min :
+            return rgb2rgbw_min(r, g, b);
+        case rgbw_mode_t::whitepoint :
+            return rgb2rgbw_whitepoint(r, g, b, wp);
+        default:
+            return 0;
+    }
+}
+
 
 } // namespace color
@@ -0,0 +1,213 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "ledfb.hpp"
+#include "fbdiff.hpp"
+
+/**
+ * @brief Multi-output display group
+ * renders a single CRGB canvas to several display engines, i.e. a WS2812 strip and a HUB75 panel showing related content.
+ * Each output has it's own topology (via output LedFB mapping), size (nearest-neighbour scaling),
+ * color format (CRGB or RGB565) and color correction.
+ * Output buffers work as a conversion cache - on each show() only canvas pixels changed since previous show()
+ * are converted and written to the outputs, so nothing else should draw to output buffers,
+ * otherwise call invalidate() to force a full refresh.
+ *
+ *  DisplayGroup group(32, 16);
+ *  group.addOutput(stripe_engine, stripe_canvas);
+ *  group.addOutput(hub75_engine, hub75_canvas, CRGB(255, 200, 180));
+ *  auto canvas = group.getCanvas();
+ *  ...draw on canvas...
+ *  group.show();
+ */
+class DisplayGroup {
+
+    // output interface
+    class output_base {
+    public:
+        virtual ~output_base() = default;
+        // (re)build source to output index table for canvas of specified size
+        virtual void rebuild(uint16_t w, uint16_t h) = 0;
+        // convert changed canvas runs, or whole canvas if full is set
+        virtual void update(const CRGB *src, const std::vector<diff_run_t> &runs, bool full) = 0;
+        virtual void show() = 0;
+        virtual void setCorrection(CRGB c) = 0;
+    };
+
+    template <class OUT_TYPE>
+    class output : public output_base {
+        std::shared_ptr<DisplayEngine<OUT_TYPE>> _engine;
+        std::shared_ptr<LedFB<OUT_TYPE>> _fb;
+        CRGB _corr;
+        // per canvas pixel offsets into _targets, canvas size + 1 entries
+        std::vector<uint32_t> _offsets;
+        // output buffer indexes, grouped by canvas pixel
+        std::vector<uint32_t> _targets;
+        // output buffer size table was built for
+        size_t _out_len{0};
+
+        static void _put(CRGB &dst, CRGB c){ dst = c; }
+        static void _put(uint16_t &dst, CRGB c){ dst = LedFB_GFX::color565(c); }
+
+        void _convert(const CRGB *src, OUT_TYPE *dst, size_t from, size_t to){
+            bool corr = _corr != CRGB(255, 255, 255);
+            for (size_t i = from; i != to; ++i){
+                CRGB c(src[i]);
+                if (corr) c.nscale8(_corr);
+                for (uint32_t t = _offsets[i]; t != _offsets[i + 1]; ++t)
+                    _put(dst[_targets[t]], c);
+            }
+        }
+
+    public:
+        output(std::shared_ptr<DisplayEngine<OUT_TYPE>> engine, std::shared_ptr<LedFB<OUT_TYPE>> fb, CRGB correction) : _engine(engine), _fb(fb), _corr(correction) {}
+
+        void rebuild(uint16_t w, uint16_t h) override;
+        void update(const CRGB *src, const std::vector<diff_run_t> &runs, bool full) override;
+        void show() override { _engine->show(); }
+        void setCorrection(CRGB c) override { _corr = c; }
+    };
+
+    // source canvas
+    std::shared_ptr<PixelDataBuffer<CRGB>> _buff;
+    std::shared_ptr<LedFB<CRGB>> _canvas;
+    std::vector< std::unique_ptr<output_base> > _outputs;
+    // damage tracker
+    FrameDiff<CRGB> _diff;
+    // canvas dimensions output tables were built for
+    uint16_t _w, _h;
+    // outputs require full refresh
+    bool _full{true};
+
+public:
+    /**
+     * @brief Construct a new Display Group object
+     * canvas is a plain row-major buffer, outputs do the topology mapping
+     * @param w - canvas width
+     * @param h - canvas height
+     */
+    DisplayGroup(uint16_t w, uint16_t h) : _buff(std::make_shared<PixelDataBuffer<CRGB>>(w * h)), _canvas(std::make_shared<LedFB<CRGB>>(w, h, _buff)), _diff(w), _w(w), _h(h) {}
+
+    /**
+     * @brief get canvas to draw on
+     */
+    std::shared_ptr<LedFB<CRGB>> getCanvas(){ return _canvas; }
+
+    /**
+     * @brief add an output
+     * canvas is scaled to output LedFB dimensions, data is mapped via output LedFB topology
+     *
+     * @param engine - display engine
+     * @param fb - canvas over engine's buffer with output dimensions and topology
+     * @param correction - per channel color correction applied to this output only
+     * @return size_t - output index
+     */
+    template <class OUT_TYPE>
+    size_t addOutput(std::shared_ptr<DisplayEngine<OUT_TYPE>> engine, std::shared_ptr<LedFB<OUT_TYPE>> fb, CRGB correction = CRGB(255, 255, 255));
+
+    /**
+     * @brief change output color correction
+     *
+     * @param idx - output index
+     * @param correction - per channel color correction
+     */
+    void setCorrection(size_t idx, CRGB correction){ if (idx < _outputs.size()){ _outputs[idx]->setCorrection(correction); _full = true; } }
+
+    /**
+     * @brief rebuild output index tables and do a full refresh on next show()
+     * must be called if canvas or output dimensions or topology has changed
+     */
+    void invalidate();
+
+    /**
+     * @brief convert changed canvas pixels to all outputs and show them
+     */
+    void show();
+
+    // number of outputs
+    size_t outputs() const { return _outputs.size(); }
+};
+
+
+//  *** TEMPLATES IMPLEMENTATION FOLLOWS *** //
+
+template <class OUT_TYPE>
+void DisplayGroup::output<OUT_TYPE>::rebuild(uint16_t w, uint16_t h){
+    uint16_t ow = _fb->w(), oh = _fb->h();
+    size_t len = static_cast<size_t>(w) * h;
+    _offsets.assign(len + 1, 0);
+    _targets.resize(static_cast<size_t>(ow) * oh);
+    _out_len = _fb->size();
+    if (!len || _targets.empty()) return;
+
+    // count output pixels per canvas pixel, then fill grouped targets.
+    // Output pixels that topology maps outside of output buffer (npos, blackholed or custom mappings) are dropped
+    auto source = [&](unsigned ox, unsigned oy){ return (oy * h / oh) * w + ox * w / ow; };
+    for (unsigned oy = 0; oy != oh; ++oy)
+        for (unsigned ox = 0; ox != ow; ++ox)
+            if (_fb->index(ox, oy) < _out_len) ++_offsets[source(ox, oy) + 1];
+    for (size_t i = 0; i != len; ++i)
+        _offsets[i + 1] += _offsets[i];
+    _targets.resize(_offsets.back());
+
+    std::vector<uint32_t> pos(_offsets.cbegin(), _offsets.cend() - 1);
+    for (unsigned oy = 0; oy != oh; ++oy)
+        for (unsigned ox = 0; ox != ow; ++ox){
+            size_t t = _fb->index(ox, oy);
+            if (t < _out_len) _targets[pos[source(ox, oy)]++] = t;
+        }
+}
+
+template <class OUT_TYPE>
+void DisplayGroup::output<OUT_TYPE>::update(const CRGB *src, const std::vector<diff_run_t> &runs, bool full){
+    auto dst = _fb->span();
+    // output buffer has changed it's size, table must be rebuilt
+    if (dst.size() != _out_len) return;
+
+    if (full){
+        _convert(src, dst.data(), 0, _offsets.size() - 1);
+        return;
+    }
+    for (const auto &r : runs)
+        _convert(src, dst.data(), r.start, r.start + r.len);
+}
+
+template <class OUT_TYPE>
+size_t DisplayGroup::addOutput(std::shared_ptr<DisplayEngine<OUT_TYPE>> engine, std::shared_ptr<LedFB<OUT_TYPE>> fb, CRGB correction){
+    _outputs.emplace_back(std::make_unique< output<OUT_TYPE> >(engine, fb, correction));
+    _outputs.back()->rebuild(_w, _h);
+    _full = true;
+    return _outputs.size() - 1;
+}
+
+inline void DisplayGroup::invalidate(){
+    _w = _canvas->w();
+    _h = _canvas->h();
+    for (auto &o : _outputs)
+        o->rebuild(_w, _h);
+    _diff = FrameDiff<CRGB>(_w);
+    _full = true;
+}
+
+inline void DisplayGroup::show(){
+    // canvas has been resized
+    if (_w != _canvas->w() || _h != _canvas->h()) invalidate();
+
+    // deferred fades are folded into canvas by the diff, outputs get pixels as they should be shown
+    const auto &runs = _diff.update(*_buff);
+    if (_full || runs.size()){
+        for (auto &o : _outputs)
+            o->update(_buff->data().data(), runs, _full);
+    }
+    _full = false;
+
+    for (auto &o : _outputs)
+        o->show();
+}
@@ -0,0 +1,135 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include <algorithm>
+#include <string.h>
+#include "fbdiff.hpp"
+
+/**
+ * @brief find offset of the first mismatching byte
+ * compares machine words first, memcpy loads keep it safe for unaligned data
+ * @return size_t - offset of the first mismatch, or len if arrays are equal
+ */
+static size_t first_mismatch(const uint8_t *a, const uint8_t *b, size_t len){
+    size_t i = 0;
+    for (; i + sizeof(uintptr_t) <= len; i += sizeof(uintptr_t)){
+        uintptr_t wa, wb;
+        memcpy(&wa, a + i, sizeof(uintptr_t));
+        memcpy(&wb, b + i, sizeof(uintptr_t));
+        if (wa != wb) break;
+    }
+    while (i != len && a[i] == b[i]) ++i;
+    return i;
+}
+
+// compare a single pixel, common pixel sizes are compared inline instead of a memcmp() call per pixel
+static inline bool pixel_differs(const uint8_t *a, const uint8_t *b, size_t pixel_size){
+    switch (pixel_size){
+        case 2 :
+            return a[0] != b[0] || a[1] != b[1];
+        case 3 :
+            return a[0] != b[0] || a[1] != b[1] || a[2] != b[2];
+        default :
+            return memcmp(a, b, pixel_size);
+    }
+}
+
+/**
+ * @brief append a run or merge it with the previous one
+ * only runs found within current call, i.e. from index 'first' on, are merged.
+ * Run indexes are relative to the arrays of each call, so runs already present in the list
+ * are in another index space and merging with them would be meaningless
+ */
+static void push_run(std::vector<diff_run_t> &runs, size_t first, size_t start, size_t len, size_t merge_gap, size_t &changed){
+    if (runs.size() > first){
+        diff_run_t &last = runs.back();
+        size_t gap = start - (last.start + last.len);
+        if (gap <= merge_gap){
+            last.len += gap + len;
+            changed += gap + len;
+            return;
+        }
+    }
+    runs.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(len)});
+    changed += len;
+}
+
+/**
+ * @brief plain per-pixel scan of a row span, for densely changed data where word-wise skipping does not pay off
+ * pixel size is a template parameter so that the compare is inlined without a per pixel switch
+ * @param px - first pixel to scan, row relative
+ * @param end - row length in pixels
+ */
+template <size_t PS>
+static void scan_pixels(const uint8_t *ra, const uint8_t *rb, size_t row, size_t px, size_t end, size_t pixel_size,
+                        std::vector<diff_run_t> &runs, size_t first, size_t merge_gap, size_t &changed){
+    const size_t ps = PS ? PS : pixel_size;
+    while (px < end){
+        if (!pixel_differs(ra + px * ps, rb + px * ps, ps)){ ++px; continue; }
+        size_t start = px;
+        do ++px; while (px < end && pixel_differs(ra + px * ps, rb + px * ps, ps));
+        push_run(runs, first, row + start, px - start, merge_gap, changed);
+    }
+}
+
+static void scan_pixels(const uint8_t *ra, const uint8_t *rb, size_t row, size_t px, size_t end, size_t pixel_size,
+                        std::vector<diff_run_t> &runs, size_t first, size_t merge_gap, size_t &changed){
+    switch (pixel_size){
+        case 2 :
+            return scan_pixels<2>(ra, rb, row, px, end, pixel_size, runs, first, merge_gap, changed);
+        case 3 :
+            return scan_pixels<3>(ra, rb, row, px, end, pixel_size, runs, first, merge_gap, changed);
+        default :
+            return scan_pixels<0>(ra, rb, row, px, end, pixel_size, runs, first, merge_gap, changed);
+    }
+}
+
+size_t buffer_diff(const void *a, const void *b, size_t count, size_t pixel_size, std::vector<diff_run_t> &runs, size_t row_len, size_t merge_gap){
+    const uint8_t *pa = static_cast<const uint8_t*>(a);
+    const uint8_t *pb = static_cast<const uint8_t*>(b);
+    if (!row_len) row_len = count;
+    size_t changed = 0;
+    const size_t first = runs.size();
+
+    for (size_t row = 0; row < count; row += row_len){
+        size_t row_end = std::min(row + row_len, count);
+        const uint8_t *ra = pa + row * pixel_size, *rb = pb + row * pixel_size;
+        size_t row_px = row_end - row;
+        size_t row_bytes = row_px * pixel_size;
+
+        // early exit for unchanged rows
+        if (!memcmp(ra, rb, row_bytes)) continue;
+
+        // number of unchanged spans skipped in this row and their total length in pixels
+        size_t spans = 0, skipped = 0;
+        size_t off = 0, from = 0;
+        while (off < row_bytes){
+            off += first_mismatch(ra + off, rb + off, row_bytes - off);
+            if (off == row_bytes) break;
+
+            // align to pixel boundary and walk changed pixels
+            size_t px = off / pixel_size;
+            off = px * pixel_size;
+            size_t start = px;
+            skipped += start - from;
+            do {
+                ++px;
+                off += pixel_size;
+            } while (off < row_bytes && pixel_differs(ra + off, rb + off, pixel_size));
+
+            push_run(runs, first, row + start, px - start, merge_gap, changed);
+            from = px;
+
+            // unchanged spans are too short for word-wise skipping to pay off, scan the rest of the row pixel by pixel
+            if (++spans >= LEDFB_DIFF_DENSE_PROBE && skipped < spans * LEDFB_DIFF_DENSE_SPAN){
+                scan_pixels(ra, rb, row, px, row_px, pixel_size, runs, first, merge_gap, changed);
+                break;
+            }
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,140 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <utility>
+#include <vector>
+#include "ledfb.hpp"
+
+#ifndef LEDFB_DIFF_DENSE_SPAN
+// average length of unchanged spans, in pixels, below which buffer_diff() falls back to a plain per-pixel scan
+#define LEDFB_DIFF_DENSE_SPAN   4
+#endif
+
+#ifndef LEDFB_DIFF_DENSE_PROBE
+// number of unchanged spans in a row buffer_diff() skips before it checks their average length
+#define LEDFB_DIFF_DENSE_PROBE  4
+#endif
+
+/**
+ * @brief a run of changed pixels
+ */
+struct diff_run_t {
+    uint32_t start;     // index of the first changed pixel in physical order
+    uint32_t len;       // number of pixels in run
+};
+
+/**
+ * @brief compare two raw pixel arrays and append runs of changed pixels to a list
+ * rows are first compared as a whole and skipped if identical,
+ * changed rows are scanned word-wise to skip equal spans and pixel-wise only within changed spans.
+ * Once unchanged spans in a row turn out shorter than LEDFB_DIFF_DENSE_SPAN pixels on average,
+ * rest of the row is scanned pixel by pixel, so densely changed frames cost about the same as a naive scan
+ *
+ * @param a - first pixel array
+ * @param b - second pixel array
+ * @param count - number of pixels in arrays
+ * @param pixel_size - size of a pixel in bytes
+ * @param runs - list to append changed runs to, runs already in the list are kept intact and never merged with new ones
+ * @param row_len - row length in pixels for per-row early exit, 0 - compare whole array as a single row
+ * @param merge_gap - runs separated with not more than this number of unchanged pixels are merged into one
+ * @return size_t - number of changed pixels found (including merged gaps)
+ */
+size_t buffer_diff(const void *a, const void *b, size_t count, size_t pixel_size, std::vector<diff_run_t> &runs, size_t row_len = 0, size_t merge_gap = 0);
+
+/**
+ * @brief find changed runs between two pixel buffers
+ * if buffers differ in size, the whole of buffer b is reported as changed.
+ * Buffers are compared as stored, pending deferred scale is not applied
+ *
+ * @param a - old buffer
+ * @param b - new buffer
+ * @param runs - list to append changed runs to
+ * @param row_len - row length in pixels for per-row early exit, 0 - no rows
+ * @param merge_gap - max number of unchanged pixels to merge adjacent runs over
+ * @return size_t - number of changed pixels
+ */
+template <class COLOR_TYPE>
+size_t buffer_diff(const PixelDataBuffer<COLOR_TYPE> &a, const PixelDataBuffer<COLOR_TYPE> &b, std::vector<diff_run_t> &runs, size_t row_len = 0, size_t merge_gap = 0){
+    if (a.size() != b.size()){
+        if (b.size()) runs.push_back({0, static_cast<uint32_t>(b.size())});
+        return b.size();
+    }
+    return buffer_diff(a.data().data(), b.data().data(), b.size(), sizeof(COLOR_TYPE), runs, row_len, merge_gap);
+}
+
+/**
+ * @brief Frame diff tracker
+ * keeps a snapshot of the last seen frame and reports runs changed since then,
+ * i.e. for partial display updates or network senders.
+ * Snapshot is updated only for changed runs, so no full-frame copy happens on each update
+ *
+ * @tparam COLOR_TYPE
+ */
+template <class COLOR_TYPE = CRGB>
+class FrameDiff {
+    std::vector<COLOR_TYPE> _snap;
+    std::vector<diff_run_t> _runs;
+    size_t _row_len, _merge_gap;
+    size_t _changed{0};
+
+public:
+    /**
+     * @brief Construct a new Frame Diff object
+     *
+     * @param row_len - row length in pixels for per-row early exit, 0 - no rows
+     * @param merge_gap - max number of unchanged pixels to merge adjacent runs over,
+     * a larger gap gives fewer but longer runs, which is cheaper for consumers with high per-run overhead
+     */
+    FrameDiff(size_t row_len = 0, size_t merge_gap = 0) : _row_len(row_len), _merge_gap(merge_gap) {}
+
+    /**
+     * @brief compare buffer with the snapshot and update snapshot
+     * first update (or after reset()) reports the whole buffer as changed.
+     * Pending deferred scale is folded into buffer first, so runs reflect pixels as they are output
+     *
+     * @param buff - current frame
+     * @return const std::vector<diff_run_t>& - list of changed runs
+     */
+    const std::vector<diff_run_t>& update(PixelDataBuffer<COLOR_TYPE> &buff){ buff.fold(); return update(std::as_const(buff)); }
+
+    /**
+     * @brief compare buffer with the snapshot and update snapshot
+     * NOTE: const buffer is compared as stored, pending deferred scale is not applied
+     *
+     * @param buff - current frame
+     * @return const std::vector<diff_run_t>& - list of changed runs
+     */
+    const std::vector<diff_run_t>& update(const PixelDataBuffer<COLOR_TYPE> &buff);
+
+    // runs found on last update
+    const std::vector<diff_run_t>& runs() const { return _runs; }
+
+    // number of pixels changed on last update
+    size_t changed() const { return _changed; }
+
+    // drop snapshot, next update will report full frame
+    void reset(){ _snap.clear(); _runs.clear(); _changed = 0; }
+};
+
+template <class COLOR_TYPE>
+const std::vector<diff_run_t>& FrameDiff<COLOR_TYPE>::update(const PixelDataBuffer<COLOR_TYPE> &buff){
+    _runs.clear();
+    const auto &src = buff.data();
+    if (_snap.size() != src.size()){
+        _snap = src;
+        _changed = src.size();
+        if (_changed) _runs.push_back({0, static_cast<uint32_t>(_changed)});
+        return _runs;
+    }
+
+    _changed = buffer_diff(_snap.data(), src.data(), src.size(), sizeof(COLOR_TYPE), _runs, _row_len, _merge_gap);
+    for (const auto &r : _runs)
+        std::copy(src.cbegin() + r.start, src.cbegin() + r.start + r.len, _snap.begin() + r.start);
+
+    return _runs;
+}
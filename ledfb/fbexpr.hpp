@@ -0,0 +1,226 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <string.h>
+#include <type_traits>
+#include "ledfb.hpp"
+
+/*
+    Fused buffer operations (expression templates)
+
+    Effects often chain several full-buffer passes, i.e. fade, then blend with a layer, then add a glow.
+    Each pass streams the whole buffer through memory. Expressions built from fbexpr nodes are evaluated
+    on assignment in a single loop, per pixel, with no intermediate buffers:
+
+        using namespace fbexpr;
+        canvas = blend(fade(src(canvas), 20), layer, 128) + glow;
+
+    Operands are PixelDataBuffer<CRGB>, LedFB<CRGB> (physical buffer order, operands must share size and topology)
+    or a solid CRGB color. Result size is the smallest of operand and destination sizes.
+    Destination could be one of operands, each pixel depends only on the same pixel of operands.
+    Nodes that treat all color channels the same way (buffers, scale/fade, blend, add, sub) are evaluated over
+    flat byte arrays, 4 bytes per iteration in SWAR fashion (like color::lerp8_buffer()), the tail is done byte by byte.
+    Expressions with a solid color fall back to per-pixel loop.
+    Expression holds references to operands, it must be assigned within the same statement.
+*/
+namespace fbexpr {
+
+static_assert(sizeof(CRGB) == 3, "CRGB must be a packed 3 byte struct");
+
+/**
+ * @brief CRTP base for expression nodes
+ * a node provides size(), per pixel operator[] and, if bytewise is set, per channel byte(j) and 4 byte word(j)
+ */
+template <class D>
+struct node {
+    static constexpr bool is_fbexpr = true;
+
+    const D& self() const { return static_cast<const D&>(*this); }
+
+    /**
+     * @brief evaluate expression into destination array
+     *
+     * @param dst - destination pixels
+     * @param len - destination length
+     */
+    void assign(CRGB *dst, size_t len) const;
+};
+
+// detects expression node types
+template <class T, typename = void>
+struct is_node : std::false_type {};
+
+template <class T>
+struct is_node<T, std::void_t<decltype(T::is_fbexpr)>> : std::true_type {};
+
+// buffer operand
+struct buffer_t : node<buffer_t> {
+    static constexpr bool bytewise = true;
+    const CRGB *p;
+    size_t n;
+
+    buffer_t(const CRGB *p, size_t n) : p(p), n(n) {}
+    size_t size() const { return n; }
+    CRGB operator[](size_t i) const { return p[i]; }
+    uint8_t byte(size_t j) const { return reinterpret_cast<const uint8_t*>(p)[j]; }
+    uint32_t word(size_t j) const { uint32_t w; memcpy(&w, reinterpret_cast<const uint8_t*>(p) + j, 4); return w; }
+};
+
+// solid color operand
+struct solid_t : node<solid_t> {
+    // channels differ, can't run over flat bytes
+    static constexpr bool bytewise = false;
+    CRGB c;
+
+    explicit solid_t(CRGB c) : c(c) {}
+    size_t size() const { return SIZE_MAX; }
+    CRGB operator[](size_t i) const { return c; }
+    uint8_t byte(size_t j) const { return c.raw[j % 3]; }
+    uint32_t word(size_t j) const { return byte(j) | byte(j + 1) << 8 | byte(j + 2) << 16 | byte(j + 3) << 24; }
+};
+
+// channel scale, x * s / 256
+template <class E>
+struct scale_t : node<scale_t<E>> {
+    static constexpr bool bytewise = E::bytewise;
+    E e;
+    uint16_t s;
+
+    scale_t(const E &e, uint16_t s) : e(e), s(s) {}
+    size_t size() const { return e.size(); }
+    uint8_t op(uint8_t x) const { return (x * s) >> 8; }
+    CRGB operator[](size_t i) const { CRGB c(e[i]); return CRGB(op(c.r), op(c.g), op(c.b)); }
+    uint8_t byte(size_t j) const { return op(e.byte(j)); }
+    // even and odd bytes are scaled in 16 bit lanes, s <= 256 so no lane could overflow
+    uint32_t word(size_t j) const {
+        uint32_t w = e.word(j);
+        return (((w & 0x00ff00ff) * s >> 8) & 0x00ff00ff) | (((w >> 8) & 0x00ff00ff) * s & 0xff00ff00);
+    }
+};
+
+// per channel binary operation
+template <class A, class B, class OP>
+struct binary_t : node<binary_t<A, B, OP>> {
+    static constexpr bool bytewise = A::bytewise && B::bytewise;
+    A a;
+    B b;
+    OP op;
+
+    binary_t(const A &a, const B &b, OP op) : a(a), b(b), op(op) {}
+    size_t size() const { return a.size() < b.size() ? a.size() : b.size(); }
+    CRGB operator[](size_t i) const { CRGB x(a[i]), y(b[i]); return CRGB(op(x.r, y.r), op(x.g, y.g), op(x.b, y.b)); }
+    uint8_t byte(size_t j) const { return op(a.byte(j), b.byte(j)); }
+    uint32_t word(size_t j) const { return op.word(a.word(j), b.word(j)); }
+};
+
+// saturating add
+struct add_op {
+    uint8_t operator()(uint8_t x, uint8_t y) const { unsigned t = x + y; return t > 255 ? 255 : t; }
+    uint32_t word(uint32_t x, uint32_t y) const {
+        // add low 7 bits, then fix up top bits, bytes that carried out are saturated
+        uint32_t sum = ((x & 0x7f7f7f7f) + (y & 0x7f7f7f7f)) ^ ((x ^ y) & 0x80808080);
+        uint32_t carry = ((x & y) | ((x | y) & ~sum)) & 0x80808080;
+        return sum | ((carry >> 7) * 0xff);
+    }
+};
+
+// saturating subtract
+struct sub_op {
+    uint8_t operator()(uint8_t x, uint8_t y) const { return x > y ? x - y : 0; }
+    uint32_t word(uint32_t x, uint32_t y) const {
+        // subtract with top bits preset so borrows do not cross bytes, bytes that borrowed are zeroed
+        uint32_t diff = ((x | 0x80808080) - (y & 0x7f7f7f7f)) ^ ((x ^ y ^ 0x80808080) & 0x80808080);
+        uint32_t borrow = ((~x & y) | (~(x ^ y) & diff)) & 0x80808080;
+        return diff & ~((borrow >> 7) * 0xff);
+    }
+};
+
+// linear interpolation, same as color::lerp8_buffer()
+struct blend_op {
+    uint16_t fa, fb;
+    uint8_t operator()(uint8_t x, uint8_t y) const { return (x * fa + y * fb) >> 8; }
+    uint32_t word(uint32_t x, uint32_t y) const {
+        uint32_t even = ((x & 0x00ff00ff) * fa + (y & 0x00ff00ff) * fb) >> 8;
+        uint32_t odd  = ((x >> 8) & 0x00ff00ff) * fa + ((y >> 8) & 0x00ff00ff) * fb;
+        return (even & 0x00ff00ff) | (odd & 0xff00ff00);
+    }
+};
+
+/**
+ * @brief turn an operand into expression node
+ */
+// const buffer is read as stored, pending deferred fade is not applied
+inline buffer_t src(const PixelDataBuffer<CRGB> &b){ return buffer_t(b.data().data(), b.size()); }
+inline buffer_t src(PixelDataBuffer<CRGB> &b){ b.fold(); return buffer_t(b.data().data(), b.size()); }
+inline buffer_t src(LedFB<CRGB> &fb){ auto s = fb.span(); return buffer_t(s.data(), s.size()); }
+inline solid_t src(CRGB c){ return solid_t(c); }
+template <class D>
+const D& src(const node<D> &n){ return n.self(); }
+
+// node type for an operand
+template <class T>
+using node_t = std::decay_t<decltype(src(std::declval<T&>()))>;
+
+/**
+ * @brief fade operand to black by 'v', same as FastLED's fadeToBlackBy()
+ */
+template <class A>
+scale_t<node_t<A>> fade(A &&a, uint8_t v){ return scale_t<node_t<A>>(src(a), 256 - v); }
+
+/**
+ * @brief scale operand by 'v', same as FastLED's nscale8()
+ */
+template <class A>
+scale_t<node_t<A>> scale(A &&a, uint8_t v){ return scale_t<node_t<A>>(src(a), v + 1); }
+
+/**
+ * @brief blend two operands, a + (b - a) * amount / 256
+ */
+template <class A, class B>
+binary_t<node_t<A>, node_t<B>, blend_op> blend(A &&a, B &&b, uint8_t amount){
+    return binary_t<node_t<A>, node_t<B>, blend_op>(src(a), src(b), blend_op{static_cast<uint16_t>(256 - amount), amount});
+}
+
+/**
+ * @brief saturating per channel add, at least one operand must be an expression node
+ */
+template <class A, class B, typename = std::enable_if_t<is_node<std::decay_t<A>>::value || is_node<std::decay_t<B>>::value>>
+binary_t<node_t<A>, node_t<B>, add_op> operator+(A &&a, B &&b){ return binary_t<node_t<A>, node_t<B>, add_op>(src(a), src(b), add_op()); }
+
+/**
+ * @brief saturating per channel subtract, at least one operand must be an expression node
+ */
+template <class A, class B, typename = std::enable_if_t<is_node<std::decay_t<A>>::value || is_node<std::decay_t<B>>::value>>
+binary_t<node_t<A>, node_t<B>, sub_op> operator-(A &&a, B &&b){ return binary_t<node_t<A>, node_t<B>, sub_op>(src(a), src(b), sub_op()); }
+
+
+//  *** TEMPLATES IMPLEMENTATION FOLLOWS *** //
+
+template <class D>
+void node<D>::assign(CRGB *dst, size_t len) const {
+    // a local copy of the tree, byte stores to dst could not alias it's pointers and parameters
+    const D e = self();
+    if (e.size() < len) len = e.size();
+    if constexpr (D::bytewise){
+        // flat byte arrays, all channels go through the same ops
+        uint8_t *d = reinterpret_cast<uint8_t*>(dst);
+        len *= sizeof(CRGB);
+        size_t j = 0;
+        for (; j + 4 <= len; j += 4){
+            uint32_t w = e.word(j);
+            memcpy(d + j, &w, 4);
+        }
+        for (; j != len; ++j)
+            d[j] = e.byte(j);
+    } else {
+        for (size_t i = 0; i != len; ++i)
+            dst[i] = e[i];
+    }
+}
+
+} // namespace fbexpr
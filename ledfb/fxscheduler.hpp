@@ -0,0 +1,252 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+/*
+    Coroutine-based effect scheduler
+
+    Lots of small concurrent animations (clock blinking, tickers, icons) could be written as plain sequential code
+    instead of a timer + state machine each. Every effect is a coroutine that draws on a shared canvas and
+    co_await's either the next frame or a timeout. Scheduler resumes all due effects and then calls DisplayEngine::show() once.
+
+    auto engine = std::make_shared<ESP32RMTDisplayEngine>(gpio, GRB, 256);
+    LedFB<CRGB> canvas(16, 16, engine->getBuffer());
+    EffectScheduler<CRGB> sched(engine);
+
+    EffectTask blink(LedFB<CRGB> &fb){
+        for (;;){
+            fb.at(0,0) = CRGB::Red;
+            co_await sleep_for(500);
+            fb.at(0,0) = CRGB::Black;
+            co_await sleep_for(500);
+        }
+    }
+
+    sched.spawn(blink(canvas));
+    loop(){ sched.run(millis()); }
+
+    Coroutine frames are allocated from a fixed-block pool, so spawning/finishing effects does not churn the heap.
+    Requires C++20, the header is empty for older standards, host tests run with native_cpp20 env.
+*/
+
+#pragma once
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include "ledfb.hpp"
+
+#ifndef LEDFB_CORO_BLOCK_SIZE
+// coroutine frame pool block size, bytes
+#define LEDFB_CORO_BLOCK_SIZE   256
+#endif
+#ifndef LEDFB_CORO_POOL_BLOCKS
+// number of blocks in coroutine frame pool
+#define LEDFB_CORO_POOL_BLOCKS  16
+#endif
+
+/**
+ * @brief fixed-block pool for coroutine frames
+ * frames that do not fit the block size or an exhausted pool fall back to heap allocation,
+ * which is counted and could be checked with fallbacks()
+ * NOTE: pool is not thread-safe, all effects should run from the same task
+ */
+class CoroFramePool {
+    union block_t {
+        block_t *next;
+        alignas(std::max_align_t) unsigned char mem[LEDFB_CORO_BLOCK_SIZE];
+    };
+
+    block_t _blocks[LEDFB_CORO_POOL_BLOCKS];
+    block_t *_free{nullptr};
+    size_t _fallbacks{0};
+
+    CoroFramePool(){
+        for (auto &b : _blocks){ b.next = _free; _free = &b; }
+    }
+
+public:
+    static CoroFramePool& instance(){
+        static CoroFramePool pool;
+        return pool;
+    }
+
+    void* allocate(size_t n){
+        if (n <= sizeof(block_t) && _free){
+            block_t *b = _free;
+            _free = b->next;
+            return b;
+        }
+        ++_fallbacks;
+        return ::operator new(n);
+    }
+
+    void deallocate(void *p){
+        if (p >= static_cast<void*>(_blocks) && p < static_cast<void*>(_blocks + LEDFB_CORO_POOL_BLOCKS)){
+            block_t *b = static_cast<block_t*>(p);
+            b->next = _free;
+            _free = b;
+            return;
+        }
+        ::operator delete(p);
+    }
+
+    // number of frames that were allocated from heap
+    size_t fallbacks() const { return _fallbacks; }
+};
+
+/**
+ * @brief effect coroutine handle
+ * an effect is a function returning EffectTask that uses co_await next_frame() or co_await sleep_for(ms)
+ */
+class EffectTask {
+public:
+    struct promise_type {
+        // delay to wait before resuming, ms, 0 means next frame
+        uint32_t delay{0};
+
+        static void* operator new(size_t n){ return CoroFramePool::instance().allocate(n); }
+        static void operator delete(void *p){ CoroFramePool::instance().deallocate(p); }
+
+        EffectTask get_return_object(){ return EffectTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void(){}
+        void unhandled_exception(){ std::terminate(); }
+    };
+
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    EffectTask() = default;
+    explicit EffectTask(handle_t h) : _h(h) {}
+    EffectTask(EffectTask const &) = delete;
+    EffectTask& operator=(EffectTask const &) = delete;
+    EffectTask(EffectTask &&rhs) noexcept : _h(rhs._h) { rhs._h = nullptr; }
+    EffectTask& operator=(EffectTask &&rhs) noexcept { if (this != &rhs){ _reset(); _h = rhs._h; rhs._h = nullptr; } return *this; }
+    ~EffectTask(){ _reset(); }
+
+    // returns true if effect has finished or task is empty
+    bool done() const { return !_h || _h.done(); }
+
+    handle_t handle() const { return _h; }
+
+private:
+    handle_t _h{nullptr};
+    void _reset(){ if (_h) _h.destroy(); _h = nullptr; }
+};
+
+/**
+ * @brief awaitable that suspends effect for the specified time
+ */
+struct sleep_for {
+    uint32_t ms;
+    explicit sleep_for(uint32_t ms) : ms(ms ? ms : 1) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(EffectTask::handle_t h) const noexcept { h.promise().delay = ms; }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief awaitable that suspends effect until the next frame
+ */
+struct next_frame {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(EffectTask::handle_t h) const noexcept { h.promise().delay = 0; }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Effect scheduler
+ * resumes all due effects on each run() and composes their output with a single DisplayEngine::show() call
+ *
+ * @tparam COLOR_TYPE
+ */
+template <class COLOR_TYPE = CRGB>
+class EffectScheduler {
+    struct slot_t {
+        EffectTask task;
+        uint32_t wake_at;
+        // effect waits for the next frame tick
+        bool on_frame;
+        // newly spawned effect, runs on the next run() call regardless of time
+        bool fresh;
+    };
+
+    std::shared_ptr<DisplayEngine<COLOR_TYPE>> _engine;
+    std::vector<slot_t> _slots;
+    uint32_t _now{0};
+    // frame interval, ms
+    uint32_t _frame_ms;
+    uint32_t _last_frame{0};
+
+public:
+    /**
+     * @brief Construct a new Effect Scheduler object
+     *
+     * @param engine - display engine to render frames to
+     * @param frame_ms - frame interval, ms. Effects waiting for next frame are resumed not more often than this
+     * @param max_effects - number of effect slots to reserve, scheduler does not allocate memory unless exceeded
+     */
+    EffectScheduler(std::shared_ptr<DisplayEngine<COLOR_TYPE>> engine, uint32_t frame_ms = 20, size_t max_effects = LEDFB_CORO_POOL_BLOCKS) : _engine(engine), _frame_ms(frame_ms) { _slots.reserve(max_effects); }
+
+    /**
+     * @brief add an effect to the scheduler
+     * effect starts running on the next run() call, it's safe to spawn effects from running effects
+     */
+    void spawn(EffectTask &&task){ if (!task.done()) _slots.push_back({std::move(task), _now, false, true}); }
+
+    /**
+     * @brief resume all due effects and show a frame if any of them has run
+     *
+     * @param now - current timestamp, ms
+     * @return true if a frame was shown
+     */
+    bool run(uint32_t now);
+
+    // current scheduler time, ms
+    uint32_t now() const { return _now; }
+
+    // number of active effects
+    size_t size() const { return _slots.size(); }
+
+    // remove all effects, must not be called from a running effect
+    void clear(){ _slots.clear(); }
+};
+
+template <class COLOR_TYPE>
+bool EffectScheduler<COLOR_TYPE>::run(uint32_t now){
+    _now = now;
+    bool frame = now - _last_frame >= _frame_ms;
+    bool drawn = false;
+
+    // effects could spawn() new ones while resumed, that may reallocate slots,
+    // so slots are accessed by index and only those present before the loop are run
+    for (size_t i = 0, n = _slots.size(); i != n; ++i){
+        if (_slots[i].task.done()) continue;
+        // effects waiting for a frame are resumed on frame ticks, others on their wake up time
+        if (!_slots[i].fresh && (_slots[i].on_frame ? !frame : static_cast<int32_t>(now - _slots[i].wake_at) < 0)) continue;
+
+        auto h = _slots[i].task.handle();
+        h.promise().delay = 0;
+        h.resume();
+        drawn = true;
+        slot_t &s = _slots[i];
+        s.fresh = false;
+        s.on_frame = !h.promise().delay;
+        s.wake_at = now + h.promise().delay;
+    }
+
+    if (frame) _last_frame = now;
+
+    // drop finished effects, no reallocation happens here
+    _slots.erase(std::remove_if(_slots.begin(), _slots.end(), [](const slot_t &s){ return s.task.done(); }), _slots.end());
+
+    if (drawn && _engine) _engine->show();
+    return drawn;
+}
+
+#endif  // __cplusplus >= 202002L
@@ -0,0 +1,386 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "fxvm.hpp"
+
+const char* const FxVM::_layout[] = {
+    "", "ri", "rr", "rrr", "rrr", "rrr", "ri", "rrb", "rrb", "rrr", "rr", "rr", "rb",
+    "j", "rj", "rrj", "rj",
+    "r", "r", "rrrr", "rrr", "rrr", "rr", "rr", "rr", "b", "rr", "rrr"
+};
+
+const char* const FxVM::_names[] = {
+    "end", "ldi", "mov", "add", "sub", "mul", "addi", "shr", "shl", "and", "sin8", "rnd", "env",
+    "jmp", "jnz", "jlt", "loop",
+    "fade", "fill", "hline", "blend", "noise", "ramp", "wave", "pal", "palsel", "shift", "pset"
+};
+
+namespace {
+
+const char* const env_names[] = { "w", "h", "ms", "frame" };
+const char* const pal_names[] = { "rainbow", "heat", "party", "forest", "ocean", "lava", "cloud" };
+
+// encoded operand length
+size_t operand_len(char kind){ return kind == 'i' ? 4 : kind == 'j' ? 2 : 1; }
+
+// encoded instruction length
+size_t insn_len(const char *layout){
+    size_t len = 1;
+    for (; *layout; ++layout) len += operand_len(*layout);
+    return len;
+}
+
+// a token within source line
+struct token_t {
+    const char *p;
+    size_t len;
+
+    bool is(const char *s) const { return strlen(s) == len && !strncmp(p, s, len); }
+};
+
+bool is_sep(char c){ return c == ' ' || c == '\t' || c == ',' || c == '\r'; }
+
+// split line [p, end) into tokens, comment is stripped
+size_t tokenize(const char *p, const char *end, token_t *t, size_t max){
+    size_t n = 0;
+    while (p != end && *p != ';'){
+        if (is_sep(*p)){ ++p; continue; }
+        const char *s = p;
+        while (p != end && *p != ';' && !is_sep(*p)) ++p;
+        if (n == max) return max + 1;
+        t[n++] = {s, static_cast<size_t>(p - s)};
+    }
+    return n;
+}
+
+// parse a whole token as number, decimal, 0x-hex or #RRGGBB color
+bool parse_num(const token_t &t, int64_t &v){
+    char buf[24];
+    if (!t.len || t.len >= sizeof(buf)) return false;
+    memcpy(buf, t.p, t.len);
+    buf[t.len] = 0;
+    char *e;
+    if (buf[0] == '#'){
+        if (t.len != 7) return false;
+        v = strtoll(buf + 1, &e, 16);
+    } else
+        v = strtoll(buf, &e, 0);
+    return *e == 0;
+}
+
+// look up a name in a table
+int find_name(const token_t &t, const char* const *names, size_t cnt){
+    for (size_t i = 0; i != cnt; ++i)
+        if (t.is(names[i])) return i;
+    return -1;
+}
+
+struct label_t {
+    token_t name;
+    size_t offset;
+};
+
+}   // namespace
+
+bool FxVM::load(const uint8_t *code, size_t len){
+    static_assert(sizeof(_layout) / sizeof(_layout[0]) == static_cast<size_t>(op_t::count), "operand layout table does not match opcodes");
+    static_assert(sizeof(_names) / sizeof(_names[0]) == static_cast<size_t>(op_t::count), "mnemonics table does not match opcodes");
+    _prog.clear();
+    if (!code) return false;
+    // byte offset of each instruction
+    std::vector<size_t> offsets;
+    size_t pos = 0;
+
+    while (pos < len){
+        if (code[pos] >= static_cast<uint8_t>(op_t::count)) break;
+        const char *layout = _layout[code[pos]];
+        if (pos + insn_len(layout) > len) break;
+
+        insn_t i{static_cast<op_t>(code[pos]), 0, 0, 0, 0, 0};
+        uint8_t *reg = &i.a;
+        bool valid = true;
+        offsets.push_back(pos++);
+        for (; *layout; ++layout){
+            switch (*layout){
+            case 'r' :
+                valid &= code[pos] < regs;
+                *reg++ = code[pos++];
+                break;
+            case 'b' :
+                i.imm = code[pos++];
+                break;
+            case 'i' :
+                i.imm = static_cast<int32_t>(code[pos] | code[pos + 1] << 8 | code[pos + 2] << 16 | static_cast<uint32_t>(code[pos + 3]) << 24);
+                pos += 4;
+                break;
+            case 'j' :
+                i.imm = code[pos] | code[pos + 1] << 8;
+                pos += 2;
+                break;
+            }
+        }
+        if (i.op == op_t::env) valid &= i.imm < static_cast<int32_t>(env_t::count);
+        if (i.op == op_t::palsel) valid &= i.imm < static_cast<int32_t>(pal_t::count);
+        if (!valid) break;
+        _prog.push_back(i);
+    }
+
+    if (pos != len){
+        _prog.clear();
+        return false;
+    }
+
+    // translate jump targets into instruction indexes, a target must be an instruction start or the end of code
+    for (auto &i : _prog){
+        if (!strchr(_layout[static_cast<uint8_t>(i.op)], 'j')) continue;
+        auto t = std::lower_bound(offsets.begin(), offsets.end(), static_cast<size_t>(i.imm));
+        if (t == offsets.end() && static_cast<size_t>(i.imm) != len){
+            _prog.clear();
+            return false;
+        }
+        if (t != offsets.end() && *t != static_cast<size_t>(i.imm)){
+            _prog.clear();
+            return false;
+        }
+        i.imm = t - offsets.begin();
+    }
+    return !_prog.empty();
+}
+
+bool FxVM::run(LedFB<CRGB> &fb){
+    if (_prog.empty()) return false;
+    const int32_t w = fb.w(), h = fb.h();
+    // scratch line is only reallocated when canvas width changes
+    if (_line.size() != static_cast<size_t>(w)) _line.resize(w);
+
+    int32_t *r = _r;
+    const insn_t *prog = _prog.data();
+    const size_t n = _prog.size();
+    size_t pc = 0, steps = 0;
+    bool ok = true;
+
+    while (pc < n){
+        if (++steps > LEDFB_FXVM_MAX_STEPS){ ok = false; break; }
+        const insn_t &i = prog[pc++];
+
+        switch (i.op){
+        case op_t::end :    pc = n; break;
+        case op_t::ldi :    r[i.a] = i.imm; break;
+        case op_t::mov :    r[i.a] = r[i.b]; break;
+        // arithmetic wraps around
+        case op_t::add :    r[i.a] = static_cast<uint32_t>(r[i.b]) + static_cast<uint32_t>(r[i.c]); break;
+        case op_t::sub :    r[i.a] = static_cast<uint32_t>(r[i.b]) - static_cast<uint32_t>(r[i.c]); break;
+        case op_t::mul :    r[i.a] = static_cast<uint32_t>(r[i.b]) * static_cast<uint32_t>(r[i.c]); break;
+        case op_t::addi :   r[i.a] = static_cast<uint32_t>(r[i.a]) + static_cast<uint32_t>(i.imm); break;
+        case op_t::shr :    r[i.a] = r[i.b] >> (i.imm & 31); break;
+        case op_t::shl :    r[i.a] = static_cast<uint32_t>(r[i.b]) << (i.imm & 31); break;
+        case op_t::band :   r[i.a] = r[i.b] & r[i.c]; break;
+        case op_t::sin8 :   r[i.a] = sin8(r[i.b]); break;
+        case op_t::rnd : {
+            uint32_t v = _rand();
+            r[i.a] = r[i.b] > 0 ? v % r[i.b] : v & 0xffff;
+            break;
+        }
+        case op_t::env :
+            switch (static_cast<env_t>(i.imm)){
+            case env_t::w :     r[i.a] = w; break;
+            case env_t::h :     r[i.a] = h; break;
+            case env_t::ms :    r[i.a] = millis(); break;
+            default :           r[i.a] = _frame;
+            }
+            break;
+        case op_t::jmp :    pc = i.imm; break;
+        case op_t::jnz :    if (r[i.a]) pc = i.imm; break;
+        case op_t::jlt :    if (r[i.a] < r[i.b]) pc = i.imm; break;
+        case op_t::loop :   r[i.a] = static_cast<uint32_t>(r[i.a]) - 1u; if (r[i.a]) pc = i.imm; break;
+
+        // canvas primitives
+        case op_t::fade :   fb.fade(r[i.a]); break;
+        case op_t::fill :   fb.fill(_color(r[i.a])); break;
+        case op_t::hline : {
+            // pixels are written with set(), so deferred fade is not folded and wrap mode is respected
+            CRGB c(_color(r[i.d]));
+            int32_t x = r[i.b], len = std::min(r[i.c], w);
+            for (int32_t k = 0; k < len; ++k)
+                fb.set(x + k, r[i.a], c);
+            break;
+        }
+        case op_t::blend : {
+            if (r[i.a] < 0 || r[i.a] >= h) break;
+            CRGB c(_color(r[i.b]));
+            uint8_t amount = std::clamp(r[i.c], 0, 255);
+            for (auto &p : fb.row(r[i.a]))
+                nblend(p, c, amount);
+            break;
+        }
+        case op_t::noise : {
+            uint32_t s = r[i.b], y = r[i.a] * s, z = r[i.c], x = 0;
+            for (auto &v : _line){
+                v = inoise8(x, y, z);
+                x += s;
+            }
+            break;
+        }
+        case op_t::ramp : {
+            uint32_t v = r[i.a], d = r[i.b];
+            for (auto &p : _line){
+                p = v;
+                v += d;
+            }
+            break;
+        }
+        case op_t::wave : {
+            uint32_t p = r[i.a], f = r[i.b];
+            for (auto &v : _line){
+                v = sin8(p);
+                p += f;
+            }
+            break;
+        }
+        case op_t::pal : {
+            if (r[i.a] < 0 || r[i.a] >= h) break;
+            uint8_t bright = std::clamp(r[i.b], 0, 255);
+            const uint8_t *v = _line.data();
+            for (auto &p : fb.row(r[i.a]))
+                p = ColorFromPalette(_pal, *v++, bright, LINEARBLEND);
+            break;
+        }
+        case op_t::palsel : _palette(i.imm); break;
+        case op_t::shift :  fb.scroll(r[i.a], r[i.b]); break;
+        case op_t::pset :   fb.set(r[i.a], r[i.b], _color(r[i.c])); break;
+        default : break;
+        }
+    }
+
+    ++_frame;
+    _steps = steps;
+    return ok;
+}
+
+void FxVM::reset(){
+    std::fill(_r, _r + regs, 0);
+    _frame = 0;
+    _seed = 0x2545f491;
+    _palette(0);
+}
+
+uint32_t FxVM::_rand(){
+    // xorshift32
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    return _seed;
+}
+
+void FxVM::_palette(uint8_t id){
+    switch (static_cast<pal_t>(id)){
+    case pal_t::heat :      _pal = HeatColors_p; break;
+    case pal_t::party :     _pal = PartyColors_p; break;
+    case pal_t::forest :    _pal = ForestColors_p; break;
+    case pal_t::ocean :     _pal = OceanColors_p; break;
+    case pal_t::lava :      _pal = LavaColors_p; break;
+    case pal_t::cloud :     _pal = CloudColors_p; break;
+    default :               _pal = RainbowColors_p;
+    }
+}
+
+bool FxVM::assemble(const char *src, std::vector<uint8_t> &code, asm_error_t *err){
+    code.clear();
+    if (!src) return false;
+    std::vector<label_t> labels;
+
+    auto fail = [&](unsigned line, const char *msg){
+        if (err) *err = {line, msg};
+        code.clear();
+        return false;
+    };
+
+    // pass 0 collects labels and instruction offsets, pass 1 emits code
+    for (int pass = 0; pass != 2; ++pass){
+        size_t offset = 0;
+        unsigned line = 0;
+        for (const char *p = src; *p; ){
+            const char *eol = strchr(p, '\n');
+            if (!eol) eol = p + strlen(p);
+            ++line;
+
+            token_t t[8];
+            size_t n = tokenize(p, eol, t, 7);
+            p = *eol ? eol + 1 : eol;
+            if (n > 7) return fail(line, "too many operands");
+
+            size_t k = 0;
+            // label declaration
+            if (n && t[0].p[t[0].len - 1] == ':'){
+                token_t name{t[0].p, t[0].len - 1};
+                if (!name.len) return fail(line, "empty label");
+                if (pass == 0){
+                    for (auto &l : labels)
+                        if (l.name.len == name.len && !strncmp(l.name.p, name.p, name.len)) return fail(line, "duplicate label");
+                    labels.push_back({name, offset});
+                }
+                ++k;
+            }
+            if (k == n) continue;
+
+            int op = find_name(t[k], _names, static_cast<size_t>(op_t::count));
+            if (op < 0) return fail(line, "unknown instruction");
+            const char *layout = _layout[op];
+            if (n - k - 1 != strlen(layout)) return fail(line, "wrong number of operands");
+
+            if (pass == 0){
+                offset += insn_len(layout);
+                if (offset > 0xffff) return fail(line, "code is too large");
+                continue;
+            }
+
+            code.push_back(op);
+            for (++k; *layout; ++layout, ++k){
+                const token_t &o = t[k];
+                int64_t v;
+                switch (*layout){
+                case 'r' : {
+                    if (o.len < 2 || o.p[0] != 'r') return fail(line, "register expected");
+                    token_t idx{o.p + 1, o.len - 1};
+                    if (!parse_num(idx, v) || v < 0 || v >= regs) return fail(line, "bad register");
+                    code.push_back(v);
+                    break;
+                }
+                case 'b' : {
+                    int id = -1;
+                    if (op == static_cast<int>(op_t::env)) id = find_name(o, env_names, static_cast<size_t>(env_t::count));
+                    if (op == static_cast<int>(op_t::palsel)) id = find_name(o, pal_names, static_cast<size_t>(pal_t::count));
+                    if (id >= 0) v = id;
+                    else if (!parse_num(o, v) || v < 0 || v > 255) return fail(line, "bad 8 bit operand");
+                    if (op == static_cast<int>(op_t::env) && v >= static_cast<int>(env_t::count)) return fail(line, "unknown env value");
+                    if (op == static_cast<int>(op_t::palsel) && v >= static_cast<int>(pal_t::count)) return fail(line, "unknown palette");
+                    code.push_back(v);
+                    break;
+                }
+                case 'i' : {
+                    if (!parse_num(o, v) || v < INT32_MIN || v > UINT32_MAX) return fail(line, "bad immediate");
+                    uint32_t u = static_cast<uint32_t>(v);
+                    code.push_back(u); code.push_back(u >> 8); code.push_back(u >> 16); code.push_back(u >> 24);
+                    break;
+                }
+                case 'j' : {
+                    const label_t *l = nullptr;
+                    for (auto &i : labels)
+                        if (i.name.len == o.len && !strncmp(i.name.p, o.p, o.len)) l = &i;
+                    if (!l) return fail(line, "undefined label");
+                    code.push_back(l->offset); code.push_back(l->offset >> 8);
+                    break;
+                }
+                }
+            }
+        }
+    }
+    return true;
+}
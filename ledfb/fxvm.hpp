@@ -0,0 +1,175 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <vector>
+#include "ledfb.hpp"
+
+#ifndef LEDFB_FXVM_MAX_STEPS
+// max number of instructions executed per run(), guards against runaway loops in loaded code
+#define LEDFB_FXVM_MAX_STEPS    65536
+#endif
+
+/**
+ * @brief Bytecode VM for runtime-loadable effects
+ * effects could be pushed to a device as a compact bytecode blob instead of reflashing firmware.
+ * To keep interpretation overhead low VM has no per-pixel instructions (except pset for sparks),
+ * primitives work on whole rows of a canvas, so a dispatch is amortized over a row of pixels.
+ * Row primitives are two-stage: noise/ramp/wave generate a row of 8 bit values into a scratch line,
+ * pal maps the scratch line through a palette into a canvas row.
+ *
+ * VM has 16 general purpose 32 bit registers r0-r15, colors are kept in registers as 0xRRGGBB.
+ * Registers keep their values between runs, so effect state survives frames.
+ * Code is validated on load, a malformed blob is rejected and never executed.
+ *
+ *  FxVM vm;
+ *  std::vector<uint8_t> code;
+ *  FxVM::assemble(
+ *      "   env r1, h       ; rows\n"
+ *      "   env r2, ms\n"
+ *      "   ldi r3, 30      ; noise scale\n"
+ *      "   ldi r0, 0\n"
+ *      "row: noise r0, r3, r2\n"
+ *      "   pal r0, r4\n"
+ *      "   addi r0, 1\n"
+ *      "   jlt r0, r1, row\n", code);
+ *  vm.load(code.data(), code.size());
+ *  vm.setReg(4, 255);
+ *  ...
+ *  vm.run(*canvas);
+ *
+ * Bytecode format: one byte opcode followed by operands, register - 1 byte, imm8 - 1 byte,
+ * imm32 - 4 bytes little-endian, jump target - 2 bytes little-endian byte offset of the target instruction
+ */
+class FxVM {
+public:
+    // instruction opcodes
+    enum class op_t : uint8_t {
+        end = 0,    // stop execution
+        ldi,        // ldi rd, imm32        rd = imm
+        mov,        // mov rd, rs           rd = rs
+        add,        // add rd, ra, rb       rd = ra + rb
+        sub,        // sub rd, ra, rb       rd = ra - rb
+        mul,        // mul rd, ra, rb       rd = ra * rb
+        addi,       // addi rd, imm32       rd += imm
+        shr,        // shr rd, ra, imm8     rd = ra >> imm (arithmetic)
+        shl,        // shl rd, ra, imm8     rd = ra << imm
+        band,       // and rd, ra, rb       rd = ra & rb
+        sin8,       // sin8 rd, ra          rd = sin8(ra)
+        rnd,        // rnd rd, ra           rd = random value in [0, ra), ra <= 0 gives a 16 bit value
+        env,        // env rd, imm8         rd = environment value, see env_t
+        jmp,        // jmp label
+        jnz,        // jnz ra, label        jump if ra != 0
+        jlt,        // jlt ra, rb, label    jump if ra < rb
+        loop,       // loop rc, label       --rc, jump if rc != 0
+        fade,       // fade ra              fade canvas by ra
+        fill,       // fill rc              fill canvas with color rc
+        hline,      // hline ry, rx, rl, rc fill rl pixels of row ry starting from rx with color rc
+        blend,      // blend ry, rc, ra     blend row ry towards color rc by amount ra
+        noise,      // noise ry, rs, rz     scratch[x] = inoise8(x * rs, ry * rs, rz)
+        ramp,       // ramp rs, rd          scratch[x] = rs + x * rd
+        wave,       // wave rp, rf          scratch[x] = sin8(rp + x * rf)
+        pal,        // pal ry, rb           row ry = palette(scratch[x]) at brightness rb
+        palsel,     // palsel imm8          select palette, see pal_t
+        shift,      // shift rx, ry         scroll canvas by rx:ry, vacated pixels are cleared
+        pset,       // pset rx, ry, rc      set pixel rx:ry to color rc
+        count       // number of opcodes
+    };
+
+    // environment values for 'env' instruction
+    enum class env_t : uint8_t {
+        w = 0,      // canvas width
+        h,          // canvas height
+        ms,         // millis()
+        frame,      // number of completed runs
+        count
+    };
+
+    // built-in palettes for 'palsel' instruction
+    enum class pal_t : uint8_t {
+        rainbow = 0, heat, party, forest, ocean, lava, cloud, count
+    };
+
+    // number of registers
+    static constexpr uint8_t regs = 16;
+
+    // assembler error description
+    struct asm_error_t {
+        unsigned line;      // source line, 1-based
+        const char *msg;
+    };
+
+    FxVM(){ reset(); }
+
+    /**
+     * @brief load bytecode
+     * code is validated and decoded into internal form, previously loaded program is replaced.
+     * Registers are not reset
+     * @param code - bytecode
+     * @param len - bytecode length
+     * @return true on success, false if code is malformed, program is cleared in this case
+     */
+    bool load(const uint8_t *code, size_t len);
+
+    /**
+     * @brief run loaded program once on a canvas, i.e. once per frame
+     * @param fb - canvas to draw on
+     * @return false if instruction budget LEDFB_FXVM_MAX_STEPS was exhausted or no program is loaded
+     */
+    bool run(LedFB<CRGB> &fb);
+
+    // reset registers, frame counter, palette and random generator
+    void reset();
+
+    // access registers, i.e. to pass effect parameters
+    int32_t getReg(uint8_t r) const { return r < regs ? _r[r] : 0; }
+    void setReg(uint8_t r, int32_t v){ if (r < regs) _r[r] = v; }
+
+    // number of instructions executed on last run
+    size_t steps() const { return _steps; }
+
+    // number of decoded instructions in loaded program
+    size_t size() const { return _prog.size(); }
+
+    /**
+     * @brief assemble text source into bytecode
+     * one instruction per line, operands are separated by commas or spaces, ';' starts a comment.
+     * Labels are declared as 'name:' at line start. Immediates are decimal, 0x-prefixed hex or #RRGGBB colors,
+     * env ids and palettes could be given by name, i.e. 'env r1, h', 'palsel heat'
+     * @param src - null-terminated source text
+     * @param code - bytecode output, previous content is replaced
+     * @param err - error description, if any
+     * @return true on success
+     */
+    static bool assemble(const char *src, std::vector<uint8_t> &code, asm_error_t *err = nullptr);
+
+private:
+    // decoded instruction, jump targets are instruction indexes
+    struct insn_t {
+        op_t op;
+        uint8_t a, b, c, d;
+        int32_t imm;
+    };
+
+    std::vector<insn_t> _prog;
+    // scratch line for row primitives
+    std::vector<uint8_t> _line;
+    int32_t _r[regs];
+    CRGBPalette16 _pal;
+    uint32_t _frame, _seed;
+    size_t _steps{0};
+
+    // operand layout for each opcode: 'r' - register, 'b' - imm8, 'i' - imm32, 'j' - jump target
+    static const char* const _layout[];
+    // mnemonics
+    static const char* const _names[];
+
+    uint32_t _rand();
+    void _palette(uint8_t id);
+
+    static CRGB _color(int32_t c){ return CRGB((c >> 16) & 0xff, (c >> 8) & 0xff, c & 0xff); }
+};
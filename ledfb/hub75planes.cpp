@@ -0,0 +1,165 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include "hub75planes.hpp"
+
+// expand RGB565 channels to 8 bits, same rounding as LedFB_GFX::colorCRGB()
+static inline uint8_t r565(uint16_t c){ return ((c >> 11 & 0x1f) * 527 + 23) >> 6; }
+static inline uint8_t g565(uint16_t c){ return ((c >> 5 & 0x3f) * 259 + 33) >> 6; }
+static inline uint8_t b565(uint16_t c){ return ((c & 0x1f) * 527 + 23) >> 6; }
+
+HUB75BitPlanes::HUB75BitPlanes(uint16_t w, uint16_t h, uint8_t depth) : _w(w), _h(h & ~1), _depth(depth < 1 ? 1 : depth > 8 ? 8 : depth) {
+    _planes.resize(static_cast<size_t>(_depth) * scanRows() * _w);
+}
+
+void HUB75BitPlanes::packRow(uint16_t row, const CRGB *top, const CRGB *bottom, uint16_t x, uint16_t len){
+    if (row >= scanRows() || x >= _w) return;
+    if (len > _w - x) len = _w - x;
+    uint16_t *col = this->row(0, row) + x;
+    for (uint16_t i = 0; i != len; ++i){
+        // matrix rows are channel bytes in the order of DMA word color bits
+        uint64_t m = static_cast<uint64_t>(top[i].r) | static_cast<uint64_t>(top[i].g) << 8 | static_cast<uint64_t>(top[i].b) << 16 |
+                     static_cast<uint64_t>(bottom[i].r) << 24 | static_cast<uint64_t>(bottom[i].g) << 32 | static_cast<uint64_t>(bottom[i].b) << 40;
+        _store(col + i, transpose8(m));
+    }
+}
+
+void HUB75BitPlanes::packRow(uint16_t row, const uint16_t *top, const uint16_t *bottom, uint16_t x, uint16_t len){
+    if (row >= scanRows() || x >= _w) return;
+    if (len > _w - x) len = _w - x;
+    uint16_t *col = this->row(0, row) + x;
+    for (uint16_t i = 0; i != len; ++i){
+        uint64_t m = static_cast<uint64_t>(r565(top[i])) | static_cast<uint64_t>(g565(top[i])) << 8 | static_cast<uint64_t>(b565(top[i])) << 16 |
+                     static_cast<uint64_t>(r565(bottom[i])) << 24 | static_cast<uint64_t>(g565(bottom[i])) << 32 | static_cast<uint64_t>(b565(bottom[i])) << 40;
+        _store(col + i, transpose8(m));
+    }
+}
+
+CRGB HUB75BitPlanes::unpack(uint16_t x, uint16_t y) const {
+    if (x >= _w || y >= _h) return CRGB();
+    bool lower = y >= scanRows();
+    uint16_t r = lower ? y - scanRows() : y;
+    // gather plane words back into a matrix and transpose it
+    uint64_t m = 0;
+    size_t stride = static_cast<size_t>(scanRows()) * _w;
+    const uint16_t *col = _planes.data() + static_cast<size_t>(r) * _w + x;
+    for (uint8_t p = 0; p != _depth; ++p, col += stride)
+        m |= static_cast<uint64_t>(*col & COLOR_MASK) << (8 * (8 - _depth + p));
+    m = transpose8(m);
+    if (lower) m >>= 24;
+    return CRGB(m & 0xff, m >> 8 & 0xff, m >> 16 & 0xff);
+}
+
+void HUB75BitPlanes::_fill(size_t offset, size_t len, uint64_t bits, uint16_t mask, uint8_t shift){
+    bits >>= 8 * (8 - _depth);
+    size_t stride = static_cast<size_t>(scanRows()) * _w;
+    uint16_t *plane = _planes.data() + offset;
+    for (uint8_t p = 0; p != _depth; ++p, bits >>= 8, plane += stride){
+        uint16_t v = (bits << shift) & mask;
+        for (size_t i = 0; i != len; ++i)
+            plane[i] = (plane[i] & ~mask) | v;
+    }
+}
+
+void HUB75BitPlanes::writeRun(uint16_t x, uint16_t y, const CRGB *px, uint16_t len){
+    if (x >= _w || y >= _h) return;
+    if (len > _w - x) len = _w - x;
+    bool lower = y >= scanRows();
+    uint8_t shift = lower ? 3 : 0;
+    uint16_t mask = 0x7 << shift;
+    uint16_t *col = row(0, lower ? y - scanRows() : y) + x;
+    for (uint16_t i = 0; i != len; ++i)
+        _store(col + i, transpose8(static_cast<uint64_t>(px[i].r) | static_cast<uint64_t>(px[i].g) << 8 | static_cast<uint64_t>(px[i].b) << 16), mask, shift);
+}
+
+void HUB75BitPlanes::fillRun(uint16_t x, uint16_t y, uint16_t len, CRGB color){
+    if (x >= _w || y >= _h) return;
+    if (len > _w - x) len = _w - x;
+    bool lower = y >= scanRows();
+    uint8_t shift = lower ? 3 : 0;
+    _fill(static_cast<size_t>(lower ? y - scanRows() : y) * _w + x, len, transpose8(static_cast<uint64_t>(color.r) | static_cast<uint64_t>(color.g) << 8 | static_cast<uint64_t>(color.b) << 16), 0x7 << shift, shift);
+}
+
+void HUB75BitPlanes::fill(CRGB color){
+    uint64_t m = static_cast<uint64_t>(color.r) | static_cast<uint64_t>(color.g) << 8 | static_cast<uint64_t>(color.b) << 16;
+    _fill(0, static_cast<size_t>(scanRows()) * _w, transpose8(m | m << 24), COLOR_MASK, 0);
+}
+
+
+// *** HUB75PlaneDB implementation ***
+
+HUB75PlaneDB::HUB75PlaneDB(uint16_t w, uint16_t h, uint8_t depth, bool shadow) : _planes(w, h, depth) {
+    if (shadow) _shadow.resize(size());
+}
+
+void HUB75PlaneDB::setRun(uint16_t x, uint16_t y, const CRGB *px, uint16_t len){
+    if (x >= w() || y >= h()) return;
+    if (len > w() - x) len = w() - x;
+    _planes.writeRun(x, y, px, len);
+    if (_shadow.size()){
+        uint16_t *s = _shadow.data() + static_cast<size_t>(y) * w() + x;
+        for (uint16_t i = 0; i != len; ++i)
+            s[i] = LedFB_GFX::color565(px[i]);
+    }
+}
+
+void HUB75PlaneDB::fillRun(uint16_t x, uint16_t y, uint16_t len, CRGB color){
+    if (x >= w() || y >= h()) return;
+    if (len > w() - x) len = w() - x;
+    _planes.fillRun(x, y, len, color);
+    if (_shadow.size())
+        std::fill_n(_shadow.begin() + static_cast<size_t>(y) * w() + x, len, LedFB_GFX::color565(color));
+}
+
+void HUB75PlaneDB::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, CRGB color){
+    // clip to panel
+    if (x < 0){ w += x; x = 0; }
+    if (y < 0){ h += y; y = 0; }
+    if (w <= 0 || h <= 0) return;
+    for (int16_t j = 0; j != h && y + j < this->h(); ++j)
+        fillRun(x, y + j, w, color);
+}
+
+void HUB75PlaneDB::blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const CRGB *src, size_t stride){
+    if (!src) return;
+    if (!stride) stride = w;
+    for (uint16_t j = 0; j != h; ++j){
+        int16_t yy = y + j;
+        if (yy < 0) continue;
+        if (yy >= this->h()) break;
+        const CRGB *row = src + j * stride;
+        int16_t xx = x;
+        uint16_t len = w;
+        if (xx < 0){
+            if (-xx >= len) continue;
+            row -= xx; len += xx; xx = 0;
+        }
+        setRun(xx, yy, row, len);
+    }
+}
+
+void HUB75PlaneDB::fill(CRGB color){
+    _planes.fill(color);
+    if (_shadow.size())
+        std::fill(_shadow.begin(), _shadow.end(), LedFB_GFX::color565(color));
+}
+
+CRGB HUB75PlaneDB::get(uint16_t x, uint16_t y) const {
+    if (x >= w() || y >= h()) return CRGB();
+    if (_shadow.size())
+        return LedFB_GFX::colorCRGB(_shadow[static_cast<size_t>(y) * w() + x]);
+    return _planes.unpack(x, y);
+}
+
+
+// *** HUB75Plane_GFX implementation ***
+
+void HUB75Plane_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+  // rotated lines are not contiguous in a panel row
+  if (_rotation) return Arduino_GFX::writeFastHLine(x, y, w, color);
+  _db->fillRect(x, y, w, 1, LedFB_GFX::colorCRGB(color));
+}
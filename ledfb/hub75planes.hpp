@@ -0,0 +1,287 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include "ledfb.hpp"
+
+/**
+ * @brief HUB75 bit-plane storage and BCM (binary code modulation) packer
+ * converts pixel rows into per-bit-plane, per-scan-row DMA words in a format used by I2S/LCD DMA HUB75 drivers,
+ * i.e. one 16 bit word per column holding color bits for two pixels, one from the upper and one from the lower half of the panel
+ * (double-scan). Upper panel half row 'r' is paired with lower half row 'r + h/2'.
+ * Only color bits are written, other bits of a word (row address, latch, OE) are left intact,
+ * so planes could be pre-filled with control bits by a driver.
+ * Packing uses an 8x8 bit-matrix transpose, one per pixel pair, instead of per-bit loops.
+ * Pure C++, no hardware dependencies.
+ *
+ * Plane memory layout: [plane][scan row][column], plane 0 holds the least significant used color bit
+ */
+class HUB75BitPlanes {
+public:
+    // color bits in a DMA word
+    static constexpr uint16_t BIT_R1 = 1 << 0;
+    static constexpr uint16_t BIT_G1 = 1 << 1;
+    static constexpr uint16_t BIT_B1 = 1 << 2;
+    static constexpr uint16_t BIT_R2 = 1 << 3;
+    static constexpr uint16_t BIT_G2 = 1 << 4;
+    static constexpr uint16_t BIT_B2 = 1 << 5;
+    static constexpr uint16_t COLOR_MASK = 0x3f;
+
+    /**
+     * @brief Construct a new HUB75BitPlanes object
+     * 
+     * @param w - panel (chain) width
+     * @param h - panel height, must be even
+     * @param depth - color depth in bits per channel, 1-8. Lower depth uses the most significant bits of a color
+     */
+    HUB75BitPlanes(uint16_t w, uint16_t h, uint8_t depth = 8);
+
+    uint16_t w() const { return _w; }
+    uint16_t h() const { return _h; }
+    uint8_t depth() const { return _depth; }
+    // number of scan rows, i.e. row pairs
+    uint16_t scanRows() const { return _h / 2; }
+
+    // raw plane data
+    uint16_t* data(){ return _planes.data(); }
+    const uint16_t* data() const { return _planes.data(); }
+
+    /**
+     * @brief get pointer to DMA words of a scan row in a plane
+     * 
+     * @param plane - plane number, 0 - least significant used bit
+     * @param row - scan row
+     */
+    uint16_t* row(uint8_t plane, uint16_t row){ return _planes.data() + (static_cast<size_t>(plane) * scanRows() + row) * _w; }
+
+    /**
+     * @brief pack a pair of pixel rows into a scan row of all planes
+     * 
+     * @param row - scan row
+     * @param top - pixels of upper half row 'row', starting from column x
+     * @param bottom - pixels of lower half row 'row + h/2', starting from column x
+     * @param x - first column
+     * @param len - number of columns
+     */
+    void packRow(uint16_t row, const CRGB *top, const CRGB *bottom, uint16_t x, uint16_t len);
+
+    /// @copydoc packRow()
+    void packRow(uint16_t row, const uint16_t *top, const uint16_t *bottom, uint16_t x, uint16_t len);
+
+    /**
+     * @brief write a run of pixels of a single panel row
+     * only color bits of the specified row are updated, paired row of the other panel half is left intact
+     * 
+     * @param x - first column
+     * @param y - panel row
+     * @param px - pixels
+     * @param len - number of pixels
+     */
+    void writeRun(uint16_t x, uint16_t y, const CRGB *px, uint16_t len);
+
+    /**
+     * @brief fill a run of pixels of a single panel row with solid color
+     * color is transposed once and plane words are updated in bulk
+     * 
+     * @param x - first column
+     * @param y - panel row
+     * @param len - number of pixels
+     * @param color - fill color
+     */
+    void fillRun(uint16_t x, uint16_t y, uint16_t len, CRGB color);
+
+    /**
+     * @brief fill all planes with solid color
+     */
+    void fill(CRGB color);
+
+    /**
+     * @brief pack a whole row-major pixel buffer of panel dimensions
+     * pending deferred scale of the buffer is applied on the fly, buffer content is not altered
+     * 
+     * @param buff - pixel buffer, w*h pixels
+     * @return true on success
+     * @return false if buffer size does not match panel
+     */
+    template <class COLOR_TYPE>
+    bool pack(const PixelDataBuffer<COLOR_TYPE> &buff);
+
+    /**
+     * @brief unpack a pixel from bit planes
+     * bits below color depth are returned as zeroes
+     */
+    CRGB unpack(uint16_t x, uint16_t y) const;
+
+    /**
+     * @brief transpose an 8x8 bit matrix
+     * matrix row 'r' is byte 'r' of the argument, column 'c' is bit 'c', i.e. bit 'k' of input byte 'r' becomes bit 'r' of output byte 'k'
+     */
+    static uint64_t transpose8(uint64_t x){
+        uint64_t t;
+        t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+        x = x ^ t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+        x = x ^ t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+        return x ^ t ^ (t << 28);
+    }
+
+private:
+    uint16_t _w, _h;
+    uint8_t _depth;
+    std::vector<uint16_t> _planes;
+
+    // scatter transposed channel bits to plane words of a column, only bits under mask are updated
+    inline void _store(uint16_t *col, uint64_t bits, uint16_t mask = COLOR_MASK, uint8_t shift = 0){
+        // byte 'k' of transposed value holds color bits for plane 'k', lower depth skips least significant planes
+        bits >>= 8 * (8 - _depth);
+        size_t stride = static_cast<size_t>(scanRows()) * _w;
+        for (uint8_t p = 0; p != _depth; ++p, bits >>= 8, col += stride)
+            *col = (*col & ~mask) | ((bits << shift) & mask);
+    }
+
+    // fill a run of words in each plane with transposed color bits
+    void _fill(size_t offset, size_t len, uint64_t bits, uint16_t mask, uint8_t shift);
+};
+
+/**
+ * @brief HUB75 write-through pixel buffer
+ * pixel writes go straight to DMA bit planes, so there is no full CRGB buffer next to the planes.
+ * Runs of pixels in a row, fills and blits are packed in bulk.
+ * Reads are optional - from a compact RGB565 shadow if enabled, otherwise pixels are unpacked from bit planes
+ * (colors are truncated to plane depth in this case).
+ * NOTE: it is not a PixelDataBuffer since it can't give away references to pixel data, use set()/get() or HUB75Plane_GFX
+ */
+class HUB75PlaneDB {
+public:
+    /**
+     * @brief Construct a new HUB75PlaneDB object
+     * 
+     * @param w - panel (chain) width
+     * @param h - panel height
+     * @param depth - color depth in bits per channel, 1-8
+     * @param shadow - keep an RGB565 shadow for reads
+     */
+    HUB75PlaneDB(uint16_t w, uint16_t h, uint8_t depth = 8, bool shadow = false);
+
+    uint16_t w() const { return _planes.w(); }
+    uint16_t h() const { return _planes.h(); }
+    size_t size() const { return static_cast<size_t>(w()) * h(); }
+    bool shadow() const { return _shadow.size(); }
+
+    // access to bit planes, i.e. to feed DMA
+    HUB75BitPlanes& planes(){ return _planes; }
+
+    // write a single pixel
+    void set(uint16_t x, uint16_t y, CRGB color){ setRun(x, y, &color, 1); }
+
+    /**
+     * @brief write a run of pixels in a row
+     * 
+     * @param x - first column
+     * @param y - row
+     * @param px - pixels
+     * @param len - number of pixels
+     */
+    void setRun(uint16_t x, uint16_t y, const CRGB *px, uint16_t len);
+
+    /**
+     * @brief fill a run of pixels in a row with solid color
+     */
+    void fillRun(uint16_t x, uint16_t y, uint16_t len, CRGB color);
+
+    /**
+     * @brief fill a rectangle with solid color
+     */
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, CRGB color);
+
+    /**
+     * @brief copy a block of pixels to the buffer, clipped to panel dimensions
+     * 
+     * @param x - top left corner x coordinate
+     * @param y - top left corner y coordinate
+     * @param w - block width
+     * @param h - block height
+     * @param src - row-major source pixels
+     * @param stride - source row stride in pixels, 0 - same as block width
+     */
+    void blit(int16_t x, int16_t y, uint16_t w, uint16_t h, const CRGB *src, size_t stride = 0);
+
+    // fill whole buffer with solid color
+    void fill(CRGB color);
+
+    // clear buffer to black
+    void clear(){ fill(CRGB()); }
+
+    /**
+     * @brief read a pixel
+     * returns shadow content if enabled, otherwise a pixel unpacked from bit planes
+     */
+    CRGB get(uint16_t x, uint16_t y) const;
+
+private:
+    HUB75BitPlanes _planes;
+    std::vector<uint16_t> _shadow;
+};
+
+/**
+ * @brief Arduino_GFX API over HUB75PlaneDB
+ * horizontal lines and screen fills are done with bulk plane updates
+ */
+class HUB75Plane_GFX : public LedFB_GFX_Base<HUB75Plane_GFX> {
+    friend class LedFB_GFX_Base<HUB75Plane_GFX>;
+
+protected:
+    std::shared_ptr<HUB75PlaneDB> _db;
+
+    // pixel primitives for LedFB_GFX_Base, buffer coordinates
+    void _blendPixel(int16_t x, int16_t y, CRGB overlay, fract8 amountOfOverlay){ CRGB c(_db->get(x, y)); nblend(c, overlay, amountOfOverlay); _db->set(x, y, c); };
+    void _fadePixel(int16_t x, int16_t y, uint8_t fadeBy){ _db->set(x, y, _db->get(x, y).nscale8(fadeBy)); };
+    void _scalePixel(int16_t x, int16_t y, CRGB color){ _db->set(x, y, _db->get(x, y).nscale8(color)); };
+
+public:
+    HUB75Plane_GFX(std::shared_ptr<HUB75PlaneDB> db) : LedFB_GFX_Base(db->w(), db->h()), _db(db) {}
+
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override { _rotate(x, y); _db->set(x, y, colorCRGB(color)); };
+
+    void writePixelPreclipped(int16_t x, int16_t y, CRGB color){ _rotate(x, y); _db->set(x, y, color); };
+
+    // mapped writePixel methods
+    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, uint16_t color){ writePixelPreclipped(x, y, color); };
+    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, CRGB color){ writePixelPreclipped(x, y, color); };
+
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+
+    void fillScreen(uint16_t color) override { _db->fill(colorCRGB(color)); };
+};
+
+template <class COLOR_TYPE>
+bool HUB75BitPlanes::pack(const PixelDataBuffer<COLOR_TYPE> &buff){
+    if (buff.size() != static_cast<size_t>(_w) * _h) return false;
+    const COLOR_TYPE *px = buff.data().data();
+    size_t half = static_cast<size_t>(scanRows()) * _w;
+    if (buff.deferredScale() == PixelDataBuffer<COLOR_TYPE>::scale_one){
+        for (uint16_t r = 0; r != scanRows(); ++r)
+            packRow(r, px + r * _w, px + half + r * _w, 0, _w);
+        return true;
+    }
+
+    // scaled pixels are packed via small chunks on stack
+    constexpr uint16_t chunk = 32;
+    COLOR_TYPE top[chunk], bottom[chunk];
+    for (uint16_t r = 0; r != scanRows(); ++r)
+        for (uint16_t x = 0; x < _w; x += chunk){
+            uint16_t len = std::min<uint16_t>(chunk, _w - x);
+            size_t i = static_cast<size_t>(r) * _w + x;
+            for (uint16_t k = 0; k != len; ++k){
+                top[k] = buff.output(i + k);
+                bottom[k] = buff.output(half + i + k);
+            }
+            packRow(r, top, bottom, x, len);
+        }
+    return true;
+}
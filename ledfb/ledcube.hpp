@@ -0,0 +1,267 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "ledfb.hpp"
+
+/**
+ * @brief slice of a LedCube, a 2D plane perpendicular to one of the axes
+ * it is a regular LedFB over cube's buffer, so GFX and 2D effects could draw on it.
+ * Slice keeps it's own index table taken from the cube on creation, if cube layout changes slices must be recreated.
+ * Buffer-wide operations fill/clear/fade/dim, including their execution policy overloads, are limited to slice pixels,
+ * raw buffer access (span(), iterators, mirror()) still covers the whole cube
+ *
+ * @tparam COLOR_TYPE
+ */
+template <class COLOR_TYPE = CRGB>
+class LedCubeSlice : public LedFB<COLOR_TYPE> {
+    // cube buffer indexes of slice pixels in row-major order
+    std::vector<uint32_t> _map;
+
+protected:
+    bool _partial() const override { return true; }
+
+public:
+    /**
+     * @brief Construct a new Led Cube Slice object
+     *
+     * @param w - slice width
+     * @param h - slice height
+     * @param fb - cube buffer
+     * @param map - buffer indexes of slice pixels, w*h entries in row-major order
+     */
+    LedCubeSlice(uint16_t w, uint16_t h, std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> fb, std::vector<uint32_t> &&map) :
+        LedFB<COLOR_TYPE>(w, h, fb, [this](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return _map[y * w + x]; }), _map(std::move(map)) {}
+
+    LedCubeSlice(LedCubeSlice const &) = delete;
+    LedCubeSlice& operator=(LedCubeSlice const &) = delete;
+
+    // slice can't be resized
+    bool resize(uint16_t w, uint16_t h) override { return false; }
+
+    void fill(COLOR_TYPE color) override { this->buffer->fold(); for (auto i : _map) this->buffer->at_unchecked(i) = color; }
+
+    void clear() override { fill(COLOR_TYPE()); }
+
+    void fade(uint8_t v) override { dim(255 - v); }
+
+    void dim(uint8_t v) override {
+        if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+            this->buffer->fold();
+            for (auto i : _map) this->buffer->at_unchecked(i).nscale8(v);
+        }
+    }
+};
+
+/**
+ * @brief 3D canvas for LED cubes
+ * cube is made of 'd' layers stacked along Z axis, each layer is a w*h LedStripe-wired plane,
+ * layers are chained one after another in a buffer. Odd layers could be reversed for cubes where the chain
+ * snakes back through every other layer.
+ * Coordinates to buffer index mapping is precomputed into a lookup table.
+ * Slices expose 2D planes of the cube as LedFB objects.
+ *
+ *  LedCube<CRGB> cube(8, 8, 8, LedStripe(true));
+ *  cube.at(1, 2, 3) = CRGB::Red;
+ *  auto top = cube.slice(LedCube<CRGB>::axis_t::z, 7);
+ *  LedFB_GFX gfx(top);
+ *  gfx.drawCircle(4, 4, 3, LedFB_GFX::color565(CRGB::Blue));
+ *  cube.shift(LedCube<CRGB>::axis_t::z, -1);   // let it fall one layer down
+ *
+ * @tparam COLOR_TYPE
+ */
+template <class COLOR_TYPE = CRGB>
+class LedCube {
+public:
+    // axis a slice or a plane operation is perpendicular to
+    enum class axis_t : uint8_t { x, y, z };
+
+    /**
+     * @brief Construct a new Led Cube object
+     * will spawn a new data buffer, or use the supplied one resized to cube dimensions
+     *
+     * @param w - width, X axis
+     * @param h - height, Y axis
+     * @param d - depth (number of layers), Z axis
+     * @param layout - wiring of each layer
+     * @param layer_snake - odd layers are chained in reverse order
+     * @param fb - preallocated buffer storage
+     */
+    LedCube(uint16_t w, uint16_t h, uint16_t d, LedStripe layout = LedStripe(), bool layer_snake = false, std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> fb = nullptr);
+
+    uint16_t w() const { return _w; }
+    uint16_t h() const { return _h; }
+    uint16_t d() const { return _d; }
+
+    // size in pixels
+    size_t size() const { return _idx.size(); }
+
+    // get underlying buffer
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> getBuffer(){ return _buff; }
+
+    /**
+     * @brief change layers wiring and rebuild index table
+     * previously created slices are NOT updated
+     */
+    void setLayout(LedStripe layout, bool layer_snake = false);
+
+    /**
+     * @brief get physical buffer index for coordinates x:y:z
+     * no bounds checking is performed
+     */
+    size_t index(uint16_t x, uint16_t y, uint16_t z) const { return _idx[(static_cast<size_t>(z) * _h + y) * _w + x]; }
+
+    /**
+     * @brief access pixel at coordinates x:y:z
+     * if oob coordinates supplied returns blackhole element
+     */
+    COLOR_TYPE& at(int16_t x, int16_t y, int16_t z){
+        if (x < 0 || y < 0 || z < 0 || x >= _w || y >= _h || z >= _d) return _buff->stub_pixel;
+        _buff->fold();
+        return _buff->at_unchecked(index(x, y, z));
+    }
+
+    /**
+     * @brief get 2D slice of the cube
+     * slice dimensions: axis z - w*h with (x,y) coordinates, axis y - w*d with (x,z), axis x - d*h with (z,y)
+     *
+     * @param axis - axis slice is perpendicular to
+     * @param pos - slice position along the axis
+     * @return std::shared_ptr<LedFB<COLOR_TYPE>>, nullptr if position is out of cube
+     */
+    std::shared_ptr<LedFB<COLOR_TYPE>> slice(axis_t axis, uint16_t pos);
+
+    /**
+     * @brief fill a plane with solid color
+     *
+     * @param axis - axis plane is perpendicular to
+     * @param pos - plane position along the axis
+     * @param color
+     */
+    void fillPlane(axis_t axis, uint16_t pos, COLOR_TYPE color);
+
+    /**
+     * @brief shift cube content along an axis
+     * vacated planes are filled with specified color
+     *
+     * @param axis - axis to shift along
+     * @param steps - number of planes to shift by, positive shifts towards higher coordinates
+     * @param color - color to fill vacated planes with
+     */
+    void shift(axis_t axis, int16_t steps, COLOR_TYPE color = COLOR_TYPE());
+
+    // fill the cube with solid color
+    void fill(COLOR_TYPE color){ _buff->fill(color); }
+
+    // clear the cube to black
+    void clear(){ _buff->clear(); }
+
+private:
+    uint16_t _w, _h, _d;
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> _buff;
+    // buffer index table, [z][y][x]
+    std::vector<uint32_t> _idx;
+
+    // number of planes along axis
+    uint16_t _planes(axis_t axis) const { return axis == axis_t::x ? _w : axis == axis_t::y ? _h : _d; }
+    // plane dimensions
+    uint16_t _pw(axis_t axis) const { return axis == axis_t::x ? _d : _w; }
+    uint16_t _ph(axis_t axis) const { return axis == axis_t::y ? _d : _h; }
+
+    // buffer index of plane pixel u:v
+    size_t _pindex(axis_t axis, uint16_t pos, uint16_t u, uint16_t v) const {
+        switch (axis){
+        case axis_t::x : return index(pos, v, u);
+        case axis_t::y : return index(u, pos, v);
+        default : return index(u, v, pos);
+        }
+    }
+
+    void _copyPlane(axis_t axis, uint16_t from, uint16_t to);
+};
+
+
+//  *** TEMPLATES IMPLEMENTATION FOLLOWS *** //
+
+template <class COLOR_TYPE>
+LedCube<COLOR_TYPE>::LedCube(uint16_t w, uint16_t h, uint16_t d, LedStripe layout, bool layer_snake, std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> fb) : _w(w), _h(h), _d(d), _buff(fb) {
+    size_t len = static_cast<size_t>(w) * h * d;
+    if (!_buff)
+        _buff = std::make_shared<PixelDataBuffer<COLOR_TYPE>>(len);
+    else if (_buff->size() != len)
+        _buff->resize(len);
+    setLayout(layout, layer_snake);
+}
+
+template <class COLOR_TYPE>
+void LedCube<COLOR_TYPE>::setLayout(LedStripe layout, bool layer_snake){
+    size_t lsize = static_cast<size_t>(_w) * _h;
+    _idx.resize(lsize * _d);
+    auto i = _idx.begin();
+    for (unsigned z = 0; z != _d; ++z){
+        bool reverse = layer_snake && (z & 1);
+        for (unsigned y = 0; y != _h; ++y)
+            for (unsigned x = 0; x != _w; ++x){
+                size_t t = layout.transpose(_w, _h, x, y);
+                *i++ = z * lsize + (reverse ? lsize - 1 - t : t);
+            }
+    }
+}
+
+template <class COLOR_TYPE>
+std::shared_ptr<LedFB<COLOR_TYPE>> LedCube<COLOR_TYPE>::slice(axis_t axis, uint16_t pos){
+    if (pos >= _planes(axis)) return nullptr;
+    uint16_t pw = _pw(axis), ph = _ph(axis);
+    std::vector<uint32_t> map;
+    map.reserve(static_cast<size_t>(pw) * ph);
+    for (uint16_t v = 0; v != ph; ++v)
+        for (uint16_t u = 0; u != pw; ++u)
+            map.push_back(_pindex(axis, pos, u, v));
+    return std::make_shared<LedCubeSlice<COLOR_TYPE>>(pw, ph, _buff, std::move(map));
+}
+
+template <class COLOR_TYPE>
+void LedCube<COLOR_TYPE>::fillPlane(axis_t axis, uint16_t pos, COLOR_TYPE color){
+    if (pos >= _planes(axis)) return;
+    _buff->fold();
+    uint16_t pw = _pw(axis), ph = _ph(axis);
+    for (uint16_t v = 0; v != ph; ++v)
+        for (uint16_t u = 0; u != pw; ++u)
+            _buff->at_unchecked(_pindex(axis, pos, u, v)) = color;
+}
+
+template <class COLOR_TYPE>
+void LedCube<COLOR_TYPE>::_copyPlane(axis_t axis, uint16_t from, uint16_t to){
+    uint16_t pw = _pw(axis), ph = _ph(axis);
+    for (uint16_t v = 0; v != ph; ++v)
+        for (uint16_t u = 0; u != pw; ++u)
+            _buff->at_unchecked(_pindex(axis, to, u, v)) = _buff->at_unchecked(_pindex(axis, from, u, v));
+}
+
+template <class COLOR_TYPE>
+void LedCube<COLOR_TYPE>::shift(axis_t axis, int16_t steps, COLOR_TYPE color){
+    int n = _planes(axis);
+    if (!steps) return;
+    _buff->fold();
+    if (steps >= n || -steps >= n){
+        fill(color);
+        return;
+    }
+    if (steps > 0){
+        for (int p = n - 1; p >= steps; --p)
+            _copyPlane(axis, p - steps, p);
+        for (int p = 0; p != steps; ++p)
+            fillPlane(axis, p, color);
+    } else {
+        for (int p = 0; p < n + steps; ++p)
+            _copyPlane(axis, p - steps, p);
+        for (int p = n + steps; p != n; ++p)
+            fillPlane(axis, p, color);
+    }
+}
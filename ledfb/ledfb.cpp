@@ -15,6 +15,73 @@
 // Out-of-bound CRGB placeholder - stub pixel that is mapped to either nonexistent buffer access or blackholed CLedController mapping
 static CRGB blackhole;
 
+#ifdef LEDFB_ALLOC_TRACKING
+// replaced global allocation functions, counting heap activity within hot path scopes
+#include <stdlib.h>
+#include <assert.h>
+#include <new>
+
+static void tracked_count(){
+    if (AllocTracker::active()){
+        ++AllocTracker::allocs;
+#ifdef LEDFB_ALLOC_TRACKING_ASSERT
+        assert(!"heap allocation in render hot path");
+#endif
+    }
+}
+
+// nothrow variants return nullptr on failure, the others abort since exceptions are not used
+static void* tracked_alloc(size_t n, bool nothrow = false){
+    tracked_count();
+    void *p = malloc(n ? n : 1);
+    if (!p && !nothrow) abort();
+    return p;
+}
+
+// over-aligned allocation, memory is released with free() as well
+static void* tracked_alloc(size_t n, std::align_val_t al, bool nothrow = false){
+    tracked_count();
+    size_t a = static_cast<size_t>(al);
+    if (a < sizeof(void*)) a = sizeof(void*);
+    void *p = nullptr;
+    if (posix_memalign(&p, a, n ? n : 1)) p = nullptr;
+    if (!p && !nothrow) abort();
+    return p;
+}
+
+static void tracked_free(void *p){
+    if (!p) return;
+    if (AllocTracker::active()){
+        ++AllocTracker::frees;
+#ifdef LEDFB_ALLOC_TRACKING_ASSERT
+        assert(!"heap free in render hot path");
+#endif
+    }
+    free(p);
+}
+
+void* operator new(size_t n){ return tracked_alloc(n); }
+void* operator new[](size_t n){ return tracked_alloc(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return tracked_alloc(n, true); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return tracked_alloc(n, true); }
+void* operator new(size_t n, std::align_val_t al){ return tracked_alloc(n, al); }
+void* operator new[](size_t n, std::align_val_t al){ return tracked_alloc(n, al); }
+void* operator new(size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return tracked_alloc(n, al, true); }
+void* operator new[](size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return tracked_alloc(n, al, true); }
+void operator delete(void *p) noexcept { tracked_free(p); }
+void operator delete[](void *p) noexcept { tracked_free(p); }
+void operator delete(void *p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void *p, size_t) noexcept { tracked_free(p); }
+void operator delete(void *p, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void *p, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { tracked_free(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(p); }
+#endif  // LEDFB_ALLOC_TRACKING
+
 // *** CLedCDB implementation ***
 
 // move construct
@@ -30,6 +97,7 @@ CLedCDB::CLedCDB(CLedCDB&& rhs) noexcept : PixelDataBuffer(std::forward<CLedCDB>
 // move assignment
 CLedCDB& CLedCDB::operator=(CLedCDB&& rhs){
     fb = std::move(rhs.fb);
+    _dscale = rhs._dscale;
 
     if (cled && rhs.cled && (cled != rhs.cled)){
         /* oops... we are moving from a buff binded to some other cled controller
@@ -64,6 +132,7 @@ void CLedCDB::swap(PixelDataBuffer& rhs){
 
 void CLedCDB::swap(CLedCDB& rhs){
     std::swap(fb, rhs.fb);
+    std::swap(_dscale, rhs._dscale);
     _reset_cled();
     rhs._reset_cled();
 }
@@ -160,24 +229,27 @@ void LedFB_GFX::fillScreen(CRGB color) {
     std::visit( Overload{ [this, &color](const auto& variant_item) { _fillScreenCRGB(variant_item.get(), color); }, }, _fb);
 }
 
+bool LedFB_GFX::_wraps() const {
+    return std::visit( Overload{ [](const auto& variant_item) { return variant_item->getWrap() != std::decay_t<decltype(*variant_item)>::wrap_t::none; }, }, _fb);
+}
+
+void LedFB_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+    if (!_wraps()) return Arduino_GFX::writeFastHLine(x, y, w, color);
+    for (int16_t i = 0; i < w; ++i) writePixelPreclipped(x + i, y, color);
+}
+
+void LedFB_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+    if (!_wraps()) return Arduino_GFX::writeFastVLine(x, y, h, color);
+    for (int16_t i = 0; i < h; ++i) writePixelPreclipped(x, y + i, color);
+}
+
+void LedFB_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+    if (!_wraps()) return Arduino_GFX::writeFillRect(x, y, w, h, color);
+    for (int16_t j = 0; j < h; ++j) writeFastHLine(x, y + j, w, color);
+}
+
 void LedFB_GFX::writePixelPreclipped(int16_t x, int16_t y, uint16_t color){ 
-  int16_t t;
-  switch (_rotation) {
-  case 1:
-      t = x;
-      x = width() - 1 - y;
-      y = t;
-      break;
-  case 2:
-      x = width() - 1 - x;
-      y = height() - 1 - y;
-      break;
-  case 3:
-      t = x;
-      x = y;
-      y = height() - 1 - t;
-      break;
-  }
+  _rotate(x, y);
 
   std::visit(
       Overload {
@@ -188,131 +260,14 @@ void LedFB_GFX::writePixelPreclipped(int16_t x, int16_t y, uint16_t color){
 };
 
 void LedFB_GFX::writePixelPreclipped(int16_t x, int16_t y, CRGB color){ 
-  int16_t t;
-  switch (_rotation) {
-  case 1:
-      t = x;
-      x = width() - 1 - y;
-      y = t;
-      break;
-  case 2:
-      x = width() - 1 - x;
-      y = height() - 1 - y;
-      break;
-  case 3:
-      t = x;
-      x = y;
-      y = height() - 1 - t;
-      break;
-  }
+  _rotate(x, y);
 
   std::visit( Overload{ [this, &x, &y, &color](const auto& variant_item) { _drawPixelCRGB(variant_item.get(), x,y,color); }, }, _fb);
 };
 
-void LedFB_GFX::drawBitmap_alphablend(int16_t x, int16_t y,
-                    const uint8_t* bitmap, int16_t w, int16_t h,
-                    CRGB colorFront, uint8_t alphaFront,
-                    CRGB colorBack, uint8_t alphaBack)
-{
-
-  if (!bitmap) return;
-
-  int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-  uint8_t byte = 0;
-
-  //startWrite();
-  for (int16_t j = 0; j < h; j++, y++)
-  {
-    for (int16_t i = 0; i < w; i++)
-    {
-      if (i & 7)
-        byte <<= 1;
-      else
-        byte = bitmap[j * byteWidth + i / 8];
-
-      int16_t __x = x+i;
-      CRGB c( (byte & 0x80) ? colorFront : colorBack );
-      uint8_t alpha((byte & 0x80) ? alphaFront : alphaBack);
-
-      if (alpha == 0)
-        continue;
-      else if (alpha == 255)
-        writePixel(__x, y, c);
-      else
-        std::visit( Overload{ [this, &__x, &y, &c, &alpha](const auto& variant_item) { _nblendCRGB(variant_item.get(), __x, y, c, alpha); }, }, _fb);
-
-      //nblend(canvas->at( x+i, y), byte & 0x80 ? CRGB::Red : CRGB::White, byte & 0x80 ? 208 : 5);  // = alphaBlend(fb->at(x+i, y), byte & 0x80 ? CRGB::Blue : CRGB::Gray,  byte & 0x80 ? 5 : 250 );
-      //color::alphaBlendRGB565
-    }
-  }
-  //endWrite();
-}
-
-void LedFB_GFX::drawBitmap_bgfade(int16_t x, int16_t y,
-                    const uint8_t* bitmap, int16_t w, int16_t h,
-                    CRGB colorFront, uint8_t fadeBy)
-{
-  if (!bitmap) return;
-  int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-  uint8_t byte = 0;
-
-
-  //startWrite();
-  for (int16_t j = 0; j < h; j++, y++)
-  {
-    for (int16_t i = 0; i < w; i++)
-    {
-      if (i & 7)
-        byte <<= 1;
-      else
-        byte = bitmap[j * byteWidth + i / 8];
-
-      int16_t __x = x+i;
-      if (byte & 0x80){
-        // write bitmap pixel with foreground color
-        writePixel(__x, y, colorFront);
-      } else {
-        // fade background where bitmap is zero
-        std::visit( Overload{ [this, &__x, &y, &fadeBy](const auto& variant_item) { _nscale8(variant_item.get(), __x,y,fadeBy); }, }, _fb);
-      }
-    }
-  }
-  //endWrite();
-}
-
-
 void LedFB_GFX::_nscale8( LedFB<uint16_t> *b, int16_t x, int16_t y, uint8_t fadeBy){
   CRGB c(colorCRGB(b->at(x,y)));
   c.nscale8(fadeBy);
   b->at(x,y) = color565(c);
 }
 
-void LedFB_GFX::drawBitmap_scale_colors(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, CRGB colorFront, CRGB colorBack){
-  if (!bitmap) return;
-  int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-  uint8_t byte = 0;
-
-  //startWrite();
-  for (int16_t j = 0; j != h; j++, y++)
-  {
-    for (int16_t i = 0; i != w; i++)
-    {
-      if (i & 7)
-        byte <<= 1;
-      else
-        byte = bitmap[j * byteWidth + i / 8];
-
-      int16_t __x = x+i;
-      CRGB c( (byte & 0x80) ? colorFront : colorBack );
-
-      if (c == CRGB::Black)
-        writePixel(__x, y, CRGB::Black);
-      else if (c == CRGB::White)
-        continue;
-      else
-        std::visit( Overload{ [this, &__x, &y, &c](const auto& variant_item) { _nscale8(variant_item.get(), __x,y,c); }, }, _fb);
-    }
-
-  }
-  //endWrite();
-}
@@ -8,15 +8,124 @@
 #pragma once
 #include "colormath.h"
 #include <vector>
+#include <array>
 #include <memory>
 #include <variant>
 #include <functional>
 #include <list>
+#include <iterator>
 #include "Arduino_GFX.h"
 #include "ledstripe.hpp"
+#include "ledmap.hpp"
+#include "calibration.hpp"
+#include "animclock.hpp"
+#include "symmetry.hpp"
+#include "polarmap.hpp"
 #include "FastLED.h"
+// execution policy aware buffer operations, could be disabled with LEDFB_NO_EXECUTION
+#if !defined(LEDFB_NO_EXECUTION) && __has_include(<execution>)
+  #include <execution>
+  #ifdef __cpp_lib_execution
+    #define LEDFB_WITH_EXECUTION
+  #endif
+#endif
+
+#ifndef LEDFB_INTERPOLATE_MAX_PERIOD
+// max effect frame interval for frame interpolation, ms. Frames rendered slower are blended over this time
+#define LEDFB_INTERPOLATE_MAX_PERIOD    250
+#endif
+
+#ifndef LEDFB_PAR_THRESHOLD
+// buffers smaller than this number of pixels are always processed serially
+#define LEDFB_PAR_THRESHOLD 16384
+#endif
+
+#ifndef LEDFB_DEFER_SCALE_MIN
+// deferred fade factor (Q16) below which it is folded into pixel data, factor resolution drops as it shrinks
+#define LEDFB_DEFER_SCALE_MIN   4096
+#endif
+
+
+#ifdef LEDFB_DEBUG_BOUNDS
+/**
+ * @brief out-of-bounds access log for unchecked accessors
+ * in debug builds unchecked accessors validate indexes and record source location of offending calls
+ * keeps total number of violations and a ring of the last call sites
+ */
+struct BoundsViolationLog {
+    struct site_t {
+        const char *file;
+        int line;
+    };
+    static constexpr size_t depth = 8;
+    static inline size_t count = 0;
+    static inline site_t sites[depth] = {};
 
+    static void record(const char *file, int line){ sites[count % depth] = {file, line}; ++count; }
+    static void reset(){ count = 0; }
+};
 
+/**
+ * @brief call site location, added as a default argument to unchecked accessors in debug builds
+ * a distinct type with an explicit constructor, so that a literal 0 argument could not be taken
+ * for a location and make at_unchecked(x, 0) ambiguous with at_unchecked(idx)
+ */
+struct call_site_t {
+    const char *file;
+    int line;
+    explicit constexpr call_site_t(const char *file = __builtin_FILE(), int line = __builtin_LINE()) : file(file), line(line) {}
+};
+  #define LEDFB_CALL_SITE_DECL , call_site_t site = call_site_t()
+  #define LEDFB_CALL_SITE_ARGS , site
+#else
+  #define LEDFB_CALL_SITE_DECL
+  #define LEDFB_CALL_SITE_ARGS
+#endif
+
+#ifdef LEDFB_ALLOC_TRACKING
+/**
+ * @brief heap activity counter for render hot path
+ * in tracking builds global operator new/delete are replaced to count allocations and frees
+ * made while a hot path scope is active, i.e. within DisplayEngine::show() or buffer flip/copy operations.
+ * Steady-state render cycle is expected to keep both counters at zero.
+ * With LEDFB_ALLOC_TRACKING_ASSERT defined any hot path heap activity triggers an assert
+ * NOTE: counters are not thread-safe, track one rendering task at a time
+ */
+struct AllocTracker {
+    static inline size_t allocs = 0;
+    static inline size_t frees = 0;
+    static inline int depth = 0;
+
+    // RAII hot path marker
+    struct scope {
+        scope(){ ++depth; }
+        ~scope(){ --depth; }
+    };
+
+    static bool active(){ return depth > 0; }
+    static void reset(){ allocs = frees = 0; }
+};
+  // marks a function body as a hot path that must not touch heap
+  #define LEDFB_HOT_PATH AllocTracker::scope ledfb_hot_path_scope_
+#else
+  #define LEDFB_HOT_PATH
+#endif
+
+/**
+ * @brief non-owning view over contiguous pixel data
+ * element access is not bounds checked
+ */
+template <class COLOR_TYPE>
+struct pixel_span {
+    COLOR_TYPE *ptr;
+    size_t len;
+
+    COLOR_TYPE* data() const { return ptr; }
+    size_t size() const { return len; }
+    COLOR_TYPE& operator[](size_t i) const { return ptr[i]; }
+    COLOR_TYPE* begin() const { return ptr; }
+    COLOR_TYPE* end() const { return ptr + len; }
+};
 
 /**
  * @brief Base class with CRGB data storage that acts as a pixel buffer storage
@@ -28,8 +137,13 @@ class PixelDataBuffer {
 
 protected:
     std::vector<COLOR_TYPE> fb;     // container that holds pixel data
+    // deferred scale factor for stored pixels, Q16, see scaleDeferred()
+    uint32_t _dscale{scale_one};
 
 public:
+    // deferred scale factor meaning 'no scaling'
+    static constexpr uint32_t scale_one = 0x10000;
+
     PixelDataBuffer(size_t size) : fb(size) {}
 
     /**
@@ -37,7 +151,7 @@ public:
      *  it also does NOT copy persistence flag
      * @param rhs 
      */
-    PixelDataBuffer(PixelDataBuffer const & rhs) : fb(rhs.fb) {};
+    PixelDataBuffer(PixelDataBuffer const & rhs) : fb(rhs.fb), _dscale(rhs._dscale) {};
 
     /**
      * @brief Copy-assign a new Led FB object
@@ -51,7 +165,7 @@ public:
      * constructor will steal a cled pointer from a rhs object
      * @param rhs 
      */
-    PixelDataBuffer(PixelDataBuffer&& rhs) noexcept : fb(std::move(rhs.fb)){};
+    PixelDataBuffer(PixelDataBuffer&& rhs) noexcept : fb(std::move(rhs.fb)), _dscale(rhs._dscale){};
 
     /**
      * @brief Move assignment operator
@@ -60,6 +174,14 @@ public:
      */
     PixelDataBuffer& operator=(PixelDataBuffer&& rhs);
 
+    /**
+     * @brief evaluate fused buffer expression into this buffer, see fbexpr.hpp
+     * if expression is shorter than the buffer, pixels past it's end are kept with pending deferred scale applied
+     * @param expr - expression
+     */
+    template <class E, typename = std::enable_if_t<E::is_fbexpr>>
+    PixelDataBuffer& operator=(const E &expr){ if (expr.self().size() < fb.size()) fold(); expr.assign(fb.data(), fb.size()); _dscale = scale_one; return *this; }
+
     // d-tor
     virtual ~PixelDataBuffer() = default;
 
@@ -74,10 +196,19 @@ public:
      * config struct is also swapped between object instances
      * @param rhs - object to swap with
      */
-    virtual void swap(PixelDataBuffer& rhs){ std::swap(fb, rhs.fb); };
+    virtual void swap(PixelDataBuffer& rhs){ std::swap(fb, rhs.fb); std::swap(_dscale, rhs._dscale); };
 
-    // get direct access to FB array
-    std::vector<COLOR_TYPE> &data(){ return fb; }
+    /**
+     * @brief get direct access to FB array
+     * pending deferred scale is folded into pixel data first
+     */
+    std::vector<COLOR_TYPE> &data(){ fold(); return fb; }
+
+    /**
+     * @brief get direct read access to FB array
+     * NOTE: stored values are returned as-is, pending deferred scale is not applied, see deferredScale()
+     */
+    const std::vector<COLOR_TYPE> &data() const { return fb; }
 
 
     /**
@@ -106,12 +237,57 @@ public:
      */
     COLOR_TYPE& operator[](size_t i){ return at(i); };
 
+    /**
+     * @brief access pixel at specified position without bounds checking
+     * intended for hot loops that have already clipped indexes,
+     * with LEDFB_DEBUG_BOUNDS defined oob access is redirected to a stub pixel and call site is recorded in BoundsViolationLog.
+     * NOTE: unlike at() pending deferred scale is not folded here, call fold() once before the loop
+     * or take pixels via span()/iterators that fold on entry
+     * @param i offset index
+     * @return COLOR_TYPE& 
+     */
+    COLOR_TYPE& at_unchecked(size_t i LEDFB_CALL_SITE_DECL){
+#ifdef LEDFB_DEBUG_BOUNDS
+        if (i >= fb.size()){ BoundsViolationLog::record(site.file, site.line); return stub_pixel; }
+#endif
+        return fb[i];
+    }
+
+    /**
+     * @brief write pixel at specified position
+     * unlike at() it does not fold deferred scale, color is stored pre-compensated so that
+     * it is output unchanged. oob writes are ignored
+     * @param i offset index
+     * @param color 
+     */
+    void set(size_t i, COLOR_TYPE color);
+
+    /**
+     * @brief get pixel value as it should be sent to display, with deferred scale applied
+     * buffer content is not altered
+     * @param i offset index, no bounds checking
+     */
+    COLOR_TYPE output(size_t i) const;
+
+    /**
+     * @brief get raw view over pixel data
+     * pending deferred scale is folded into pixel data first, view is invalidated on resize
+     */
+    pixel_span<COLOR_TYPE> span(){ fold(); return {fb.data(), fb.size()}; }
+
     /*
         iterators
-        TODO: need proper declaration for this
+        random-access iterators over pixel data in physical order
     */
-    typename std::vector<COLOR_TYPE>::iterator begin(){ return fb.begin(); };
-    typename std::vector<COLOR_TYPE>::iterator end(){ return fb.end(); };
+    using iterator = typename std::vector<COLOR_TYPE>::iterator;
+    using const_iterator = typename std::vector<COLOR_TYPE>::const_iterator;
+
+    iterator begin(){ fold(); return fb.begin(); };
+    iterator end(){ fold(); return fb.end(); };
+    const_iterator begin() const { return fb.cbegin(); };
+    const_iterator end() const { return fb.cend(); };
+    const_iterator cbegin() const { return fb.cbegin(); };
+    const_iterator cend() const { return fb.cend(); };
 
 
     /***    color operations      ***/
@@ -128,8 +304,93 @@ public:
      */
     virtual void clear();
 
+    /**
+     * @brief blend two buffers into this one
+     * i.e. this = a + (b - a) * frac, all buffers must be of same size.
+     * Sources are read as stored, any deferred scale pending on them is ignored
+     * 
+     * @param a - source buffer for frac == 0
+     * @param b - source buffer for frac -> 255
+     * @param frac - blend amount
+     */
+    void lerp(const PixelDataBuffer &a, const PixelDataBuffer &b, uint8_t frac);
+
+    /***    deferred scaling      ***/
+
+    /**
+     * @brief scale whole buffer lazily, same as nscale8(v) applied to each pixel
+     * scale factor is accumulated and applied on output, stored pixels are not touched.
+     * Factor is folded into pixel data once it drops below LEDFB_DEFER_SCALE_MIN,
+     * on a write that could not be pre-compensated, or on any mutable access to pixel data,
+     * i.e. at(), span(), iterators or data(). at_unchecked() does not fold, callers fold once before their loops.
+     * Works for CRGB buffers only, for other types call is ignored
+     * @param v - scale, 255 means no change
+     */
+    void scaleDeferred(uint8_t v);
+
+    /**
+     * @brief get pending deferred scale factor
+     * @return uint32_t - Q16 factor, scale_one if there is nothing pending
+     */
+    uint32_t deferredScale() const { return _dscale; }
+
+    /**
+     * @brief apply pending deferred scale to pixel data
+     * no-op if there is nothing pending
+     */
+    void fold(){ if (_dscale != scale_one) _fold(); }
+
+#ifdef LEDFB_WITH_EXECUTION
+    /***    execution policy aware operations, available where standard library provides <execution>     ***/
+
+    /**
+     * @brief apply a function to each pixel with specified execution policy
+     * buffers smaller than LEDFB_PAR_THRESHOLD pixels are processed serially
+     * 
+     * @param policy - execution policy, i.e. std::execution::par_unseq
+     * @param f - function taking COLOR_TYPE& argument
+     */
+    template <class ExecutionPolicy, class UnaryFunction, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void for_each(ExecutionPolicy &&policy, UnaryFunction f){
+        fold();
+        if (fb.size() < LEDFB_PAR_THRESHOLD)
+            std::for_each(fb.begin(), fb.end(), f);
+        else
+            std::for_each(std::forward<ExecutionPolicy>(policy), fb.begin(), fb.end(), f);
+    }
+
+    /**
+     * @brief fill the buffer with solid color using specified execution policy
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void fill(ExecutionPolicy &&policy, COLOR_TYPE color){
+        if (fb.size() < LEDFB_PAR_THRESHOLD)
+            fill(color);
+        else {
+            std::fill(std::forward<ExecutionPolicy>(policy), fb.begin(), fb.end(), color);
+            _dscale = scale_one;
+        }
+    }
+
+    /**
+     * @brief clear buffer to black using specified execution policy
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void clear(ExecutionPolicy &&policy){ fill(std::forward<ExecutionPolicy>(policy), COLOR_TYPE()); }
+
+    /**
+     * @brief blend two buffers into this one using specified execution policy
+     * @copydetails lerp()
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void lerp(ExecutionPolicy &&policy, const PixelDataBuffer &a, const PixelDataBuffer &b, uint8_t frac);
+#endif  // LEDFB_WITH_EXECUTION
+
     // stub pixel that is mapped to either nonexistent buffer access or blackholed CLedController mapping
     static COLOR_TYPE stub_pixel;
+
+private:
+    void _fold();
 };
 
 // static definition
@@ -261,6 +522,53 @@ protected:
     std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> buffer;
     // coordinate to buffer index mapper callback
     transpose_t _xymap = map_2d;
+    // compiled topology map, if set
+    std::shared_ptr<LedMapLUT> _lut;
+    // id of current topology mapping, keys shared polar maps
+    uint64_t _topology{PolarMap::topology_row_major};
+
+public:
+    // wrap-around addressing modes
+    enum class wrap_t : uint8_t {
+        none = 0,
+        x = 1,          // cylinder, left and right edges are adjacent
+        y = 2,          // cylinder, top and bottom edges are adjacent
+        both = 3        // torus
+    };
+
+protected:
+    wrap_t _wrap{wrap_t::none};
+    // fade()/dim() are deferred to output
+    bool _defer_fade{false};
+    // coordinate masks for power-of-two dimensions, 0xffff otherwise
+    uint16_t _xmask{0xffff}, _ymask{0xffff};
+
+    /**
+     * @brief canvas covers only a part of it's buffer
+     * buffer-wide operations of such canvas are limited by overrides of fill()/clear()/fade()/dim(),
+     * execution policy overloads fall back to those
+     */
+    virtual bool _partial() const { return false; }
+
+    void _updateWrapMasks(){
+        _xmask = (_w & (_w - 1)) ? 0xffff : _w - 1;
+        _ymask = (_h & (_h - 1)) ? 0xffff : _h - 1;
+    }
+
+    // resolve wrapped coordinate, masked for power-of-two lengths, otherwise one conditional subtraction covers most cases.
+    // Zero length is returned as is to fail bounds check
+    static int32_t _wrapc(int32_t v, uint16_t len, uint16_t mask){
+        if (mask != 0xffff) return v & mask;
+        if (!len) return v;
+        if (v >= len){
+            v -= len;
+            if (v >= len) v %= len;
+        } else if (v < 0){
+            v += len;
+            if (v < 0){ v %= len; if (v) v += len; }
+        }
+        return v;
+    }
 
 public:
     // c-tor
@@ -281,6 +589,18 @@ public:
      */
     LedFB(uint16_t w, uint16_t h, std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> fb);
 
+protected:
+    /**
+     * @brief Construct a view over a part of existing buffer
+     * buffer is NOT resized to match dimensions, mapper must keep indexes within buffer
+     * @param w - width
+     * @param h - heigh
+     * @param fb - buffer storage
+     * @param mapper - coordinate to buffer index mapper
+     */
+    LedFB(uint16_t w, uint16_t h, std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> fb, transpose_t mapper) : _w(w), _h(h), buffer(fb), _xymap(mapper), _topology(PolarMap::topologyId()) {}
+
+public:
     /**
      * @brief Copy Construct a new LedFB object
      * A new instance will inherit a SHARED underlying data buffer member
@@ -296,6 +616,14 @@ public:
      */
     LedFB& operator=(LedFB const & rhs) = delete;
 
+    /**
+     * @brief evaluate fused buffer expression into canvas buffer, see fbexpr.hpp
+     * expression is evaluated in physical buffer order
+     * @param expr - expression
+     */
+    template <class E, typename = std::enable_if_t<E::is_fbexpr>>
+    LedFB& operator=(const E &expr){ *buffer = expr; return *this; }
+
     // DIMENSIONS
 
     // get configured matrix width
@@ -325,7 +653,92 @@ public:
      * @param mapper 
      * @return * assign 
      */
-    void setRemapFunction(transpose_t mapper){ _xymap = mapper; };
+    void setRemapFunction(transpose_t mapper){ _xymap = mapper; _lut.reset(); _topology = PolarMap::topologyId(); };
+
+    /**
+     * @brief Set topology lookup table
+     * a compiled map replaces per-pixel transpose calculations with a table lookup
+     * map dimensions must match canvas dimensions
+     * 
+     * @param lut - compiled topology map
+     * @return true on success
+     * @return false if map is empty or it's dimensions do not match canvas
+     */
+    bool setRemapLUT(std::shared_ptr<LedMapLUT> lut);
+
+    /**
+     * @brief get topology lookup table, if set
+     */
+    std::shared_ptr<LedMapLUT> getRemapLUT() const { return _lut; }
+
+    /**
+     * @brief get physical buffer index for logical coordinates x:y
+     * no bounds checking is performed
+     */
+    size_t index(uint16_t x, uint16_t y) const { return _xymap(_w, _h, x, y); }
+
+    // index value for coordinates that do not map to buffer
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    /**
+     * @brief map a batch of coordinates to physical buffer indexes
+     * coordinates are wrapped or bounds-checked like in at(), out of bound pixels are mapped to npos.
+     * With compiled topology map set it is a plain table gather
+     * @param x - array of x coordinates
+     * @param y - array of y coordinates
+     * @param n - number of coordinates
+     * @param idx - output array of buffer indexes
+     */
+    void index(const int16_t *x, const int16_t *y, size_t n, uint32_t *idx) const;
+
+
+    // Wrap-around addressing
+
+    /**
+     * @brief set wrap-around mode
+     * coordinates outside of canvas along wrapped axis are resolved to the other side, i.e. for cylindrical lamps.
+     * Affects at(), blit(), scroll() and GFX drawing, at_unchecked() and iterators are not affected
+     * @param mode 
+     */
+    void setWrap(wrap_t mode){ _wrap = mode; _updateWrapMasks(); }
+
+    // get wrap-around mode
+    wrap_t getWrap() const { return _wrap; }
+
+    // returns true if x axis is wrapped
+    bool wrapX() const { return static_cast<uint8_t>(_wrap) & static_cast<uint8_t>(wrap_t::x); }
+
+    // returns true if y axis is wrapped
+    bool wrapY() const { return static_cast<uint8_t>(_wrap) & static_cast<uint8_t>(wrap_t::y); }
+
+    /**
+     * @brief copy a block of pixels to canvas
+     * block is clipped to canvas, or wrapped around if wrap mode is set
+     * @param x - top left corner x coordinate
+     * @param y - top left corner y coordinate
+     * @param src - row-major source pixels
+     * @param w - block width
+     * @param h - block height
+     */
+    void blit(int16_t x, int16_t y, const COLOR_TYPE *src, uint16_t w, uint16_t h);
+
+    /**
+     * @brief copy another canvas to this one
+     * source is clipped to canvas, or wrapped around if wrap mode is set
+     * @param x - top left corner x coordinate
+     * @param y - top left corner y coordinate
+     * @param src - source canvas
+     */
+    void blit(int16_t x, int16_t y, LedFB<COLOR_TYPE> &src);
+
+    /**
+     * @brief scroll canvas content
+     * along wrapped axis content is rotated in-place, otherwise vacated pixels are filled with specified color
+     * @param dx - horizontal offset, positive scrolls right
+     * @param dy - vertical offset, positive scrolls down
+     * @param color - color to fill vacated pixels with
+     */
+    void scroll(int16_t dx, int16_t dy, COLOR_TYPE color = COLOR_TYPE());
 
 
     // DATA BUFFER OPERATIONS
@@ -358,12 +771,128 @@ public:
      */
     COLOR_TYPE& at(size_t idx){ return buffer->at(idx); };
 
+    /**
+     * @brief write pixel at coordinates x:y
+     * same addressing as at(), but does not fold deferred fade, color is stored pre-compensated instead.
+     * oob writes are ignored
+     * @param x coordinate starting from top left corner
+     * @param y coordinate starting from top left corner
+     * @param color 
+     */
+    void set(int16_t x, int16_t y, COLOR_TYPE color);
+
+    /**
+     * @brief access pixel at coordinates x:y without bounds checking
+     * intended for hot loops that have already clipped coordinates,
+     * with LEDFB_DEBUG_BOUNDS defined it acts like at() and records offending call sites in BoundsViolationLog.
+     * NOTE: pending deferred fade is not folded, call fold() once before the loop
+     * @param x coordinate starting from top left corner
+     * @param y coordinate starting from top left corner
+     */
+    COLOR_TYPE& at_unchecked(int16_t x, int16_t y LEDFB_CALL_SITE_DECL){
+#ifdef LEDFB_DEBUG_BOUNDS
+        if (x < 0 || y < 0 || x >= _w || y >= _h){ BoundsViolationLog::record(site.file, site.line); return buffer->stub_pixel; }
+#endif
+        return buffer->at_unchecked(_xymap(_w, _h, static_cast<uint16_t>(x), static_cast<uint16_t>(y)) LEDFB_CALL_SITE_ARGS);
+    }
+
+    /**
+     * @brief access pixel at index without bounds checking
+     * @param idx 
+     */
+    COLOR_TYPE& at_unchecked(size_t idx LEDFB_CALL_SITE_DECL){ return buffer->at_unchecked(idx LEDFB_CALL_SITE_ARGS); };
+
+    /**
+     * @brief get raw view over underlying buffer data in physical order
+     * view is invalidated on resize
+     */
+    pixel_span<COLOR_TYPE> span(){ return buffer->span(); }
+
     /*
         data buffer iterators
-        TODO: need proper declaration for this
+        random-access iterators over pixel data in physical order
     */
-    typename std::vector<COLOR_TYPE>::iterator begin(){ return buffer->begin(); };
-    typename std::vector<COLOR_TYPE>::iterator end(){ return buffer->end(); };
+    using iterator = typename PixelDataBuffer<COLOR_TYPE>::iterator;
+
+    iterator begin(){ return buffer->begin(); };
+    iterator end(){ return buffer->end(); };
+
+    /**
+     * @brief random-access iterator over canvas pixels in logical row-major order
+     * i.e. (0,0), (1,0), ... (w-1,0), (0,1), ... pixels are resolved through topology mapping,
+     * with compiled topology map set it's a plain table lookup
+     * Iterator is invalidated on canvas resize or mapping change
+     */
+    class xy_iterator {
+        LedFB *_fb{nullptr};
+        const LedMapLUT::index_t *_lut{nullptr};
+        COLOR_TYPE *_data{nullptr};
+        std::ptrdiff_t _n{0};
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = COLOR_TYPE;
+        using difference_type = std::ptrdiff_t;
+        using pointer = COLOR_TYPE*;
+        using reference = COLOR_TYPE&;
+
+        xy_iterator() = default;
+        xy_iterator(LedFB *fb, std::ptrdiff_t n) : _fb(fb), _lut(fb->_lut ? fb->_lut->data() : nullptr), _data(fb->buffer->data().data()), _n(n) {}
+
+        // logical coordinates of the pixel iterator points to
+        int16_t x() const { return _n % _fb->_w; }
+        int16_t y() const { return _n / _fb->_w; }
+
+        reference operator*() const { return _lut ? _data[_lut[_n]] : _fb->at_unchecked(x(), y()); }
+        pointer operator->() const { return &operator*(); }
+        reference operator[](difference_type d) const { return *(*this + d); }
+
+        xy_iterator& operator++(){ ++_n; return *this; }
+        xy_iterator operator++(int){ xy_iterator t(*this); ++_n; return t; }
+        xy_iterator& operator--(){ --_n; return *this; }
+        xy_iterator operator--(int){ xy_iterator t(*this); --_n; return t; }
+        xy_iterator& operator+=(difference_type d){ _n += d; return *this; }
+        xy_iterator& operator-=(difference_type d){ _n -= d; return *this; }
+        friend xy_iterator operator+(xy_iterator it, difference_type d){ return it += d; }
+        friend xy_iterator operator+(difference_type d, xy_iterator it){ return it += d; }
+        friend xy_iterator operator-(xy_iterator it, difference_type d){ return it -= d; }
+        friend difference_type operator-(const xy_iterator &a, const xy_iterator &b){ return a._n - b._n; }
+
+        friend bool operator==(const xy_iterator &a, const xy_iterator &b){ return a._n == b._n; }
+        friend bool operator!=(const xy_iterator &a, const xy_iterator &b){ return a._n != b._n; }
+        friend bool operator<(const xy_iterator &a, const xy_iterator &b){ return a._n < b._n; }
+        friend bool operator>(const xy_iterator &a, const xy_iterator &b){ return a._n > b._n; }
+        friend bool operator<=(const xy_iterator &a, const xy_iterator &b){ return a._n <= b._n; }
+        friend bool operator>=(const xy_iterator &a, const xy_iterator &b){ return a._n >= b._n; }
+    };
+
+    /**
+     * @brief a pair of iterators usable in range-for loops and standard algorithms
+     */
+    template <class ITERATOR>
+    struct range {
+        ITERATOR first, last;
+        ITERATOR begin() const { return first; }
+        ITERATOR end() const { return last; }
+        size_t size() const { return std::distance(first, last); }
+    };
+
+    /**
+     * @brief range over all canvas pixels in physical buffer order
+     * fastest way to apply an operation that does not depend on pixel coordinates
+     */
+    range<iterator> physical(){ return {begin(), end()}; }
+
+    /**
+     * @brief range over all canvas pixels in logical row-major order
+     */
+    range<xy_iterator> logical(){ return {xy_iterator(this, 0), xy_iterator(this, static_cast<std::ptrdiff_t>(_w) * _h)}; }
+
+    /**
+     * @brief range over pixels of a single canvas row in logical order
+     * @param y - row number
+     */
+    range<xy_iterator> row(int16_t y){ return {xy_iterator(this, static_cast<std::ptrdiff_t>(y) * _w), xy_iterator(this, static_cast<std::ptrdiff_t>(y + 1) * _w)}; }
 
 
     // FastLED buffer-wide color functions (here just a wrappers, but could be overriden in derived classes)
@@ -373,81 +902,160 @@ public:
      * same as dim(255 - v)
      * @param v 
      */
-    void fade(uint8_t v);
+    virtual void fade(uint8_t v);
 
     /**
      * @brief apply FastLED nscale8() func to buffer
      * i.e. dim whole buffer to black
      * @param v 
      */
-    void dim(uint8_t v);
+    virtual void dim(uint8_t v);
+
+    /**
+     * @brief defer fade()/dim() to output stage
+     * for trail effects that fade whole canvas each frame and draw a few new pixels.
+     * Fades are accumulated into a buffer-wide factor applied when data is sent to display,
+     * pixels written with set() or GFX are pre-compensated, so visual result is unchanged.
+     * Factor is folded into pixel data when it's precision runs out or pixels are accessed
+     * for read-modify-write, i.e. via at(), iterators or span(). CRGB canvas only
+     * @param active - enable/disable, disabling folds pending factor
+     */
+    void deferFade(bool active){ _defer_fade = active; if (!active) buffer->fold(); }
+
+    // check if fades are deferred
+    bool deferFade() const { return _defer_fade; }
+
+    /**
+     * @brief apply pending deferred fade to pixel data
+     */
+    void fold(){ buffer->fold(); }
 
     /**
      * @brief fill the buffer with solid color
      * 
      */
-    void fill(COLOR_TYPE color){ buffer->fill(color); };
+    virtual void fill(COLOR_TYPE color){ buffer->fill(color); };
 
     /**
      * @brief clear buffer to black
      * 
      */
-    void clear(){ buffer->clear(); };
+    virtual void clear(){ buffer->clear(); };
 
-};
+    // Symmetry
 
-// overload pattern and deduction guide. Lambdas provide call operator
-template<class... Ts> struct Overload : Ts... { using Ts::operator()...; };
-template<class... Ts> Overload(Ts...) -> Overload<Ts...>;
+    /**
+     * @brief build symmetry map for current canvas dimensions and topology
+     * 
+     * @param map - map to build
+     * @param mode - symmetry type
+     * @param folds - number of sectors for radial symmetry
+     * @return true on success
+     */
+    bool buildSymmetry(SymmetryMap &map, SymmetryMap::mode_t mode, uint8_t folds = 6) const {
+        return map.build(mode, _w, _h, [this](unsigned x, unsigned y){ return index(x, y); }, folds);
+    }
 
-/**
- * @brief GFX class for LedFB
- * it provides Arduino_GFX API for uderlaying buffer with either CRGB or uint16_t color container
- * 
- */
-class LedFB_GFX : public Arduino_GFX {
+    /**
+     * @brief replicate fundamental region of the canvas according to symmetry map
+     * an effect should render only pixels where map.fundamental(x, y) is true and then call this method
+     * @param map - symmetry map built for this canvas, map built for other dimensions is ignored
+     */
+    void mirror(const SymmetryMap &map){ if (map.w() == _w && map.h() == _h) map.apply(buffer->data().data(), buffer->size()); }
 
-protected:
-    // LedFB container variant
-    std::variant< std::shared_ptr< LedFB<CRGB> >, std::shared_ptr< LedFB<uint16_t> >  > _fb;
+    // Polar coordinates
 
-public:
     /**
-     * @brief Construct a new LedFB_GFX object from a LedFB<CRGB> 24 bit color
+     * @brief get shared polar map for current canvas dimensions and topology
+     * topology is identified by the last setRemapFunction()/setRemapLUT() call,
+     * a mapper that changes it's mapping in place must be set again to get a new map
      * 
-     * @param buff - a shared pointer to the LedFB object
+     * @param cx - centre x coordinate
+     * @param cy - centre y coordinate
      */
-    LedFB_GFX(std::shared_ptr< LedFB<CRGB> > buff) : Arduino_GFX(buff->w(), buff->h()), _fb(buff) {}
+    std::shared_ptr<const PolarMap> polarMap(float cx, float cy) const {
+        return PolarMap::get(_w, _h, _topology, [this](unsigned x, unsigned y){ return index(x, y); }, cx, cy);
+    }
 
     /**
-     * @brief Construct a new LedFB_GFX object from a LedFB<uint16_t> 16 bit color
-     * 
-     * @param buff - a shared pointer to the LedFB object
+     * @brief get shared polar map centered at the middle of the canvas
      */
-    LedFB_GFX(std::shared_ptr< LedFB<uint16_t> > buff) : Arduino_GFX(buff->w(), buff->h()), _fb(buff) {}
-
-    virtual ~LedFB_GFX() = default;
+    std::shared_ptr<const PolarMap> polarMap() const { return polarMap((_w - 1) / 2.0f, (_h - 1) / 2.0f); }
 
+    /**
+     * @brief render whole canvas from polar coordinates in one pass
+     * 
+     * @param map - polar map built for this canvas
+     * @param f - callable COLOR_TYPE f(uint16_t angle16, uint16_t radius16), radius is 8.8 fixed point
+     */
+    template <typename F>
+    void fillPolar(const PolarMap &map, F &&f){ map.fill(buffer->data().data(), buffer->size(), std::forward<F>(f)); }
 
+#ifdef LEDFB_WITH_EXECUTION
+    /**
+     * @brief apply fadeToBlackBy() to buffer using specified execution policy
+     * canvases smaller than LEDFB_PAR_THRESHOLD pixels are processed serially,
+     * deferred fades and partial canvases go through virtual fade()
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void fade(ExecutionPolicy &&policy, uint8_t v){
+        if (_defer_fade || _partial()) return fade(v);
+        dim(std::forward<ExecutionPolicy>(policy), 255 - v);
+    }
 
-    // Arduino GFX overrides
-    bool begin(int32_t speed = GFX_NOT_DEFINED) override { return true; };
+    /**
+     * @brief apply nscale8() to buffer using specified execution policy
+     * deferred fades and partial canvases go through virtual dim()
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void dim(ExecutionPolicy &&policy, uint8_t v);
 
-    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override;
+    /**
+     * @brief fill the buffer with solid color using specified execution policy
+     * partial canvases go through virtual fill()
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void fill(ExecutionPolicy &&policy, COLOR_TYPE color){
+        if (_partial()) return fill(color);
+        buffer->fill(std::forward<ExecutionPolicy>(policy), color);
+    };
 
-    void writePixelPreclipped(int16_t x, int16_t y, CRGB color);
+    /**
+     * @brief clear buffer to black using specified execution policy
+     * partial canvases go through virtual clear()
+     */
+    template <class ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    void clear(ExecutionPolicy &&policy){
+        if (_partial()) return clear();
+        buffer->clear(std::forward<ExecutionPolicy>(policy));
+    };
+#endif  // LEDFB_WITH_EXECUTION
 
-    // mapped writePixel methods
-    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, uint16_t color){ writePixelPreclipped(x, y, color); };
-    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, CRGB color){ writePixelPreclipped(x, y, color); };
+};
 
-    // an override
-    void fillScreen(uint16_t color);
+// overload pattern and deduction guide. Lambdas provide call operator
+template<class... Ts> struct Overload : Ts... { using Ts::operator()...; };
+template<class... Ts> Overload(Ts...) -> Overload<Ts...>;
 
-    // an overload for CRGB
-    void fillScreen(CRGB color);
+/**
+ * @brief common part of Arduino_GFX canvas classes
+ * implements display rotation, bitmap drawing functions and color conversion once for all canvas types (CRTP),
+ * DERIVED class provides only access to it's own buffer:
+ *  - writePixel(x, y, CRGB) - write a pixel in display coordinates
+ *  - _blendPixel(x, y, CRGB overlay, fract8 amountOfOverlay) - blend a pixel in buffer coordinates
+ *  - _fadePixel(x, y, uint8_t fadeBy) - dim a pixel in buffer coordinates
+ *  - _scalePixel(x, y, CRGB color) - scale a pixel with a color in buffer coordinates
+ *
+ * @tparam DERIVED - canvas class
+ */
+template <class DERIVED>
+class LedFB_GFX_Base : public Arduino_GFX {
 
+public:
+    LedFB_GFX_Base(int16_t w, int16_t h) : Arduino_GFX(w, h) {}
 
+    // Arduino GFX overrides
+    bool begin(int32_t speed = GFX_NOT_DEFINED) override { return true; };
 
     // ***** Additional graphics functions *****
 
@@ -536,15 +1144,100 @@ public:
      */
     static uint16_t color565(CRGB c){ return c.r >> 3 << 11 | c.g >> 2 << 5 | c.b >> 3; }
 
+protected:
+    // apply display rotation to coordinates
+    __attribute__((always_inline)) inline void _rotate(int16_t &x, int16_t &y) const {
+        int16_t t;
+        switch (_rotation) {
+        case 1:
+            t = x;
+            x = width() - 1 - y;
+            y = t;
+            break;
+        case 2:
+            x = width() - 1 - x;
+            y = height() - 1 - y;
+            break;
+        case 3:
+            t = x;
+            x = y;
+            y = height() - 1 - t;
+            break;
+        }
+    }
+
+private:
+    DERIVED* _self(){ return static_cast<DERIVED*>(this); }
+};
+
+/**
+ * @brief GFX class for LedFB
+ * it provides Arduino_GFX API for uderlaying buffer with either CRGB or uint16_t color container
+ * 
+ */
+class LedFB_GFX : public LedFB_GFX_Base<LedFB_GFX> {
+    friend class LedFB_GFX_Base<LedFB_GFX>;
 
 protected:
+    // LedFB container variant
+    std::variant< std::shared_ptr< LedFB<CRGB> >, std::shared_ptr< LedFB<uint16_t> >  > _fb;
+
+public:
+    /**
+     * @brief Construct a new LedFB_GFX object from a LedFB<CRGB> 24 bit color
+     * 
+     * @param buff - a shared pointer to the LedFB object
+     */
+    LedFB_GFX(std::shared_ptr< LedFB<CRGB> > buff) : LedFB_GFX_Base(buff->w(), buff->h()), _fb(buff) {}
+
+    /**
+     * @brief Construct a new LedFB_GFX object from a LedFB<uint16_t> 16 bit color
+     * 
+     * @param buff - a shared pointer to the LedFB object
+     */
+    LedFB_GFX(std::shared_ptr< LedFB<uint16_t> > buff) : LedFB_GFX_Base(buff->w(), buff->h()), _fb(buff) {}
+
+    virtual ~LedFB_GFX() = default;
+
+
+
+    // Arduino GFX overrides
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override;
+
+    void writePixelPreclipped(int16_t x, int16_t y, CRGB color);
+
+    // mapped writePixel methods
+    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, uint16_t color){ writePixelPreclipped(x, y, color); };
+    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, CRGB color){ writePixelPreclipped(x, y, color); };
+
+    // an override
+    void fillScreen(uint16_t color);
+
+    // an overload for CRGB
+    void fillScreen(CRGB color);
+
+    // lines and rectangles are drawn pixel by pixel through wrapping at() if canvas wraps, otherwise they are clipped as usual
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+
+
+protected:
+    // returns true if canvas has wrap-around addressing
+    bool _wraps() const;
+
+    // pixel primitives for LedFB_GFX_Base, buffer coordinates
+    void _blendPixel(int16_t x, int16_t y, CRGB overlay, fract8 amountOfOverlay){ std::visit( Overload{ [&](const auto& variant_item) { _nblendCRGB(variant_item.get(), x, y, overlay, amountOfOverlay); }, }, _fb); };
+    void _fadePixel(int16_t x, int16_t y, uint8_t fadeBy){ std::visit( Overload{ [&](const auto& variant_item) { _nscale8(variant_item.get(), x, y, fadeBy); }, }, _fb); };
+    void _scalePixel(int16_t x, int16_t y, CRGB color){ std::visit( Overload{ [&](const auto& variant_item) { _nscale8(variant_item.get(), x, y, color); }, }, _fb); };
+
     // Additional methods
 
-    void _drawPixelCRGB( LedFB<CRGB> *b, int16_t x, int16_t y, CRGB c){ b->at(x,y) = c; };
-    void _drawPixelCRGB( LedFB<uint16_t> *b, int16_t x, int16_t y, CRGB c){ b->at(x,y) = color565(c); };
+    void _drawPixelCRGB( LedFB<CRGB> *b, int16_t x, int16_t y, CRGB c){ b->set(x,y,c); };
+    void _drawPixelCRGB( LedFB<uint16_t> *b, int16_t x, int16_t y, CRGB c){ b->set(x,y,color565(c)); };
 
-    void _drawPixel565( LedFB<CRGB> *b, int16_t x, int16_t y, uint16_t c){ b->at(x,y) = colorCRGB(c); };
-    void _drawPixel565( LedFB<uint16_t> *b, int16_t x, int16_t y, uint16_t c){ b->at(x,y) = c; };
+    void _drawPixel565( LedFB<CRGB> *b, int16_t x, int16_t y, uint16_t c){ b->set(x,y,colorCRGB(c)); };
+    void _drawPixel565( LedFB<uint16_t> *b, int16_t x, int16_t y, uint16_t c){ b->set(x,y,c); };
 
     void _fillScreenCRGB(LedFB<CRGB> *b, CRGB c){ b->fill(c); };
     void _fillScreenCRGB(LedFB<uint16_t> *b, CRGB c){ b->fill(color565(c)); };
@@ -581,6 +1274,133 @@ protected:
 
 };
 
+/**
+ * @brief GFX class for LedFB with a single color type resolved at compile time
+ * unlike LedFB_GFX it does not hold a variant and does not visit it on each pixel,
+ * so drawing paths inline down to the buffer store. Use LedFB_GFX if color type must be selected at run time
+ * 
+ * @tparam COLOR_TYPE - CRGB or uint16_t (RGB565)
+ */
+template <class COLOR_TYPE = CRGB>
+class LedFB_GFX_T : public LedFB_GFX_Base< LedFB_GFX_T<COLOR_TYPE> > {
+    friend class LedFB_GFX_Base< LedFB_GFX_T<COLOR_TYPE> >;
+
+protected:
+    std::shared_ptr< LedFB<COLOR_TYPE> > _fb;
+
+public:
+    /**
+     * @brief Construct a new LedFB_GFX_T object
+     * 
+     * @param buff - a shared pointer to the LedFB object
+     */
+    LedFB_GFX_T(std::shared_ptr< LedFB<COLOR_TYPE> > buff) : LedFB_GFX_Base< LedFB_GFX_T<COLOR_TYPE> >(buff->w(), buff->h()), _fb(buff) {}
+
+    virtual ~LedFB_GFX_T() = default;
+
+    // Arduino GFX overrides
+    void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) override { this->_rotate(x, y); COLOR_TYPE c; _set(c, color); _fb->set(x, y, c); };
+
+    void writePixelPreclipped(int16_t x, int16_t y, CRGB color){ this->_rotate(x, y); COLOR_TYPE c; _set(c, color); _fb->set(x, y, c); };
+
+    // lines and rectangles are drawn pixel by pixel through wrapping at() if canvas wraps, otherwise they are clipped as usual
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+        if (_fb->getWrap() == LedFB<COLOR_TYPE>::wrap_t::none) return Arduino_GFX::writeFastHLine(x, y, w, color);
+        for (int16_t i = 0; i < w; ++i) writePixelPreclipped(x + i, y, color);
+    };
+
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+        if (_fb->getWrap() == LedFB<COLOR_TYPE>::wrap_t::none) return Arduino_GFX::writeFastVLine(x, y, h, color);
+        for (int16_t i = 0; i < h; ++i) writePixelPreclipped(x, y + i, color);
+    };
+
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+        if (_fb->getWrap() == LedFB<COLOR_TYPE>::wrap_t::none) return Arduino_GFX::writeFillRect(x, y, w, h, color);
+        for (int16_t j = 0; j < h; ++j) writeFastHLine(x, y + j, w, color);
+    };
+
+    // mapped writePixel methods
+    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, uint16_t color){ writePixelPreclipped(x, y, color); };
+    __attribute__((always_inline)) inline void writePixel(int16_t x, int16_t y, CRGB color){ writePixelPreclipped(x, y, color); };
+
+    // an override
+    void fillScreen(uint16_t color){ COLOR_TYPE c; _set(c, color); _fb->fill(c); };
+
+    // an overload for CRGB
+    void fillScreen(CRGB color){ COLOR_TYPE c; _set(c, color); _fb->fill(c); };
+
+
+protected:
+    // pixel primitives for LedFB_GFX_Base, buffer coordinates
+    void _blendPixel(int16_t x, int16_t y, CRGB overlay, fract8 amountOfOverlay){ _nblend(_fb->at(x, y), overlay, amountOfOverlay); };
+    void _fadePixel(int16_t x, int16_t y, uint8_t fadeBy){ _nscale8(_fb->at(x, y), fadeBy); };
+    void _scalePixel(int16_t x, int16_t y, CRGB color){ _nscale8(_fb->at(x, y), color); };
+
+    // pixel operations, resolved by overloading on buffer color type
+    static void _set(CRGB &p, CRGB c){ p = c; };
+    static void _set(CRGB &p, uint16_t c){ p = LedFB_GFX::colorCRGB(c); };
+    static void _set(uint16_t &p, CRGB c){ p = LedFB_GFX::color565(c); };
+    static void _set(uint16_t &p, uint16_t c){ p = c; };
+
+    static void _nblend(CRGB &p, CRGB overlay, fract8 amountOfOverlay){ nblend(p, overlay, amountOfOverlay); };
+    static void _nblend(uint16_t &p, CRGB overlay, fract8 amountOfOverlay){ p = color::alphaBlendRGB565(LedFB_GFX::color565(overlay), p, amountOfOverlay); };
+
+    static void _nscale8(CRGB &p, uint8_t fadeBy){ p.nscale8(fadeBy); };
+    static void _nscale8(uint16_t &p, uint8_t fadeBy){ p = LedFB_GFX::color565(LedFB_GFX::colorCRGB(p).nscale8(fadeBy)); };
+
+    static void _nscale8(CRGB &p, CRGB color){ p.nscale8(color); };
+    static void _nscale8(uint16_t &p, CRGB color){ p = LedFB_GFX::color565(LedFB_GFX::colorCRGB(p).nscale8(color)); };
+};
+
+
+/**
+ * @brief a pair of simulation state buffers for fixed-timestep effects
+ * effect advances it's state in current buffer on each simulation step of AnimationClock,
+ * render stage blends previous and current states into canvas with clock's interpolation factor,
+ * so expensive effects could be updated at lower rate while output stays smooth
+ */
+template <class COLOR_TYPE = CRGB>
+class InterpolatedState {
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> _prev, _cur;
+
+public:
+    InterpolatedState(size_t size) : _prev(std::make_shared<PixelDataBuffer<COLOR_TYPE>>(size)), _cur(std::make_shared<PixelDataBuffer<COLOR_TYPE>>(size)) {}
+
+    /**
+     * @brief start next simulation step
+     * current state is saved as previous one and returned for simulation to advance it
+     * 
+     * @return PixelDataBuffer<COLOR_TYPE>& - current state buffer
+     */
+    PixelDataBuffer<COLOR_TYPE>& step(){ std::copy(_cur->data().cbegin(), _cur->data().cend(), _prev->data().begin()); return *_cur; }
+
+    // current simulation state
+    PixelDataBuffer<COLOR_TYPE>& current(){ return *_cur; }
+
+    // previous simulation state
+    PixelDataBuffer<COLOR_TYPE>& previous(){ return *_prev; }
+
+    /**
+     * @brief get a pointer to current state buffer, i.e. to bind a LedFB canvas to it
+     * pointer stays valid across steps
+     */
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> buffer(){ return _cur; }
+
+    /**
+     * @brief render interpolated state into destination buffer
+     * 
+     * @param dst - destination buffer, must be of same size as state buffers
+     * @param alpha - interpolation factor, i.e. AnimationClock::alpha()
+     */
+    void render(PixelDataBuffer<COLOR_TYPE> &dst, uint8_t alpha){ dst.lerp(*_prev, *_cur, alpha); }
+
+    /**
+     * @brief resize state buffers
+     * content will be lost on resize
+     */
+    bool resize(size_t s){ return _prev->resize(s) && _cur->resize(s); }
+};
+
 
 /**
  * @brief abstract overlay engine
@@ -597,6 +1417,23 @@ protected:
      */
     //std::unique_ptr< LedFB_GFX > gfx;
 
+    // output stage calibration map
+    std::shared_ptr<CalibrationMap> _calibration;
+
+    // animation clock, updated on each show()
+    std::shared_ptr<AnimationClock> _clock;
+
+    // frame interpolation state, last two committed frames
+    std::unique_ptr<InterpolatedState<COLOR_TYPE>> _interp;
+    // last frame commit timestamp and measured frame interval, ms
+    uint32_t _frame_ts{0}, _frame_period{0};
+    // interpolation factor for current output frame
+    uint8_t _ialpha{255};
+    // engine blends interpolated frames in it's own output pass, no buffer is written by show()
+    bool _blend_inline{false};
+    // engine applies buffer's deferred scale in it's own output pass, otherwise it is folded before engine_show()
+    bool _scale_on_output{false};
+
     /**
      * @brief pure virtual method implementing rendering buffer content to backend driver
      * 
@@ -630,6 +1467,69 @@ public:
      */
     virtual uint8_t brightness(uint8_t b){ return 0; };
 
+    /**
+     * @brief set per-pixel calibration map
+     * map is applied on data conversion to the backend, canvas content is not altered
+     * 
+     * @param map - calibration map, an empty pointer disables calibration
+     */
+    virtual void setCalibration(std::shared_ptr<CalibrationMap> map){ _calibration = map; };
+
+    /**
+     * @brief get a pointer to active calibration map, if any
+     */
+    std::shared_ptr<CalibrationMap> getCalibration() const { return _calibration; }
+
+    /**
+     * @brief attach animation clock
+     * clock is updated on each show() call before data is sent to the backend,
+     * i.e. it's simulation and render callbacks are run in sync with display output
+     * 
+     * @param clock - animation clock, an empty pointer detaches the clock
+     */
+    void setClock(std::shared_ptr<AnimationClock> clock){ _clock = clock; };
+
+    /**
+     * @brief get a pointer to attached animation clock, if any
+     */
+    std::shared_ptr<AnimationClock> getClock() const { return _clock; }
+
+    /**
+     * @brief enable temporal frame interpolation
+     * for effects that could not be rendered at output rate. Effect renders frames into a separate buffer
+     * between beginFrame() and commitFrame() calls, and each show() outputs a blend of the last two committed frames
+     * according to the time passed since last commit and measured frame interval.
+     * Output lags one effect frame behind
+     * 
+     * @param active - enable/disable interpolation, disabling it releases frame buffers
+     */
+    void interpolate(bool active);
+
+    // check if frame interpolation is enabled
+    bool interpolate() const { return _interp.get(); }
+
+    /**
+     * @brief start rendering an effect frame for interpolation
+     * last committed frame is preserved, returned buffer contains it's copy to draw on.
+     * If interpolation is off, frame is drawn directly to engine's active buffer,
+     * an empty buffer is returned if engine has no active buffer
+     * 
+     * @return PixelDataBuffer<COLOR_TYPE>& - buffer to render a frame to
+     */
+    PixelDataBuffer<COLOR_TYPE>& beginFrame();
+
+    /**
+     * @brief get a pointer to the frame buffer used with interpolation, i.e. to bind a LedFB canvas to it
+     * pointer is valid until interpolation is disabled, an empty pointer is returned if interpolation is off
+     */
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> getFrameBuffer(){ return _interp ? _interp->buffer() : nullptr; }
+
+    /**
+     * @brief mark rendered frame as complete
+     * output starts blending towards this frame
+     */
+    void commitFrame();
+
     /**
      * @brief activate double buffer
      * 
@@ -688,13 +1588,13 @@ public:
 
 
 
-
 //  *** TEMPLATES IMPLEMENTATION FOLLOWS *** //
 
 // copy via assignment
 template <class COLOR_TYPE>
 PixelDataBuffer<COLOR_TYPE>& PixelDataBuffer<COLOR_TYPE>::operator=(PixelDataBuffer<COLOR_TYPE> const& rhs){
     fb = rhs.fb;
+    _dscale = rhs._dscale;
     return *this;
 }
 
@@ -702,18 +1602,113 @@ PixelDataBuffer<COLOR_TYPE>& PixelDataBuffer<COLOR_TYPE>::operator=(PixelDataBuf
 template <class COLOR_TYPE>
 PixelDataBuffer<COLOR_TYPE>& PixelDataBuffer<COLOR_TYPE>::operator=(PixelDataBuffer<COLOR_TYPE>&& rhs){
     fb = std::move(rhs.fb);
+    _dscale = rhs._dscale;
     return *this;
 }
 
 template <class COLOR_TYPE>
-COLOR_TYPE& PixelDataBuffer<COLOR_TYPE>::at(size_t i){ return i < fb.size() ? fb.at(i) : stub_pixel; };      // blackhole is only of type CRGB, need some other specialisations
+COLOR_TYPE& PixelDataBuffer<COLOR_TYPE>::at(size_t i){ fold(); return i < fb.size() ? fb[i] : stub_pixel; };      // blackhole is only of type CRGB, need some other specialisations
+
+template <class COLOR_TYPE>
+void PixelDataBuffer<COLOR_TYPE>::set(size_t i, COLOR_TYPE color){
+    if (i >= fb.size()) return;
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        if (_dscale != scale_one){
+            // smallest stored value that is output as the requested one, (s * f) >> 16 == c
+            uint32_t r = (color.r * scale_one + _dscale - 1) / _dscale;
+            uint32_t g = (color.g * scale_one + _dscale - 1) / _dscale;
+            uint32_t b = (color.b * scale_one + _dscale - 1) / _dscale;
+            if ((r | g | b) < 256){
+                fb[i] = CRGB(r, g, b);
+                return;
+            }
+            // too bright for current factor, no way to keep it deferred
+            _fold();
+        }
+    }
+    fb[i] = color;
+}
+
+template <class COLOR_TYPE>
+COLOR_TYPE PixelDataBuffer<COLOR_TYPE>::output(size_t i) const {
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        if (_dscale != scale_one){
+            const CRGB &c = fb[i];
+            return CRGB((c.r * _dscale) >> 16, (c.g * _dscale) >> 16, (c.b * _dscale) >> 16);
+        }
+    }
+    return fb[i];
+}
 
 template <class COLOR_TYPE>
-void PixelDataBuffer<COLOR_TYPE>::fill(COLOR_TYPE color){ fb.assign(fb.size(), color); };
+void PixelDataBuffer<COLOR_TYPE>::scaleDeferred(uint8_t v){
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        // same rounding as nscale8(), x * (v + 1) >> 8
+        _dscale = (_dscale * (v + 1u)) >> 8;
+        if (_dscale < LEDFB_DEFER_SCALE_MIN) _fold();
+    }
+}
+
+template <class COLOR_TYPE>
+void PixelDataBuffer<COLOR_TYPE>::_fold(){
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        static_assert(sizeof(CRGB) == 3, "CRGB must be a packed byte triplet");
+        const uint32_t f = _dscale;
+        uint8_t *p = reinterpret_cast<uint8_t*>(fb.data());
+        for (size_t i = 0, len = fb.size() * sizeof(CRGB); i != len; ++i)
+            p[i] = (p[i] * f) >> 16;
+    }
+    _dscale = scale_one;
+}
+
+template <class COLOR_TYPE>
+void PixelDataBuffer<COLOR_TYPE>::fill(COLOR_TYPE color){ fb.assign(fb.size(), color); _dscale = scale_one; };
 
 template <class COLOR_TYPE>
 void PixelDataBuffer<COLOR_TYPE>::clear(){ fill(COLOR_TYPE()); };
 
+template <class COLOR_TYPE>
+void PixelDataBuffer<COLOR_TYPE>::lerp(const PixelDataBuffer<COLOR_TYPE> &a, const PixelDataBuffer<COLOR_TYPE> &b, uint8_t frac){
+    if (a.fb.size() != fb.size() || b.fb.size() != fb.size()) return;
+
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        static_assert(sizeof(CRGB) == 3, "CRGB must be a packed byte triplet");
+        color::lerp8_buffer(reinterpret_cast<uint8_t*>(fb.data()), reinterpret_cast<const uint8_t*>(a.fb.data()), reinterpret_cast<const uint8_t*>(b.fb.data()), fb.size() * sizeof(CRGB), frac);
+        _dscale = scale_one;
+    }
+    if constexpr (std::is_same_v<uint16_t, COLOR_TYPE>){
+        color::lerp565_buffer(fb.data(), a.fb.data(), b.fb.data(), fb.size(), frac);
+    }
+    // todo: implement lerp for other color types
+}
+
+#ifdef LEDFB_WITH_EXECUTION
+template <class COLOR_TYPE>
+template <class ExecutionPolicy, typename>
+void PixelDataBuffer<COLOR_TYPE>::lerp(ExecutionPolicy &&policy, const PixelDataBuffer<COLOR_TYPE> &a, const PixelDataBuffer<COLOR_TYPE> &b, uint8_t frac){
+    if (fb.size() < LEDFB_PAR_THRESHOLD || a.fb.size() != fb.size() || b.fb.size() != fb.size())
+        return lerp(a, b, frac);
+
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE> || std::is_same_v<uint16_t, COLOR_TYPE>){
+        // buffer is split into a fixed number of chunks, each one is blended with the same SWAR kernel as serial lerp(),
+        // per-pixel transform is ~2.5 times slower than the kernel and needs that many cores just to break even
+        constexpr size_t chunks = 64;
+        static constexpr auto idx = []{ std::array<uint8_t, chunks> i{}; for (size_t k = 0; k != chunks; ++k) i[k] = k; return i; }();
+        const size_t step = (fb.size() + chunks - 1) / chunks;
+        std::for_each(std::forward<ExecutionPolicy>(policy), idx.cbegin(), idx.cend(), [&](uint8_t k){
+            const size_t from = std::min(k * step, fb.size());
+            const size_t len = std::min(step, fb.size() - from);
+            if constexpr (std::is_same_v<CRGB, COLOR_TYPE>)
+                color::lerp8_buffer(reinterpret_cast<uint8_t*>(fb.data() + from), reinterpret_cast<const uint8_t*>(a.fb.data() + from), reinterpret_cast<const uint8_t*>(b.fb.data() + from), len * sizeof(CRGB), frac);
+            else
+                color::lerp565_buffer(fb.data() + from, a.fb.data() + from, b.fb.data() + from, len, frac);
+        });
+        _dscale = scale_one;
+    } else
+        lerp(a, b, frac);
+}
+#endif  // LEDFB_WITH_EXECUTION
+
 template <class COLOR_TYPE>
 bool PixelDataBuffer<COLOR_TYPE>::resize(size_t s){
     fb.resize(s);
@@ -742,21 +1737,159 @@ LedFB<COLOR_TYPE>::LedFB(LedFB<COLOR_TYPE> const & rhs) : _w(rhs._w), _h(rhs._h)
 
 template <class COLOR_TYPE>
 COLOR_TYPE& LedFB<COLOR_TYPE>::at(int16_t x, int16_t y){
+    int32_t xi = x, yi = y;
+    if (_wrap != wrap_t::none){
+        if (wrapX()) xi = _wrapc(x, _w, _xmask);
+        if (wrapY()) yi = _wrapc(y, _h, _ymask);
+    }
     // since 2D to vector mapping depends on width, need to check if it's not out of bounds
-    // otherwise it could possibly be mapped into next y row
-    if (x>=_w) return buffer->stub_pixel;
-    return ( buffer->at(_xymap(_w, _h, static_cast<uint16_t>(x), static_cast<uint16_t>(y))) );
+    // otherwise it could possibly be mapped into next y row, compiled map must not be read past it's end either
+    if (xi < 0 || xi >= _w || yi < 0 || yi >= _h) return buffer->stub_pixel;
+    return ( buffer->at(_xymap(_w, _h, static_cast<uint16_t>(xi), static_cast<uint16_t>(yi))) );
 };
 
+template <class COLOR_TYPE>
+void LedFB<COLOR_TYPE>::set(int16_t x, int16_t y, COLOR_TYPE color){
+    int32_t xi = x, yi = y;
+    if (_wrap != wrap_t::none){
+        if (wrapX()) xi = _wrapc(x, _w, _xmask);
+        if (wrapY()) yi = _wrapc(y, _h, _ymask);
+    }
+    if (xi < 0 || xi >= _w || yi < 0 || yi >= _h) return;
+    buffer->set(_xymap(_w, _h, static_cast<uint16_t>(xi), static_cast<uint16_t>(yi)), color);
+}
+
 template <class COLOR_TYPE>
 bool LedFB<COLOR_TYPE>::resize(uint16_t w, uint16_t h){
     if (buffer->resize(w*h) && (buffer->size() == w*h)){
         _w=w; _h=h;
+        _updateWrapMasks();
+        // compiled map is no longer valid
+        if (_lut && (_lut->w() != w || _lut->h() != h)){
+            setRemapFunction(map_2d);
+            _topology = PolarMap::topology_row_major;
+        }
         return true;
     }
     return false;
 }
 
+template <class COLOR_TYPE>
+bool LedFB<COLOR_TYPE>::setRemapLUT(std::shared_ptr<LedMapLUT> lut){
+    if (!lut || lut->empty() || lut->w() != _w || lut->h() != _h) return false;
+    const LedMapLUT *map = lut.get();
+    _xymap = [map](unsigned w, unsigned h, unsigned x, unsigned y){ return map->transpose(w, h, x, y); };
+    _lut = lut;
+    _topology = PolarMap::topologyId(lut->key());
+    return true;
+}
+
+template <class COLOR_TYPE>
+void LedFB<COLOR_TYPE>::index(const int16_t *x, const int16_t *y, size_t n, uint32_t *idx) const {
+    // logical row-major offsets first, a tight loop over plain arrays. Unsigned compare catches negatives too
+    if (_wrap == wrap_t::none){
+        for (size_t i = 0; i != n; ++i)
+            idx[i] = (static_cast<uint16_t>(x[i]) < _w && static_cast<uint16_t>(y[i]) < _h) ? static_cast<uint32_t>(y[i]) * _w + x[i] : npos;
+    } else {
+        bool wx = wrapX(), wy = wrapY();
+        for (size_t i = 0; i != n; ++i){
+            int32_t xi = wx ? _wrapc(x[i], _w, _xmask) : x[i];
+            int32_t yi = wy ? _wrapc(y[i], _h, _ymask) : y[i];
+            idx[i] = (static_cast<uint32_t>(xi) < _w && static_cast<uint32_t>(yi) < _h) ? static_cast<uint32_t>(yi) * _w + xi : npos;
+        }
+    }
+
+    // then translate offsets to physical indexes
+    uint32_t len = buffer->size();
+    if (_lut){
+        const LedMapLUT::index_t *lut = _lut->data();
+        for (size_t i = 0; i != n; ++i)
+            if (idx[i] != npos) idx[i] = lut[idx[i]] < len ? lut[idx[i]] : npos;
+        return;
+    }
+    // mapper callback, coordinates are restored from offsets
+    for (size_t i = 0; i != n; ++i){
+        if (idx[i] == npos) continue;
+        uint32_t yi = idx[i] / _w;
+        size_t p = _xymap(_w, _h, idx[i] - yi * _w, yi);
+        idx[i] = p < len ? p : npos;
+    }
+}
+
+template <class COLOR_TYPE>
+void LedFB<COLOR_TYPE>::blit(int16_t x, int16_t y, const COLOR_TYPE *src, uint16_t w, uint16_t h){
+    if (!src) return;
+    for (uint16_t j = 0; j != h; ++j)
+        for (uint16_t i = 0; i != w; ++i)
+            at(x + i, y + j) = *src++;
+}
+
+template <class COLOR_TYPE>
+void LedFB<COLOR_TYPE>::blit(int16_t x, int16_t y, LedFB<COLOR_TYPE> &src){
+    // source is read unchecked, fold it's pending fade once
+    src.buffer->fold();
+    for (uint16_t j = 0; j != src.h(); ++j)
+        for (uint16_t i = 0; i != src.w(); ++i)
+            at(x + i, y + j) = src.at_unchecked(i, j);
+}
+
+/**
+ * @brief shift a line of pixels by 'k' positions
+ * 
+ * @param n - line length
+ * @param k - offset, positive shifts towards higher indexes
+ * @param wrap - rotate the line instead of filling vacated pixels
+ * @param color - fill color
+ * @param px - callable returning reference to i'th pixel of the line
+ */
+template <class COLOR_TYPE, typename F>
+void shift_line(int n, int k, bool wrap, COLOR_TYPE color, F &&px){
+    if (!n || !k) return;
+    if (wrap){
+        // in-place rotation by cycles, no temporary line storage
+        k %= n;
+        if (k < 0) k += n;
+        if (!k) return;
+        int a = n, b = k;
+        while (b){ int t = a % b; a = b; b = t; }
+        for (int start = 0; start != a; ++start){
+            COLOR_TYPE tmp = px(start);
+            int cur = start;
+            for (;;){
+                int prev = cur - k < 0 ? cur - k + n : cur - k;
+                if (prev == start) break;
+                px(cur) = px(prev);
+                cur = prev;
+            }
+            px(cur) = tmp;
+        }
+        return;
+    }
+    if (k >= n || -k >= n){
+        for (int i = 0; i != n; ++i) px(i) = color;
+    } else if (k > 0){
+        for (int i = n - 1; i >= k; --i) px(i) = px(i - k);
+        for (int i = 0; i != k; ++i) px(i) = color;
+    } else {
+        for (int i = 0; i < n + k; ++i) px(i) = px(i - k);
+        for (int i = n + k; i != n; ++i) px(i) = color;
+    }
+}
+
+template <class COLOR_TYPE>
+void LedFB<COLOR_TYPE>::scroll(int16_t dx, int16_t dy, COLOR_TYPE color){
+    // fill color is not pre-compensated, fold pending fade once for the unchecked loops
+    if (dx || dy) buffer->fold();
+    if (dx){
+        for (uint16_t y = 0; y != _h; ++y)
+            shift_line(_w, dx, wrapX(), color, [this, y](int i) -> COLOR_TYPE& { return at_unchecked(i, y); });
+    }
+    if (dy){
+        for (uint16_t x = 0; x != _w; ++x)
+            shift_line(_h, dy, wrapY(), color, [this, x](int i) -> COLOR_TYPE& { return at_unchecked(x, i); });
+    }
+}
+
 /**
  * @brief apply FastLED fadeToBlackBy() func to buffer
  * 
@@ -766,6 +1899,7 @@ template <class COLOR_TYPE>
 void LedFB<COLOR_TYPE>::fade(uint8_t v){
     // if buffer is of CRGB type
     if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        if (_defer_fade) return buffer->scaleDeferred(255 - v);
         for (auto i = buffer->begin(); i != buffer->end(); ++i)
             (*i).nscale8(255 - v);
     }
@@ -776,6 +1910,7 @@ template <class COLOR_TYPE>
 void LedFB<COLOR_TYPE>::dim(uint8_t v){
     // if buffer is of CRGB type
     if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        if (_defer_fade) return buffer->scaleDeferred(v);
         for (auto i = buffer->begin(); i != buffer->end(); ++i)
             (*i).nscale8(v);
     }
@@ -784,12 +1919,77 @@ void LedFB<COLOR_TYPE>::dim(uint8_t v){
 
 
 
+#ifdef LEDFB_WITH_EXECUTION
+template <class COLOR_TYPE>
+template <class ExecutionPolicy, typename>
+void LedFB<COLOR_TYPE>::dim(ExecutionPolicy &&policy, uint8_t v){
+    if (_defer_fade || _partial()) return dim(v);
+    if constexpr (std::is_same_v<CRGB, COLOR_TYPE>){
+        buffer->for_each(std::forward<ExecutionPolicy>(policy), [v](CRGB &c){ c.nscale8(v); });
+    }
+    // todo: implement fade for other color types
+}
+#endif  // LEDFB_WITH_EXECUTION
+
 //  ****************************************
 //  ************  DisplayEngine ************
 //  ****************************************
 
+template <class COLOR_TYPE>
+void DisplayEngine<COLOR_TYPE>::interpolate(bool active){
+  if (!active){
+    _interp.reset();
+    return;
+  }
+  if (_interp) return;
+  auto buff = getActiveBuffer();
+  if (!buff) return;
+  _interp = std::make_unique<InterpolatedState<COLOR_TYPE>>(buff->size());
+  // start from current display content
+  _interp->previous() = *buff;
+  _interp->current() = *buff;
+  _frame_ts = millis();
+  _frame_period = 0;
+}
+
+template <class COLOR_TYPE>
+PixelDataBuffer<COLOR_TYPE>& DisplayEngine<COLOR_TYPE>::beginFrame(){
+  if (_interp) return _interp->step();
+  // engine owns it's buffers, so reference stays valid
+  if (auto buff = getActiveBuffer()) return *buff;
+  static PixelDataBuffer<COLOR_TYPE> empty(0);
+  return empty;
+}
+
+template <class COLOR_TYPE>
+void DisplayEngine<COLOR_TYPE>::commitFrame(){
+  uint32_t now = millis();
+  // frame interval is estimated from the last one, limited to a sane range
+  _frame_period = std::min<uint32_t>(now - _frame_ts, LEDFB_INTERPOLATE_MAX_PERIOD);
+  _frame_ts = now;
+  // frames are blended as stored
+  if (_interp) _interp->current().fold();
+}
+
 template <class COLOR_TYPE>
 void DisplayEngine<COLOR_TYPE>::show(){
+  LEDFB_HOT_PATH;
+  // run simulation steps and render an interpolated frame, if clock is attached
+  if (_clock) _clock->update(millis());
+  // blend last two committed frames
+  if (_interp){
+    uint32_t elapsed = millis() - _frame_ts;
+    _ialpha = elapsed >= _frame_period ? 255 : elapsed * 255 / _frame_period;
+    if (!_blend_inline){
+      auto buff = getActiveBuffer();
+      if (buff && buff->size() == _interp->current().size())
+        _interp->render(*buff, _ialpha);
+    }
+  }
+  if (!_scale_on_output){
+    auto buff = getActiveBuffer();
+    if (buff) buff->fold();
+  }
   // call derivative engine show function
   engine_show();
 }
@@ -797,5 +1997,102 @@ void DisplayEngine<COLOR_TYPE>::show(){
 
 
 //  ****************************************
-//  ************  LedFB_GFX ************
+//  ************  LedFB_GFX_Base ************
 //  ****************************************
+
+template <class DERIVED>
+void LedFB_GFX_Base<DERIVED>::drawBitmap_alphablend(int16_t x, int16_t y,
+                    const uint8_t* bitmap, int16_t w, int16_t h,
+                    CRGB colorFront, uint8_t alphaFront,
+                    CRGB colorBack, uint8_t alphaBack)
+{
+  if (!bitmap) return;
+
+  int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
+  uint8_t byte = 0;
+
+  for (int16_t j = 0; j < h; j++, y++)
+  {
+    for (int16_t i = 0; i < w; i++)
+    {
+      if (i & 7)
+        byte <<= 1;
+      else
+        byte = bitmap[j * byteWidth + i / 8];
+
+      int16_t __x = x+i, __y = y;
+      CRGB c( (byte & 0x80) ? colorFront : colorBack );
+      uint8_t alpha((byte & 0x80) ? alphaFront : alphaBack);
+
+      if (alpha == 0)
+        continue;
+      else if (alpha == 255)
+        _self()->writePixel(__x, __y, c);
+      else {
+        _rotate(__x, __y);
+        _self()->_blendPixel(__x, __y, c, alpha);
+      }
+    }
+  }
+}
+
+template <class DERIVED>
+void LedFB_GFX_Base<DERIVED>::drawBitmap_bgfade(int16_t x, int16_t y,
+                    const uint8_t* bitmap, int16_t w, int16_t h,
+                    CRGB colorFront, uint8_t fadeBy)
+{
+  if (!bitmap) return;
+  int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
+  uint8_t byte = 0;
+
+  for (int16_t j = 0; j < h; j++, y++)
+  {
+    for (int16_t i = 0; i < w; i++)
+    {
+      if (i & 7)
+        byte <<= 1;
+      else
+        byte = bitmap[j * byteWidth + i / 8];
+
+      int16_t __x = x+i, __y = y;
+      if (byte & 0x80){
+        // write bitmap pixel with foreground color
+        _self()->writePixel(__x, __y, colorFront);
+      } else {
+        // fade background where bitmap is zero
+        _rotate(__x, __y);
+        _self()->_fadePixel(__x, __y, fadeBy);
+      }
+    }
+  }
+}
+
+template <class DERIVED>
+void LedFB_GFX_Base<DERIVED>::drawBitmap_scale_colors(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, CRGB colorFront, CRGB colorBack){
+  if (!bitmap) return;
+  int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
+  uint8_t byte = 0;
+
+  for (int16_t j = 0; j != h; j++, y++)
+  {
+    for (int16_t i = 0; i != w; i++)
+    {
+      if (i & 7)
+        byte <<= 1;
+      else
+        byte = bitmap[j * byteWidth + i / 8];
+
+      int16_t __x = x+i, __y = y;
+      CRGB c( (byte & 0x80) ? colorFront : colorBack );
+
+      if (c == CRGB::Black)
+        _self()->writePixel(__x, __y, CRGB::Black);
+      else if (c == CRGB::White)
+        continue;
+      else {
+        _rotate(__x, __y);
+        _self()->_scalePixel(__x, __y, c);
+      }
+    }
+  }
+}
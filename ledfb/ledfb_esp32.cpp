@@ -10,10 +10,13 @@
 
 ESP32RMTDisplayEngine::ESP32RMTDisplayEngine(int gpio, EOrder rgb_order){
     wsstrip = new(std::nothrow) ESP32RMT_WS2812B(gpio, rgb_order);
+    // deferred fade is applied via controller's brightness scaling
+    _scale_on_output = true;
 }
 
 ESP32RMTDisplayEngine::ESP32RMTDisplayEngine(int gpio, EOrder rgb_order, std::shared_ptr<CLedCDB> buffer) : canvas(buffer) {
   wsstrip = new(std::nothrow) ESP32RMT_WS2812B(gpio, rgb_order);
+  _scale_on_output = true;
   if (wsstrip && canvas){
       // attach buffer to RMT engine
       cled = &FastLED.addLeds(wsstrip, canvas->data().data(), canvas->size());
@@ -42,7 +45,13 @@ bool ESP32RMTDisplayEngine::attachCanvas(std::shared_ptr<CLedCDB> &fb){
 }
 
 void ESP32RMTDisplayEngine::engine_show(){
-  FastLED.show();
+  auto buff = getActiveBuffer();
+  uint32_t f = buff ? buff->deferredScale() : PixelDataBuffer<CRGB>::scale_one;
+  if (f == PixelDataBuffer<CRGB>::scale_one)
+    return FastLED.show();
+  // controller reads bound buffer as is, pending fade goes to output brightness, nscale8 style (b + 1) multiplier
+  uint32_t b = ((FastLED.getBrightness() + 1) * f + 0x8000) >> 16;
+  FastLED.show(b ? b - 1 : 0);
 }
 
 /*
@@ -120,6 +129,12 @@ uint8_t ESP32RMTDisplayEngine::brightness(uint8_t b){
     return FastLED.getBrightness();
 }
 
+void ESP32RMTDisplayEngine::setCalibration(std::shared_ptr<CalibrationMap> map){
+    _calibration = map;
+    if (wsstrip)
+      wsstrip->setCalibration(_calibration.get());
+}
+
 void ESP32RMTDisplayEngine::doubleBuffer(bool active){
   if (active && !backbuff){
     backbuff = std::make_shared<CLedCDB>(canvas->size());
@@ -136,11 +151,13 @@ void ESP32RMTDisplayEngine::doubleBuffer(bool active){
 }
 
 void ESP32RMTDisplayEngine::flipBuffer(){
+  LEDFB_HOT_PATH;
   if (backbuff)
     canvas->swap(*backbuff);
 }
 
 bool ESP32RMTDisplayEngine::toggleBuffer(){
+  LEDFB_HOT_PATH;
   if (backbuff){
     canvas->rebind(*backbuff);
     _active_buff = !_active_buff;
@@ -150,15 +167,16 @@ bool ESP32RMTDisplayEngine::toggleBuffer(){
 }
 
 void ESP32RMTDisplayEngine::copyBack2Front(){
-  if (backbuff){
-    canvas->data() = backbuff->data();
-  }
+  LEDFB_HOT_PATH;
+  // copy in-place, vector assignment might reallocate canvas storage bound to RMT controller
+  if (backbuff)
+    std::copy_n(backbuff->data().cbegin(), std::min(canvas->size(), backbuff->size()), canvas->data().begin());
 }
 
 void ESP32RMTDisplayEngine::copyFront2Back(){
-  if (backbuff){
-    backbuff->data() = canvas->data();
-  }
+  LEDFB_HOT_PATH;
+  if (backbuff)
+    std::copy_n(canvas->data().cbegin(), std::min(canvas->size(), backbuff->size()), backbuff->data().begin());
 }
 
 //#endif  //ifdef ESP32
@@ -176,6 +194,12 @@ void HUB75PanelDB::show(){
 
 ESP32HUB75_DisplayEngine::ESP32HUB75_DisplayEngine(const HUB75_I2S_CFG &config) : hub75(config){
   canvas = std::make_shared<PixelDataBuffer<CRGB>>(config.mx_height * config.mx_height);
+  // interpolated frames are blended while sending pixels to DMA buffer
+  _blend_inline = true;
+  // deferred fade is applied while sending pixels to DMA buffer
+  _scale_on_output = true;
+  // scratch row is allocated upfront, show() must not touch heap
+  _row.resize(config.mx_width);
   hub75.begin();
 }
 
@@ -186,14 +210,40 @@ void ESP32HUB75_DisplayEngine::clear(){
 }
 
 void ESP32HUB75_DisplayEngine::engine_show(){
-  if (_active_buff){
-    for (size_t i = 0; i != canvas->size(); ++i){
-      hub75.drawPixelRGB888( i % hub75.getCfg().mx_width, i / hub75.getCfg().mx_width, (*canvas)[i].r, (*canvas)[i].g, (*canvas)[i].b);
+  auto &buff = _active_buff ? canvas : backbuff;
+  uint16_t w = hub75.getCfg().mx_width;
+
+  if (_interp && _interp->current().size() == buff->size()){
+    // blend last two committed frames row by row, canvas is not written
+    const CRGB *prev = _interp->previous().data().data();
+    const CRGB *cur = _interp->current().data().data();
+    CalibrationMap::cursor cal = _calibration ? CalibrationMap::cursor(*_calibration) : CalibrationMap::cursor();
+    for (size_t i = 0; i < buff->size(); i += w){
+      size_t len = std::min<size_t>(w, buff->size() - i);
+      color::lerp8_buffer(reinterpret_cast<uint8_t*>(_row.data()), reinterpret_cast<const uint8_t*>(prev + i), reinterpret_cast<const uint8_t*>(cur + i), len * sizeof(CRGB), _ialpha);
+      for (size_t x = 0; x != len; ++x){
+        CRGB c(_row[x]);
+        if (_calibration) c.nscale8(cal.next());
+        hub75.drawPixelRGB888( x, i / w, c.r, c.g, c.b);
+      }
     }
-  } else {
-    for (size_t i = 0; i != backbuff->size(); ++i){
-      hub75.drawPixelRGB888( i % hub75.getCfg().mx_width, i / hub75.getCfg().mx_width, (*backbuff)[i].r, (*backbuff)[i].g, (*backbuff)[i].b);
+    return;
+  }
+
+  if (_calibration){
+    // apply calibration gain while sending pixels to DMA buffer, canvas is kept intact
+    CalibrationMap::cursor cal(*_calibration);
+    for (size_t i = 0; i != buff->size(); ++i){
+      CRGB c(buff->output(i));
+      c.nscale8(cal.next());
+      hub75.drawPixelRGB888( i % w, i / w, c.r, c.g, c.b);
     }
+    return;
+  }
+
+  for (size_t i = 0; i != buff->size(); ++i){
+    CRGB c(buff->output(i));
+    hub75.drawPixelRGB888( i % w, i / w, c.r, c.g, c.b);
   }
 
 //  for (auto &s : _stack)
@@ -240,11 +290,13 @@ void ESP32HUB75_DisplayEngine::doubleBuffer(bool active){
 }
 
 void ESP32HUB75_DisplayEngine::flipBuffer(){
+  LEDFB_HOT_PATH;
   if (backbuff)
     canvas->swap(*backbuff);
 }
 
 bool ESP32HUB75_DisplayEngine::toggleBuffer(){
+  LEDFB_HOT_PATH;
   if (backbuff)
     _active_buff = !_active_buff;
 
@@ -252,15 +304,15 @@ bool ESP32HUB75_DisplayEngine::toggleBuffer(){
 }
 
 void ESP32HUB75_DisplayEngine::copyBack2Front(){
-  if (backbuff){
-    *canvas = *backbuff;
-  }
+  LEDFB_HOT_PATH;
+  if (backbuff)
+    std::copy_n(backbuff->data().cbegin(), std::min(canvas->size(), backbuff->size()), canvas->data().begin());
 }
 
 void ESP32HUB75_DisplayEngine::copyFront2Back(){
-  if (backbuff){
-    *backbuff = *canvas;
-  }
+  LEDFB_HOT_PATH;
+  if (backbuff)
+    std::copy_n(canvas->data().cbegin(), std::min(canvas->size(), backbuff->size()), backbuff->data().begin());
 }
 
 #endif // LEDFB_WITH_HUB75_I2S
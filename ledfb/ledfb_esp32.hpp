@@ -95,6 +95,44 @@ public:
      */
     uint8_t brightness(uint8_t b) override;
 
+    /**
+     * @brief set per-pixel calibration map
+     * map is handed over to RMT controller and applied on pixel loading
+     * 
+     * @param map - calibration map, an empty pointer disables calibration
+     */
+    void setCalibration(std::shared_ptr<CalibrationMap> map) override;
+
+    /**
+     * @brief add a LED segment with it's own color correction and brightness
+     * could be used to chain strips from different vendors on one gpio
+     * 
+     * @param start - index of the first LED in a segment
+     * @param len - number of LEDs in a segment
+     * @param correction - color correction
+     * @param brightness - brightness scale applied on top of the global brightness
+     * @return true on success
+     * @return false if segment overlaps with existing one
+     */
+    bool addSegment(uint32_t start, uint32_t len, CRGB correction, uint8_t brightness = 255){ return wsstrip ? wsstrip->addSegment(start, len, correction, brightness) : false; }
+
+    /**
+     * @brief set RGBW mode for RGBW strips, like SK6812
+     * white channel is extracted on pixel loading, canvas stays RGB
+     * 
+     * @param mode - white channel extraction mode
+     * @param wp - white LED tint in RGB terms, used in whitepoint mode
+     * @return true on success
+     * @return false if mode is not supported with current FastLED version (whitepoint needs FastLED <= 3.7.3)
+     */
+    bool setRGBW(color::rgbw_mode_t mode, CRGB wp = CRGB(255, 255, 255)){ return wsstrip ? wsstrip->setRGBW(mode, wp) : false; }
+
+    /**
+     * @brief remove all LED segments
+     * 
+     */
+    void clearSegments(){ if (wsstrip) wsstrip->clearSegments(); }
+
     /**
      * @brief activate double buffer
      * 
@@ -204,6 +242,7 @@ class ESP32HUB75_DisplayEngine : public DisplayEngine<CRGB> {
     bool _active_buff{true};
     std::shared_ptr<PixelDataBuffer<CRGB>>  canvas;      // canvas buffer where background data is stored
     std::shared_ptr<PixelDataBuffer<CRGB>>  backbuff;    // back buffer weak pointer
+    std::vector<CRGB> _row;                              // scratch row for inline frame interpolation
 
     /**
      * @brief show buffer content on display
@@ -0,0 +1,91 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include <string.h>
+#include "ledmap.hpp"
+
+uint32_t LedMapLUT::makeKey(const LedStripe &layout, uint16_t w, uint16_t h){
+    // mix layout signature with dimensions and index type
+    uint32_t key = layout.signature() ^ (static_cast<uint32_t>(w) << 16 | h);
+    key ^= key >> 15;
+    key *= 0x2c1b3c6dUL;
+    key ^= key >> 12;
+    return key ^ sizeof(index_t);
+}
+
+bool LedMapLUT::build(const LedStripe &layout, uint16_t w, uint16_t h){
+    clear();
+    size_t len = static_cast<size_t>(w) * h;
+    if (!len || len > max_pixels) return false;
+
+    _storage.resize(len);
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x){
+            size_t i = layout.transpose(w, h, x, y);
+            if (i > UINT16_MAX){
+                clear();
+                return false;
+            }
+            _storage[y * w + x] = i;
+        }
+
+    _w = w; _h = h;
+    _key = makeKey(layout, w, h);
+    _idx = _storage.data();
+    return true;
+}
+
+bool LedMapLUT::attach(const void *blob, size_t len, uint32_t key){
+    clear();
+    if (!blob || len < sizeof(header_t)) return false;
+
+    header_t hdr;
+    memcpy(&hdr, blob, sizeof(header_t));
+    if (hdr.magic != magic || hdr.version != version || hdr.index_size != sizeof(index_t) || hdr.key != key) return false;
+
+    size_t cnt = static_cast<size_t>(hdr.w) * hdr.h;
+    if (!cnt || cnt > max_pixels || len < sizeof(header_t) + cnt * sizeof(index_t)) return false;
+
+    const uint8_t *data = static_cast<const uint8_t*>(blob) + sizeof(header_t);
+    if (reinterpret_cast<uintptr_t>(data) % alignof(index_t)){
+        // misaligned blob, can't reference it directly
+        _storage.resize(cnt);
+        memcpy(_storage.data(), data, cnt * sizeof(index_t));
+        _idx = _storage.data();
+    } else
+        _idx = reinterpret_cast<const index_t*>(data);
+
+    _w = hdr.w; _h = hdr.h;
+    _key = key;
+    return true;
+}
+
+bool LedMapLUT::load(const void *blob, size_t len, const LedStripe &layout, uint16_t w, uint16_t h){
+    if (attach(blob, len, makeKey(layout, w, h)) && _w == w && _h == h)
+        return true;
+
+    build(layout, w, h);
+    return false;
+}
+
+size_t LedMapLUT::serialize(void *dst, size_t len) const {
+    size_t bsize = blobSize();
+    if (!bsize || !dst || len < bsize) return 0;
+
+    header_t hdr{magic, version, sizeof(index_t), _key, _w, _h};
+    memcpy(dst, &hdr, sizeof(header_t));
+    memcpy(static_cast<uint8_t*>(dst) + sizeof(header_t), _idx, bsize - sizeof(header_t));
+    return bsize;
+}
+
+void LedMapLUT::clear(){
+    _idx = nullptr;
+    _storage.clear();
+    _storage.shrink_to_fit();
+    _w = _h = 0;
+    _key = 0;
+}
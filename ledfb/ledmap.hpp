@@ -0,0 +1,137 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <vector>
+#include "ledstripe.hpp"
+
+/**
+ * @brief Compiled topology map
+ * a lookup table that keeps precomputed buffer index for each (x,y) pixel of a canvas,
+ * it replaces per-pixel transpose() calculations with a single table read.
+ * Table could be serialized into a blob and later attached back with zero-copy,
+ * i.e. from a memory-mapped flash partition or a file image loaded to RAM.
+ * Blob is versioned and keyed with layout parameters, on key mismatch table is recomputed from layout
+ * NOTE: index_t is 16 bit, so a table covers at most max_pixels (65536) pixels,
+ * build() fails for larger canvases and attach() rejects such blobs
+ */
+class LedMapLUT {
+public:
+    // buffer index type
+    using index_t = uint16_t;
+
+    // max number of pixels a table could map, buffer indexes must fit index_t
+    static constexpr size_t max_pixels = static_cast<size_t>(UINT16_MAX) + 1;
+
+    // blob format version
+    static constexpr uint16_t version = 1;
+    // blob magic, 'LMAP'
+    static constexpr uint32_t magic = 0x50414d4c;
+
+    // blob header, followed by w*h index_t values in row-major order
+    struct header_t {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t index_size;        // sizeof(index_t)
+        uint32_t key;               // layout key
+        uint16_t w, h;              // canvas dimensions
+    };
+
+    LedMapLUT() = default;
+    LedMapLUT(LedMapLUT const &) = delete;
+    LedMapLUT& operator=(LedMapLUT const &) = delete;
+    LedMapLUT(LedMapLUT &&) = default;
+    LedMapLUT& operator=(LedMapLUT &&) = default;
+
+    /**
+     * @brief make a key identifying a compiled map for specific layout and canvas dimensions
+     *
+     * @param layout - canvas layout
+     * @param w - canvas width
+     * @param h - canvas height
+     * @return uint32_t
+     */
+    static uint32_t makeKey(const LedStripe &layout, uint16_t w, uint16_t h);
+
+    /**
+     * @brief compile map for the specified layout
+     *
+     * @param layout - canvas layout
+     * @param w - canvas width
+     * @param h - canvas height
+     * @return true on success
+     * @return false if canvas is empty or has more than max_pixels pixels, or layout maps a pixel past index_t range
+     */
+    bool build(const LedStripe &layout, uint16_t w, uint16_t h);
+
+    /**
+     * @brief attach to a serialized map blob
+     * if blob is properly aligned, table data is NOT copied, i.e. blob must outlive this object
+     *
+     * @param blob - pointer to serialized map
+     * @param len - blob length
+     * @param key - expected layout key
+     * @return true if blob is valid and matches the key
+     * @return false otherwise, map is left empty
+     */
+    bool attach(const void *blob, size_t len, uint32_t key);
+
+    /**
+     * @brief attach to a serialized map blob, or recompute it if blob does not match layout
+     *
+     * @param blob - pointer to serialized map, could be nullptr
+     * @param len - blob length
+     * @param layout - canvas layout
+     * @param w - canvas width
+     * @param h - canvas height
+     * @return true if map was attached from blob
+     * @return false if map was recomputed (or failed to), caller might want to serialize it again
+     */
+    bool load(const void *blob, size_t len, const LedStripe &layout, uint16_t w, uint16_t h);
+
+    /**
+     * @brief size of a serialized blob in bytes
+     */
+    size_t blobSize() const { return _idx ? sizeof(header_t) + _w * _h * sizeof(index_t) : 0; }
+
+    /**
+     * @brief serialize map into a blob
+     *
+     * @param dst - destination buffer
+     * @param len - destination buffer size
+     * @return size_t - number of bytes written, 0 if map is empty or buffer is too small
+     */
+    size_t serialize(void *dst, size_t len) const;
+
+    // drop map data
+    void clear();
+
+    // returns true if map has no data
+    bool empty() const { return !_idx; }
+
+    // layout key map was compiled for
+    uint32_t key() const { return _key; }
+
+    uint16_t w() const { return _w; }
+    uint16_t h() const { return _h; }
+
+    // raw access to index table in row-major order
+    const index_t* data() const { return _idx; }
+
+    /**
+     * @brief transpose x,y coordinates into buffer index
+     * a drop-in replacement for LedStripe::transpose(), no bounds checking is performed
+     */
+    size_t transpose(unsigned w, unsigned h, unsigned x, unsigned y) const { return _idx[y * _w + x]; }
+
+private:
+    uint16_t _w{0}, _h{0};
+    uint32_t _key{0};
+    // pointer to index table, either own storage or an attached blob
+    const index_t *_idx{nullptr};
+    std::vector<index_t> _storage;
+};
@@ -7,6 +7,15 @@
 
 #include "ledstripe.hpp"
 
+// FNV-1a hash step over a 32 bit value
+static uint32_t fnv1a(uint32_t hash, uint32_t v){
+    for (int i = 0; i != 4; ++i){
+        hash ^= (v >> (8*i)) & 0xff;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 
 // *** Topology mapping classes implementation ***
 
@@ -26,6 +35,26 @@ size_t LedStripe::transpose(unsigned w, unsigned h, unsigned x, unsigned y) cons
     }
 }
 
+void LedStripe::inverse(unsigned w, unsigned h, size_t idx, unsigned &x, unsigned &y) const {
+    if ( _vertical ){
+        unsigned xx = idx / h, yy = idx % h;
+        // for snake-shaped strip odd physical columns are inverted
+        bool virtual_v_mirror = (_snake && xx%2) ? !_vmirror : _vmirror;
+        x = _hmirror ? w - xx-1 : xx;
+        y = virtual_v_mirror ? h - yy-1 : yy;
+    } else {
+        unsigned xx = idx % w, yy = idx / w;
+        // for snake-shaped displays odd physical rows are inverted
+        bool virtual_h_mirror = (_snake && yy%2) ? !_hmirror : _hmirror;
+        x = virtual_h_mirror ? w - xx-1 : xx;
+        y = _vmirror ? h - yy-1 : yy;
+    }
+}
+
+uint32_t LedStripe::signature() const {
+    return fnv1a(2166136261UL, _snake | _vertical << 1 | _vmirror << 2 | _hmirror << 3);
+}
+
 size_t LedTiles::transpose(unsigned w, unsigned h, unsigned x, unsigned y) const {
     if (_tile_wcnt == 1 && _tile_hcnt == 1)
         return LedStripe::transpose(w,h,x,y);
@@ -47,3 +76,28 @@ size_t LedTiles::tiled_transpose(unsigned w, unsigned h, unsigned x, unsigned y)
     //Serial.printf("tiledXY:%d,%d, tnum:%d, pxit:%d, idx:%d\n", tile_x, tile_y, tile_num, px_in_tile, i);
     return i;
 }
+
+void LedTiles::inverse(unsigned w, unsigned h, size_t idx, unsigned &x, unsigned &y) const {
+    if (_tile_wcnt == 1 && _tile_hcnt == 1)
+        return LedStripe::inverse(w,h,idx,x,y);
+
+    size_t tile_size = _tile_w*_tile_h;
+    // find tile's coordinates by it's number in a chain
+    unsigned tile_x, tile_y;
+    tileLayout.inverse(_tile_wcnt, _tile_hcnt, idx / tile_size, tile_x, tile_y);
+
+    // find pixel's coordinates within a tile
+    unsigned px_x, px_y;
+    LedStripe::inverse(_tile_w, _tile_h, idx % tile_size, px_x, px_y);
+
+    x = tile_x * _tile_w + px_x;
+    y = tile_y * _tile_h + px_y;
+}
+
+uint32_t LedTiles::signature() const {
+    uint32_t hash = fnv1a(LedStripe::signature(), tileLayout.signature());
+    hash = fnv1a(hash, _tile_w);
+    hash = fnv1a(hash, _tile_h);
+    hash = fnv1a(hash, _tile_wcnt);
+    return fnv1a(hash, _tile_hcnt);
+}
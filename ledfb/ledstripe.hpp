@@ -62,6 +62,24 @@ public:
      * @return size_t 
      */
     virtual size_t transpose(unsigned w, unsigned h, unsigned x, unsigned y) const;
+
+    /**
+     * @brief inverse transformation, find pixel 2D coordinates (x,y) for framebuffer's 1D array index
+     * no checking performed for supplied index to be out of bound of pixel buffer!
+     * @param w - canvas width
+     * @param h - canvas height
+     * @param idx - pixel's index in a 1D vector
+     * @param x - pixel's x
+     * @param y - pixel's y
+     */
+    virtual void inverse(unsigned w, unsigned h, size_t idx, unsigned &x, unsigned &y) const;
+
+    /**
+     * @brief layout signature
+     * a hash of layout parameters, could be used to identify a compiled map for this layout
+     * @return uint32_t 
+     */
+    virtual uint32_t signature() const;
 };
 
 /**
@@ -128,5 +146,24 @@ public:
      * @return size_t - pixel's index in a 1D vector
      */
     virtual size_t transpose(unsigned w, unsigned h, unsigned x, unsigned y) const override;
+
+    /**
+     * @brief find x,y coordinates of a pixel in a rectangular canvas
+     * from it's index in a 1D vector of chained tiles
+     * 
+     * @param w - full canvas width
+     * @param h - full canvas height
+     * @param idx - pixel's index in a 1D vector
+     * @param x - pixel's x
+     * @param y - pixel's y
+     */
+    virtual void inverse(unsigned w, unsigned h, size_t idx, unsigned &x, unsigned &y) const override;
+
+    /**
+     * @brief layout signature
+     * includes tile dimensions and tiles chaining layout
+     * @return uint32_t 
+     */
+    virtual uint32_t signature() const override;
 };
 
@@ -0,0 +1,202 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "ledfb.hpp"
+
+/**
+ * @brief Batch of sparse pixel writes
+ * star fields, rain, sparkles and alike write a few hundred scattered pixels per frame,
+ * instead of calling at(x,y) for each one an effect collects writes into a batch and applies it in one go.
+ * Coordinates are mapped in bulk via LedFB::index(), writes could be sorted by physical index for memory locality,
+ * writes to the same pixel are always applied in the order they were added.
+ * Batch keeps it's storage between frames, so reusing it does not allocate once capacity is reached.
+ * NOTE: collecting and mapping writes has it's own cost, with a canvas that fits CPU cache a batch is slower than plain at() calls
+ * (see test_pixelbatch benchmark). Sorting pays off for canvases in slow memory, i.e. PSRAM, where scattered access misses the cache
+ *
+ *  PixelBatch<CRGB> stars(200);
+ *  stars.add(x, y, CRGB::White, PixelBatch<CRGB>::op_t::add);
+ *  ...
+ *  stars.apply(canvas, true);
+ *  stars.clear();
+ *
+ * @tparam COLOR_TYPE
+ */
+template <class COLOR_TYPE = CRGB>
+class PixelBatch {
+public:
+    // pixel write operation
+    enum class op_t : uint8_t {
+        set = 0,        // replace pixel
+        add,            // saturating add
+        blend,          // blend with pixel using alpha
+        max             // per channel maximum
+    };
+
+    /**
+     * @brief Construct a new Pixel Batch object
+     *
+     * @param reserve - number of writes to reserve storage for
+     */
+    explicit PixelBatch(size_t reserve = 256){
+        _x.resize(reserve); _y.resize(reserve); _px.resize(reserve);
+        _idx.reserve(reserve); _keys.reserve(reserve);
+    }
+
+    /**
+     * @brief add a pixel write to the batch
+     *
+     * @param x - x coordinate
+     * @param y - y coordinate
+     * @param color - pixel color
+     * @param op - write operation
+     * @param alpha - blend amount for op_t::blend
+     */
+    void add(int16_t x, int16_t y, COLOR_TYPE color, op_t op = op_t::set, uint8_t alpha = 255){
+        if (_n == _x.size()){
+            // arrays are kept sized to capacity, plain stores are cheaper than push_back()
+            size_t len = _n ? _n * 2 : 16;
+            _x.resize(len); _y.resize(len); _px.resize(len);
+        }
+        if (!_n) _uniform = true;
+        else if (_uniform && (op != _px.front().op || alpha != _px.front().alpha)) _uniform = false;
+        _x[_n] = x; _y[_n] = y; _px[_n] = {color, op, alpha};
+        ++_n;
+    }
+
+    // number of queued writes
+    size_t size() const { return _n; }
+
+    // drop queued writes, storage is kept
+    void clear(){ _n = 0; }
+
+    /**
+     * @brief apply queued writes to canvas
+     * batch content is kept, call clear() to start a new one
+     *
+     * @param fb - canvas to write to
+     * @param sort - sort writes by physical buffer index
+     */
+    void apply(LedFB<COLOR_TYPE> &fb, bool sort = false);
+
+private:
+    struct write_t {
+        COLOR_TYPE color;
+        op_t op;
+        uint8_t alpha;
+    };
+
+    // coordinates are kept in separate arrays to be mapped in bulk
+    std::vector<int16_t> _x, _y;
+    std::vector<write_t> _px;
+    // number of queued writes
+    size_t _n{0};
+    // scratch - mapped indexes and sort keys
+    std::vector<uint32_t> _idx;
+    std::vector<uint64_t> _keys;
+    // all writes share the same op and alpha
+    bool _uniform{true};
+
+    // run writes through a pixel operation, i'th write goes to pixel 'index(i)'
+    template <typename OP, typename IDX>
+    void _run(COLOR_TYPE *data, size_t n, OP &&op, IDX &&index);
+
+    static void _write(CRGB &px, CRGB c, op_t op, uint8_t alpha);
+    static void _write(uint16_t &px, uint16_t c, op_t op, uint8_t alpha);
+};
+
+
+//  *** TEMPLATES IMPLEMENTATION FOLLOWS *** //
+
+template <class COLOR_TYPE>
+void PixelBatch<COLOR_TYPE>::_write(CRGB &px, CRGB c, op_t op, uint8_t alpha){
+    switch (op){
+    case op_t::add :
+        px += c;
+        break;
+    case op_t::blend :
+        nblend(px, c, alpha);
+        break;
+    case op_t::max :
+        px.r = std::max(px.r, c.r); px.g = std::max(px.g, c.g); px.b = std::max(px.b, c.b);
+        break;
+    default :
+        px = c;
+    }
+}
+
+template <class COLOR_TYPE>
+void PixelBatch<COLOR_TYPE>::_write(uint16_t &px, uint16_t c, op_t op, uint8_t alpha){
+    switch (op){
+    case op_t::set :
+        px = c;
+        break;
+    case op_t::blend :
+        px = color::alphaBlendRGB565(c, px, alpha);
+        break;
+    default : {
+        CRGB p(LedFB_GFX::colorCRGB(px));
+        _write(p, LedFB_GFX::colorCRGB(c), op, alpha);
+        px = LedFB_GFX::color565(p);
+    }
+    }
+}
+
+template <class COLOR_TYPE>
+template <typename OP, typename IDX>
+void PixelBatch<COLOR_TYPE>::_run(COLOR_TYPE *data, size_t n, OP &&op, IDX &&index){
+    for (size_t i = 0; i != n; ++i){
+        uint32_t px, w;
+        if (index(i, px, w)) op(data[px], w);
+    }
+}
+
+template <class COLOR_TYPE>
+void PixelBatch<COLOR_TYPE>::apply(LedFB<COLOR_TYPE> &fb, bool sort){
+    size_t n = _n;
+    if (!n) return;
+    _idx.resize(n);
+    fb.index(_x.data(), _y.data(), n, _idx.data());
+    COLOR_TYPE *data = fb.span().data();
+
+    // i'th write in addition order, or in physical index order via sort keys
+    auto direct = [this](size_t i, uint32_t &px, uint32_t &w){ px = _idx[i]; w = i; return px != LedFB<COLOR_TYPE>::npos; };
+    auto sorted = [this](size_t i, uint32_t &px, uint32_t &w){ px = _keys[i] >> 32; w = _keys[i] & UINT32_MAX; return true; };
+
+    if (sort){
+        // buffer index in the upper half and sequence number in the lower half keeps order of writes to the same pixel
+        _keys.clear();
+        for (size_t i = 0; i != n; ++i)
+            if (_idx[i] != LedFB<COLOR_TYPE>::npos) _keys.push_back(static_cast<uint64_t>(_idx[i]) << 32 | i);
+        std::sort(_keys.begin(), _keys.end());
+    }
+    size_t cnt = sort ? _keys.size() : n;
+
+    // a batch of same-op writes (the usual case) runs without per pixel dispatch
+    if constexpr (std::is_same_v<COLOR_TYPE, CRGB>){
+        if (_uniform){
+            const write_t *c = _px.data();
+            switch (c->op){
+            case op_t::set : {
+                auto op = [c](CRGB &p, uint32_t w){ p = c[w].color; };
+                return sort ? _run(data, cnt, op, sorted) : _run(data, cnt, op, direct);
+            }
+            case op_t::add : {
+                auto op = [c](CRGB &p, uint32_t w){ p += c[w].color; };
+                return sort ? _run(data, cnt, op, sorted) : _run(data, cnt, op, direct);
+            }
+            default :
+                break;
+            }
+        }
+    }
+
+    auto op = [this](COLOR_TYPE &p, uint32_t w){ _write(p, _px[w].color, _px[w].op, _px[w].alpha); };
+    sort ? _run(data, cnt, op, sorted) : _run(data, cnt, op, direct);
+}
@@ -0,0 +1,81 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include <math.h>
+#include "polarmap.hpp"
+
+namespace {
+    // geometry a shared map was built for
+    struct polar_key_t {
+        uint16_t w, h;
+        int32_t cx, cy;         // centre, 8.8 fixed point
+        uint64_t topology;      // id of (x,y) to index mapping
+
+        bool operator==(const polar_key_t &rhs) const { return w == rhs.w && h == rhs.h && cx == rhs.cx && cy == rhs.cy && topology == rhs.topology; }
+    };
+
+    struct polar_cache_t {
+        polar_key_t key;
+        std::weak_ptr<const PolarMap> map;
+    };
+
+    std::vector<polar_cache_t> polar_cache;
+
+    // custom mapping ids start above compiled map ids
+    uint64_t topology_seq = 1ULL << 33;
+}
+
+uint64_t PolarMap::topologyId(){ return topology_seq++; }
+
+std::shared_ptr<const PolarMap> PolarMap::get(uint16_t w, uint16_t h, uint64_t topology, PolarMap::index_fn_t index, float cx, float cy){
+    polar_key_t key{w, h, static_cast<int32_t>(lroundf(cx * 256)), static_cast<int32_t>(lroundf(cy * 256)), topology};
+
+    // drop expired entries while looking for a match
+    std::shared_ptr<const PolarMap> map;
+    for (auto i = polar_cache.begin(); i != polar_cache.end(); ){
+        if (i->map.expired()){ i = polar_cache.erase(i); continue; }
+        if (!map && i->key == key) map = i->map.lock();
+        ++i;
+    }
+    if (map) return map;
+
+    auto m = std::make_shared<PolarMap>();
+    m->build(w, h, index, cx, cy);
+    polar_cache.push_back({key, m});
+    return m;
+}
+
+bool PolarMap::build(uint16_t w, uint16_t h, PolarMap::index_fn_t index, float cx, float cy){
+    _angle.clear();
+    _radius.clear();
+    _max_radius = 0;
+    if (!w || !h || !index) return false;
+
+    // physical buffer could be larger than canvas, i.e. tiles with gaps
+    size_t len = 0;
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x){
+            size_t i = index(x, y);
+            if (i >= len) len = i + 1;
+        }
+    _angle.assign(len, 0);
+    // buffer slots that do not belong to canvas are marked and skipped on fill
+    _radius.assign(len, unmapped);
+
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x){
+            float dx = x - cx, dy = y - cy;
+            size_t i = index(x, y);
+            float a = atan2f(dy, dx);
+            if (a < 0) a += 2 * static_cast<float>(M_PI);
+            _angle[i] = static_cast<uint16_t>(static_cast<uint32_t>(a * (65536 / (2 * static_cast<float>(M_PI)))) & 0xffff);
+            float r = sqrtf(dx * dx + dy * dy) * 256;
+            _radius[i] = r >= unmapped - 1 ? unmapped - 1 : static_cast<uint16_t>(r + 0.5f);
+            if (_radius[i] > _max_radius) _max_radius = _radius[i];
+        }
+    return true;
+}
@@ -0,0 +1,126 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <memory>
+#include <functional>
+
+/**
+ * @brief Polar coordinates map for radial effects
+ * keeps precomputed angle and radius of each canvas pixel relative to a centre point, in physical buffer order,
+ * so tunnels, spirals, rings, etc... do not need per-pixel atan2()/sqrt() on every frame.
+ * Angle is 16 bit, full circle is 65536, 0 points to +X and grows towards +Y (clockwise on screen).
+ * Radius is 8.8 fixed point in pixels.
+ * Maps are shared - get() returns an existing map for same geometry if any effect still holds it.
+ * Map must be rebuilt on canvas resize or topology change
+ */
+class PolarMap {
+public:
+    // logical (x,y) to buffer index mapper
+    using index_fn_t = std::function<size_t(unsigned x, unsigned y)>;
+
+    // radius value for buffer slots that are not mapped to canvas pixels
+    static constexpr uint16_t unmapped = UINT16_MAX;
+
+    // topology id of plain row-major mapping
+    static constexpr uint64_t topology_row_major = 0;
+
+    PolarMap() = default;
+
+    /**
+     * @brief get a shared map for the specified geometry
+     * map is built on first request and is kept while any of the users holds a pointer to it.
+     * Cached maps are looked up by dimensions, centre and topology id, index mapper is called only to build a new map
+     * NOTE: cache is not thread-safe
+     *
+     * @param w - canvas width
+     * @param h - canvas height
+     * @param topology - id of (x,y) to index mapping, topology_row_major or a value from topologyId()
+     * @param index - (x,y) to physical buffer index mapper, i.e. LedFB::index()
+     * @param cx - centre x coordinate
+     * @param cy - centre y coordinate
+     * @return std::shared_ptr<const PolarMap>
+     */
+    static std::shared_ptr<const PolarMap> get(uint16_t w, uint16_t h, uint64_t topology, index_fn_t index, float cx, float cy);
+
+    /**
+     * @brief allocate topology id for a custom mapping
+     * ids are unique for process lifetime, so maps are never shared between different mapper objects
+     */
+    static uint64_t topologyId();
+
+    /**
+     * @brief topology id of a compiled map
+     * canvases using compiled maps with same key share polar maps
+     * @param lut_key - LedMapLUT::key()
+     */
+    static constexpr uint64_t topologyId(uint32_t lut_key){ return static_cast<uint64_t>(lut_key) | 1ULL << 32; }
+
+    /**
+     * @brief build polar map
+     *
+     * @param w - canvas width
+     * @param h - canvas height
+     * @param index - (x,y) to physical buffer index mapper
+     * @param cx - centre x coordinate, could be fractional, i.e. (w-1)/2 for the middle of the canvas
+     * @param cy - centre y coordinate
+     * @return true on success
+     */
+    bool build(uint16_t w, uint16_t h, index_fn_t index, float cx, float cy);
+
+    // number of entries in tables, i.e. buffer length
+    size_t size() const { return _angle.size(); }
+
+    // pixel angle, 16 bit
+    uint16_t angle16(size_t idx) const { return _angle[idx]; }
+
+    // pixel angle, 8 bit
+    uint8_t angle8(size_t idx) const { return _angle[idx] >> 8; }
+
+    // pixel distance from centre, 8.8 fixed point
+    uint16_t radius16(size_t idx) const { return _radius[idx]; }
+
+    // pixel distance from centre, whole pixels
+    uint8_t radius(size_t idx) const { return _radius[idx] >> 8; }
+
+    // largest radius in the map, 8.8 fixed point
+    uint16_t maxRadius() const { return _max_radius; }
+
+    // raw tables in physical buffer order
+    const std::vector<uint16_t>& angles() const { return _angle; }
+    const std::vector<uint16_t>& radii() const { return _radius; }
+
+    /**
+     * @brief render pixels from polar coordinates in one pass
+     * buffer slots that are not mapped to canvas pixels are left intact
+     *
+     * @param data - pixel buffer
+     * @param len - buffer length in pixels
+     * @param f - callable COLOR_TYPE f(uint16_t angle16, uint16_t radius16)
+     */
+    template <class COLOR_TYPE, typename F>
+    void fill(COLOR_TYPE *data, size_t len, F &&f) const;
+
+private:
+    std::vector<uint16_t> _angle;
+    std::vector<uint16_t> _radius;
+    uint16_t _max_radius{0};
+};
+
+
+//  *** TEMPLATES IMPLEMENTATION FOLLOWS *** //
+
+template <class COLOR_TYPE, typename F>
+void PolarMap::fill(COLOR_TYPE *data, size_t len, F &&f) const {
+    if (len > _angle.size()) len = _angle.size();
+    const uint16_t *a = _angle.data(), *r = _radius.data();
+    for (size_t i = 0; i != len; ++i)
+        if (r[i] != unmapped) data[i] = f(a[i], r[i]);
+}
@@ -0,0 +1,57 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include "scanline.hpp"
+
+ScanlineDisplayEngine::ScanlineDisplayEngine(uint16_t w, uint16_t h, std::shared_ptr<ScanlineSink> sink, std::shared_ptr<LedStripe> layout, size_t chunk_len, uint8_t depth) :
+    _w(w), _h(h), _chunk_len(chunk_len ? chunk_len : w), _depth(depth ? depth : 1), _sink(sink), _layout(layout) {
+    // all memory is allocated upfront
+    _ring.resize(_chunk_len * _depth);
+    _x.resize(_chunk_len);
+    _y.resize(_chunk_len);
+}
+
+void ScanlineDisplayEngine::engine_show(){
+    if (!_sink || !_render || !_chunk_len) return;
+
+    size_t total = static_cast<size_t>(_w) * _h;
+    CalibrationMap::cursor cal = _calibration ? CalibrationMap::cursor(*_calibration) : CalibrationMap::cursor();
+    uint8_t slot = 0;
+
+    _sink->begin(total);
+    for (size_t start = 0; start < total; start += _chunk_len){
+        size_t len = std::min(_chunk_len, total - start);
+
+        // resolve logical coordinates for chunk pixels
+        for (size_t i = 0; i != len; ++i){
+            unsigned x, y;
+            if (_layout)
+                _layout->inverse(_w, _h, start + i, x, y);
+            else {
+                x = (start + i) % _w;
+                y = (start + i) / _w;
+            }
+            _x[i] = x;
+            _y[i] = y;
+        }
+
+        scanline_chunk_t chunk{&_ring[slot * _chunk_len], _x.data(), _y.data(), start, len};
+        _render(chunk);
+
+        // apply calibration and brightness, same as other engines do on output
+        if (_calibration || _brightness != 255){
+            for (size_t i = 0; i != len; ++i){
+                if (_calibration) chunk.px[i].nscale8(cal.next());
+                if (_brightness != 255) chunk.px[i].nscale8_video(_brightness);
+            }
+        }
+
+        _sink->write(chunk.px, len);
+        if (++slot == _depth) slot = 0;
+    }
+    _sink->end();
+}
@@ -0,0 +1,147 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include "ledfb.hpp"
+
+/**
+ * @brief a chunk of pixels to be rendered by scanline render callback
+ * pixels are in physical (LED chain) order, logical coordinates are provided for each pixel
+ */
+struct scanline_chunk_t {
+    CRGB *px;               // pixel data to fill in
+    const uint16_t *x;      // logical x coordinate for each pixel
+    const uint16_t *y;      // logical y coordinate for each pixel
+    size_t start;           // physical index of the first pixel in chunk
+    size_t len;             // number of pixels in chunk
+};
+
+/**
+ * @brief output sink for scanline rendering
+ * receives rendered chunks in physical order, i.e. to encode and transmit them to LEDs.
+ * Library provides only a host-side NullScanlineSink, hardware sinks (RMT, I2S, SPI) are up to the application
+ */
+class ScanlineSink {
+public:
+    virtual ~ScanlineSink() = default;
+
+    /**
+     * @brief start a new frame
+     * @param len - total number of pixels in frame
+     */
+    virtual void begin(size_t /* len */){};
+
+    /**
+     * @brief send a chunk of pixels
+     * data pointer is valid until the ring of chunks wraps, i.e. for 'depth - 1' subsequent writes,
+     * so an asynchronous sink could transmit a chunk while the next one is rendered
+     * @param data - pixel data
+     * @param len - number of pixels
+     */
+    virtual void write(const CRGB *data, size_t len) = 0;
+
+    /**
+     * @brief finish frame, sink should wait here for pending transmissions to complete
+     */
+    virtual void end(){};
+};
+
+/**
+ * @brief a sink that discards pixel data
+ * counts frames and pixels and keeps a checksum of the last frame, could be used to test or benchmark rendering on a host
+ */
+class NullScanlineSink : public ScanlineSink {
+    size_t _frames{0}, _pixels{0};
+    uint32_t _sum{0}, _last{0};
+
+public:
+    void begin(size_t /* len */) override { _sum = 0; }
+    void write(const CRGB *data, size_t len) override {
+        _pixels += len;
+        for (size_t i = 0; i != len; ++i)
+            _sum = _sum * 31 + (data[i].r << 16 | data[i].g << 8 | data[i].b);
+    }
+    void end() override { ++_frames; _last = _sum; }
+
+    size_t frames() const { return _frames; }
+    size_t pixels() const { return _pixels; }
+    // checksum of the last complete frame
+    uint32_t checksum() const { return _last; }
+};
+
+/**
+ * @brief Framebuffer-less display engine, renders 'racing the beam'
+ * instead of keeping a full canvas, engine asks a render callback to fill small chunks of pixels
+ * right before they are sent to the output sink. Only a ring of a few chunks is resident in memory,
+ * so very long installations could be driven from MCUs that can't fit a full CRGB canvas along with driver's buffers.
+ * Chunks are in physical order, pixels coordinates are resolved via layout's inverse transformation,
+ * so effects could be written in logical (x,y) terms for stripe and tiled canvases.
+ * Engine has no pixel buffers, buffer related methods are no-ops returning empty pointers
+ */
+class ScanlineDisplayEngine : public DisplayEngine<CRGB> {
+public:
+    // chunk render callback
+    using render_cb_t = std::function<void(scanline_chunk_t &chunk)>;
+
+    /**
+     * @brief Construct a new Scanline Display Engine object
+     * 
+     * @param w - canvas width
+     * @param h - canvas height
+     * @param sink - output sink
+     * @param layout - canvas layout, an empty pointer means plain row-major order
+     * @param chunk_len - chunk length in pixels, 0 - canvas width
+     * @param depth - number of chunks in a ring
+     */
+    ScanlineDisplayEngine(uint16_t w, uint16_t h, std::shared_ptr<ScanlineSink> sink, std::shared_ptr<LedStripe> layout = nullptr, size_t chunk_len = 0, uint8_t depth = 2);
+
+    /**
+     * @brief set chunk render callback
+     */
+    void onRender(render_cb_t cb){ _render = std::move(cb); }
+
+    /**
+     * @brief set canvas layout
+     * @param layout - canvas layout, an empty pointer means plain row-major order
+     */
+    void setLayout(std::shared_ptr<LedStripe> layout){ _layout = layout; }
+
+    void setSink(std::shared_ptr<ScanlineSink> sink){ _sink = sink; }
+
+    uint16_t w() const { return _w; }
+    uint16_t h() const { return _h; }
+
+    // resident memory used by chunk ring and coordinates, bytes
+    size_t memUsage() const { return _ring.size() * sizeof(CRGB) + (_x.size() + _y.size()) * sizeof(uint16_t); }
+
+    uint8_t brightness(uint8_t b) override { _brightness = b; return _brightness; };
+
+    // no pixel buffers, these are no-ops
+    void doubleBuffer(bool /* active */) override {};
+    void flipBuffer() override {};
+    bool toggleBuffer() override { return true; };
+    std::shared_ptr<PixelDataBuffer<CRGB>> getBackBuffer() override { return nullptr; };
+    std::shared_ptr<PixelDataBuffer<CRGB>> getActiveBuffer() override { return nullptr; };
+    void copyBack2Front() override {};
+    void copyFront2Back() override {};
+
+protected:
+    void engine_show() override;
+
+private:
+    uint16_t _w, _h;
+    size_t _chunk_len;
+    uint8_t _depth;
+    uint8_t _brightness{255};
+    std::shared_ptr<ScanlineSink> _sink;
+    std::shared_ptr<LedStripe> _layout;
+    render_cb_t _render;
+    // ring of chunks
+    std::vector<CRGB> _ring;
+    // logical coordinates of current chunk's pixels
+    std::vector<uint16_t> _x, _y;
+};
@@ -0,0 +1,106 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#include <math.h>
+#include "symmetry.hpp"
+
+/**
+ * @brief find logical source pixel for the specified pixel
+ * for pixels in fundamental region returns pixel itself
+ * @return true if source was found
+ */
+static bool source_xy(SymmetryMap::mode_t mode, int w, int h, int x, int y, uint8_t folds, int &sx, int &sy){
+    int hw = (w + 1) / 2, hh = (h + 1) / 2;
+    sx = x; sy = y;
+    switch (mode){
+        case SymmetryMap::mode_t::mirror_x :
+            if (x >= hw) sx = w - 1 - x;
+            return true;
+        case SymmetryMap::mode_t::mirror_y :
+            if (y >= hh) sy = h - 1 - y;
+            return true;
+        case SymmetryMap::mode_t::quad :
+        case SymmetryMap::mode_t::octa :
+            if (x >= hw) sx = w - 1 - x;
+            if (y >= hh) sy = h - 1 - y;
+            // fold over quadrant diagonal if mirrored pixel fits the quadrant
+            if (mode == SymmetryMap::mode_t::octa && sy > sx && sy < hw && sx < hh) std::swap(sx, sy);
+            return true;
+        case SymmetryMap::mode_t::radial : {
+            float cx = (w - 1) / 2.0f, cy = (h - 1) / 2.0f;
+            float dx = x - cx, dy = y - cy;
+            if (dx == 0 && dy == 0) return true;
+            float sector = 2 * M_PI / folds;
+            float a = atan2f(dy, dx);
+            if (a < 0) a += 2 * M_PI;
+            int k = static_cast<int>(a / sector);
+            if (k <= 0 || k >= folds) return true;
+            float c = cosf(k * sector), s = sinf(k * sector);
+            // rotate back by k sectors
+            float rx = cx + dx * c + dy * s, ry = cy - dx * s + dy * c;
+            sx = lroundf(rx); sy = lroundf(ry);
+            return sx >= 0 && sy >= 0 && sx < w && sy < h;
+        }
+        default:
+            return true;
+    }
+}
+
+bool SymmetryMap::build(mode_t mode, uint16_t w, uint16_t h, index_fn_t index, uint8_t folds){
+    clear();
+    if (!w || !h || !index || mode == mode_t::none || (mode == mode_t::radial && folds < 2)) return false;
+
+    _mode = mode;
+    _w = w; _h = h;
+    _fundamental.assign(static_cast<size_t>(w) * h, false);
+
+    // resolve sources, pixel is fundamental if it's it's own source
+    std::vector<std::pair<int, int>> src(static_cast<size_t>(w) * h);
+    for (int y = 0; y != h; ++y){
+        for (int x = 0; x != w; ++x){
+            int sx, sy;
+            if (!source_xy(mode, w, h, x, y, folds, sx, sy)){ sx = x; sy = y; }
+            src[y * w + x] = {sx, sy};
+            if (sx == x && sy == y) _fundamental[y * w + x] = true;
+        }
+    }
+
+    // radial sources are rounded and might miss the sector, such pixels are left to be rendered
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (int y = 0; y != h; ++y){
+        for (int x = 0; x != w; ++x){
+            const auto &s = src[y * w + x];
+            if (_fundamental[y * w + x]) continue;
+            if (!_fundamental[s.second * w + s.first]){
+                _fundamental[y * w + x] = true;
+                continue;
+            }
+            pairs.push_back({static_cast<uint32_t>(index(x, y)), static_cast<uint32_t>(index(s.first, s.second))});
+        }
+    }
+
+    // compile physical index pairs into runs
+    std::sort(pairs.begin(), pairs.end());
+    for (const auto &p : pairs){
+        if (_runs.size()){
+            run_t &r = _runs.back();
+            if (p.first == r.dst + r.len && r.len != UINT16_MAX){
+                if (r.len == 1 && (p.second == r.src + 1 || p.second + 1 == r.src)){
+                    r.step = p.second > r.src ? 1 : -1;
+                    ++r.len;
+                    continue;
+                }
+                if (r.len > 1 && p.second == r.src + r.step * r.len){
+                    ++r.len;
+                    continue;
+                }
+            }
+        }
+        _runs.push_back({p.first, p.second, 1, 1});
+    }
+    return true;
+}
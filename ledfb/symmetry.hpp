@@ -0,0 +1,110 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+/**
+ * @brief Symmetry map for mirrored and kaleidoscope effects
+ * effect renders only a fundamental region of the canvas, the rest of pixels are replicated from it.
+ * Replication is precomputed into a list of run copies in physical buffer order,
+ * i.e. a row that is contiguous in a LED chain (and it's mirror) becomes a single run,
+ * so applying the map costs a few memory copies instead of per-pixel coordinate mapping.
+ * Map must be rebuilt on canvas resize or topology change
+ */
+class SymmetryMap {
+public:
+    enum class mode_t {
+        none = 0,
+        mirror_x,       // 2-way, left half is mirrored to the right
+        mirror_y,       // 2-way, top half is mirrored to the bottom
+        quad,           // 4-way, top-left quadrant is mirrored to the others
+        octa,           // 8-way, top-left quadrant above it's diagonal is mirrored (a kaleidoscope)
+        radial          // N-fold rotation around canvas center, first sector is replicated
+    };
+
+    // a run of pixels copied from fundamental region
+    struct run_t {
+        uint32_t dst;       // physical index of the first destination pixel, run goes upwards
+        uint32_t src;       // physical index of the first source pixel
+        uint16_t len;       // number of pixels
+        int16_t step;       // source index increment, +1 or -1
+    };
+
+    // logical (x,y) to buffer index mapper
+    using index_fn_t = std::function<size_t(unsigned x, unsigned y)>;
+
+    SymmetryMap() = default;
+
+    /**
+     * @brief build symmetry map
+     *
+     * @param mode - symmetry type
+     * @param w - canvas width
+     * @param h - canvas height
+     * @param index - (x,y) to physical buffer index mapper, i.e. LedFB::index()
+     * @param folds - number of sectors for radial mode
+     * @return true on success
+     */
+    bool build(mode_t mode, uint16_t w, uint16_t h, index_fn_t index, uint8_t folds = 6);
+
+    /**
+     * @brief check if pixel belongs to fundamental region, i.e. it must be rendered by an effect
+     * pixels outside of the region are overwritten on apply()
+     */
+    bool fundamental(uint16_t x, uint16_t y) const { return _fundamental.empty() || (x < _w && y < _h && _fundamental[y * _w + x]); }
+
+    /**
+     * @brief replicate fundamental region over the whole buffer
+     * runs with source or destination pixels past the end of the buffer are skipped
+     *
+     * @param data - pixel buffer
+     * @param len - buffer length in pixels
+     */
+    template <class COLOR_TYPE>
+    void apply(COLOR_TYPE *data, size_t len) const;
+
+    // drop map
+    void clear(){ _runs.clear(); _fundamental.clear(); _w = _h = 0; _mode = mode_t::none; }
+
+    mode_t mode() const { return _mode; }
+
+    // canvas dimensions map was built for
+    uint16_t w() const { return _w; }
+    uint16_t h() const { return _h; }
+
+    // precomputed run copies
+    const std::vector<run_t>& runs() const { return _runs; }
+
+private:
+    mode_t _mode{mode_t::none};
+    uint16_t _w{0}, _h{0};
+    std::vector<run_t> _runs;
+    // fundamental region bitmap in logical row-major order
+    std::vector<bool> _fundamental;
+};
+
+template <class COLOR_TYPE>
+void SymmetryMap::apply(COLOR_TYPE *data, size_t len) const {
+    for (const auto &r : _runs){
+        if (r.dst + r.len > len) continue;
+        // backward runs read from src down to src - len + 1
+        if (r.step > 0 ? r.src + r.len > len : r.src >= len || r.src + 1 < r.len) continue;
+        if (r.step > 0){
+            std::copy(data + r.src, data + r.src + r.len, data + r.dst);
+        } else {
+            const COLOR_TYPE *s = data + r.src;
+            COLOR_TYPE *d = data + r.dst;
+            for (uint16_t i = 0; i != r.len; ++i)
+                *d++ = *s--;
+        }
+    }
+}
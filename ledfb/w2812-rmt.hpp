@@ -48,7 +48,11 @@ https://github.com/FastLED/FastLED/issues/826
 
 */
 #pragma once
+#include <vector>
+#include <algorithm>
 #include <FastLED.h>
+#include "calibration.hpp"
+#include "colormath.h"
 #ifdef ESP32
 
 /*
@@ -73,6 +77,105 @@ class CPixelLEDController : public CLEDController
             class WS2812B : public WS2812Controller800Khz
 */
 
+/// Output stage adjustments shared by unordered controllers: per-pixel calibration, per-segment correction and RGBW mode.
+/// Adjustments are applied per pixel with OutputAdjuster while pixel data is loaded into the driver.
+/// With FastLED <= 3.7.3 controller loads pixel data by itself, newer FastLED versions load pixel data internally
+/// in RmtController, so it is given a PixelController wrapper that adjusts each pixel as it is loaded
+class CLEDControllerAdjustable : public CLEDController {
+protected:
+    // per-pixel calibration map applied on pixel loading
+    const CalibrationMap *_calibration = nullptr;
+    // per-segment color correction, sorted by start index
+    std::vector<led_segment_t> _segments;
+    // RGBW white channel extraction
+    color::rgbw_mode_t _rgbw{color::rgbw_mode_t::none};
+    color::WhitePoint _wp;
+
+    /// true if pixel data has to be adjusted on loading
+    bool adjusting() const { return _calibration || _segments.size() || _rgbw != color::rgbw_mode_t::none; }
+
+    /// per-pixel adjuster for a single pass over pixel data in LED order
+    OutputAdjuster adjuster() const { return OutputAdjuster(_calibration, _segments, _rgbw, _wp); }
+
+public:
+    /// Set per-pixel calibration map, it is applied while pixel data is loaded into the driver
+    /// @param map a pointer to calibration map, nullptr disables calibration
+    void setCalibration(const CalibrationMap *map){ _calibration = map; }
+
+    /// Add a segment with it's own color correction and brightness
+    /// segment's adjustment is applied on top of controller-wide correction and brightness while pixel data is loaded into the driver
+    /// @param start index of the first LED in a segment
+    /// @param len number of LEDs in a segment
+    /// @param correction color correction
+    /// @param brightness brightness scale
+    /// @returns false if segment overlaps with existing one
+    bool addSegment(uint32_t start, uint32_t len, CRGB correction, uint8_t brightness = 255){
+        if (!len) return false;
+        auto it = std::find_if(_segments.begin(), _segments.end(), [start](const led_segment_t &s){ return s.start > start; });
+        if (it != _segments.end() && start + len > it->start) return false;
+        if (it != _segments.begin() && std::prev(it)->start + std::prev(it)->len > start) return false;
+        _segments.insert(it, {start, len, correction, brightness});
+        return true;
+    }
+
+    /// Set RGBW mode, white channel is extracted while pixel data is loaded into the driver
+    /// and sent as the 4th byte of each pixel, like SK6812 RGBW strips expect it.
+    /// Note: with FastLED > 3.7.3 FastLED's RGBW output is enabled, so that driver sends 4 bytes per pixel,
+    /// white channel itself is still extracted by OutputAdjuster in any mode
+    /// @param mode white channel extraction mode
+    /// @param wp white LED tint in RGB terms, used in whitepoint mode
+    /// @returns true, all modes are supported with any FastLED version
+    bool setRGBW(color::rgbw_mode_t mode, CRGB wp = CRGB(255, 255, 255)){
+#if FASTLED_VERSION > 3007003
+        setRgbw(Rgbw(kRGBWDefaultColorTemp, mode == color::rgbw_mode_t::none ? kRGBWInvalid : kRGBWExactColors));
+#endif
+        _rgbw = mode;
+        _wp = color::WhitePoint(wp.r, wp.g, wp.b);
+        return true;
+    }
+
+    /// Get RGBW mode
+    color::rgbw_mode_t getRGBW() const { return _rgbw; }
+
+    /// number of bytes sent for each pixel
+    int bytesPerPixel() const { return _rgbw == color::rgbw_mode_t::none ? 3 : 4; }
+
+    /// Get segments table
+    const std::vector<led_segment_t>& getSegments() const { return _segments; }
+
+    /// Remove all segments
+    void clearSegments(){ _segments.clear(); }
+};
+
+#if FASTLED_VERSION > 3007003
+/// PixelController wrapper for FastLED versions that load pixel data inside RmtController.
+/// Driver reads pixels through a PixelIterator that is bound to the actual controller type, so shadowed
+/// loadAndScaleRGB()/loadAndScaleRGBW() apply output stage adjustments to each pixel as it is loaded,
+/// everything else (dithering, advancing, size) is inherited from FastLED's PixelController
+template<EOrder RGB_ORDER, int LANES = 1, uint32_t MASK = 0xFFFFFFFF>
+class AdjustedPixelController : public PixelController<RGB_ORDER, LANES, MASK> {
+    OutputAdjuster _adj;
+
+public:
+    AdjustedPixelController(const PixelController<RGB_ORDER, LANES, MASK> &pixels, const OutputAdjuster &adj) : PixelController<RGB_ORDER, LANES, MASK>(pixels), _adj(adj) {}
+
+    void loadAndScaleRGB(uint8_t *b0_out, uint8_t *b1_out, uint8_t *b2_out){
+        *b0_out = this->loadAndScale0();
+        *b1_out = this->loadAndScale1();
+        *b2_out = this->loadAndScale2();
+        _adj.apply(RGB_ORDER, *b0_out, *b1_out, *b2_out);
+    }
+
+    // white is extracted with controller's RGBW mode, FastLED's mode is only used by the driver to send 4 bytes per pixel
+    void loadAndScaleRGBW(Rgbw rgbw, uint8_t *b0_out, uint8_t *b1_out, uint8_t *b2_out, uint8_t *w_out){
+        *b0_out = this->loadAndScale0();
+        *b1_out = this->loadAndScale1();
+        *b2_out = this->loadAndScale2();
+        *w_out = _adj.apply(RGB_ORDER, *b0_out, *b1_out, *b2_out);
+    }
+};
+#endif
+
 #if FASTLED_VERSION <= 3007008
 /// Template extension of the CLEDController class
 /// in comparision with CPixelLEDController this template does NOT have EOrder template parameter that defines RGB color ordering
@@ -83,11 +186,30 @@ class CPixelLEDController : public CLEDController
 /// @tparam LANES how many parallel lanes of output to write
 /// @tparam MASK bitmask for the output lanes
 template<typename showPolicy, int LANES=1, uint32_t MASK=0xFFFFFFFF>
-class CPixelLEDControllerUnordered : public CLEDController {
+class CPixelLEDControllerUnordered : public CLEDControllerAdjustable {
     // color order
     const EOrder _rgb_order;
 
 protected:
+    /// Load pixel data applying per-segment adjustment, calibration gain and RGBW extraction on the fly
+    /// adjustments are applied per pixel, so no pre-pass over the buffer is required
+    /// @param pixels the PixelController object for the LED data
+    /// @param out a callable that takes next output byte
+    template<EOrder RGB_ORDER, int L, uint32_t M, typename F>
+    void loadPixels(PixelController<RGB_ORDER, L, M> & pixels, F && out){
+        OutputAdjuster adj(adjuster());
+        while (pixels.has(1)){
+            uint8_t b0 = pixels.loadAndScale0();
+            uint8_t b1 = pixels.loadAndScale1();
+            uint8_t b2 = pixels.loadAndScale2();
+            uint8_t w = adj.apply(RGB_ORDER, b0, b1, b2);
+            out(b0); out(b1); out(b2);
+            if (_rgbw != color::rgbw_mode_t::none) out(w);
+            pixels.advanceData();
+            pixels.stepDithering();
+        }
+    }
+
     /// Send the LED data to the strip
     /// @param pixels the PixelController object for the LED data
     //virtual void showPixels(PixelController<RGB_ORDER,LANES,MASK> & pixels) = 0;
@@ -137,6 +259,11 @@ protected:
     /// @param nLeds the number of LEDs being written out
     /// @param scale the RGB scaling to apply to each LED before writing it out
     virtual void show(const struct CRGB *data, int nLeds, CRGB scale) {
+        _show(data, nLeds, scale);
+    }
+
+private:
+    void _show(const struct CRGB *data, int nLeds, CRGB scale) {
         // nLeds < 0 implies that we want to show them in reverse
         switch (_rgb_order){
             // this is the most usual type of ws strips around
@@ -175,7 +302,7 @@ protected:
     }
 
 public:
-    CPixelLEDControllerUnordered(EOrder rgb_order = GRB) : CLEDController(), _rgb_order(rgb_order) {}
+    CPixelLEDControllerUnordered(EOrder rgb_order = GRB) : CLEDControllerAdjustable(), _rgb_order(rgb_order) {}
 
     /// Get the number of lanes of the Controller
     /// @returns LANES from template
@@ -234,9 +361,14 @@ protected:
     void loadPixelData(PixelController<RGB_ORDER> & pixels)
     {
         // -- Make sure the buffer is allocated
-        int size_in_bytes = pixels.size() * 3;
+        int size_in_bytes = pixels.size() * this->bytesPerPixel();
         uint8_t * pData = mRMTController.getPixelBuffer(size_in_bytes);
 
+        if (this->adjusting()){
+            this->loadPixels(pixels, [&pData](uint8_t b){ *pData++ = b; });
+            return;
+        }
+
         // -- This might be faster
         while (pixels.has(1)) {
             *pData++ = pixels.loadAndScale0();
@@ -255,12 +387,17 @@ protected:
     void convertAllPixelData(PixelController<RGB_ORDER> & pixels)
     {
         // -- Make sure the data buffer is allocated
-        mRMTController.initPulseBuffer(pixels.size() * 3);
+        mRMTController.initPulseBuffer(pixels.size() * this->bytesPerPixel());
 
         // -- Cycle through the R,G, and B values in the right order,
         //    storing the pulses in the big buffer
 
         uint32_t byteval;
+        if (this->adjusting()){
+            this->loadPixels(pixels, [this](uint8_t b){ mRMTController.convertByte(b); });
+            return;
+        }
+
         while (pixels.has(1)) {
             byteval = pixels.loadAndScale0();
             mRMTController.convertByte(byteval);
@@ -310,8 +447,15 @@ public:
 
     // -- Show pixels
     //    This is the main entry point for the controller.
+    //    calibration, segments and RGBW are applied per pixel while driver loads pixel data
     template<EOrder RGB_ORDER = RGB>
     void showPixelsPolicy(PixelController<RGB_ORDER> & pixels){
+        if (this->adjusting()){
+            AdjustedPixelController<RGB_ORDER> adjusted(pixels, this->adjuster());
+            PixelIterator iterator(&adjusted, this->getRgbw());
+            mRMTController.showPixels(iterator);
+            return;
+        }
         PixelIterator iterator = pixels.as_iterator(this->getRgbw());
         mRMTController.showPixels(iterator);
     }
@@ -334,7 +478,7 @@ public:
 /// @tparam LANES how many parallel lanes of output to write
 /// @tparam MASK bitmask for the output lanes
 template<typename showPolicy, int LANES=1, uint32_t MASK=0xFFFFFFFF>
-class CPixelLEDControllerUnordered : public CLEDController {
+class CPixelLEDControllerUnordered : public CLEDControllerAdjustable {
     // color order
     const EOrder _rgb_order;
 
@@ -393,6 +537,11 @@ protected:
     /// @param scale_pre_mixed the RGB scaling of color adjustment + global brightness to apply to each LED (in RGB8 mode).
     virtual void show(const struct CRGB *data, int nLeds, uint8_t brightness) override {
         ColorAdjustment color_adjustment = getAdjustmentData(brightness);
+        _show(data, nLeds, color_adjustment);
+    }
+
+private:
+    void _show(const struct CRGB *data, int nLeds, const ColorAdjustment &color_adjustment) {
         // nLeds < 0 implies that we want to show them in reverse
         switch (_rgb_order){
             // this is the most usual type of ws strips around
@@ -431,7 +580,7 @@ protected:
     }
 
 public:
-    CPixelLEDControllerUnordered(EOrder rgb_order = GRB) : CLEDController(), _rgb_order(rgb_order) {}
+    CPixelLEDControllerUnordered(EOrder rgb_order = GRB) : CLEDControllerAdjustable(), _rgb_order(rgb_order) {}
 
     /// Get the number of lanes of the Controller
     /// @returns LANES from template
@@ -466,10 +615,18 @@ public:
 
     // -- Show pixels
     //    This is the main entry point for the controller.
+    //    calibration, segments and RGBW are applied per pixel while driver loads pixel data
     template<EOrder RGB_ORDER = RGB>
     void showPixelsPolicy(PixelController<RGB_ORDER> & pixels)
     {
-        //PixelIterator iterator = pixels.as_iterator(this->getRgbw());
+        if (this->adjusting()){
+            AdjustedPixelController<RGB_ORDER> adjusted(pixels, this->adjuster());
+            PixelIterator iterator(&adjusted, this->getRgbw());
+            mRMTController.loadPixelData(iterator);
+        } else {
+            PixelIterator iterator = pixels.as_iterator(this->getRgbw());
+            mRMTController.loadPixelData(iterator);
+        }
         mRMTController.showPixels();
     }
 
@@ -492,6 +649,18 @@ public:
 */
 class ESP32RMT_WS2812B : public ESP32RMT_WS2812Controller800Khz {
 public:
-    ESP32RMT_WS2812B(uint8_t pin, EOrder rgb_order) : ESP32RMT_WS2812Controller800Khz(pin, rgb_order){}
+    ESP32RMT_WS2812B(uint8_t pin, EOrder rgb_order, color::rgbw_mode_t rgbw = color::rgbw_mode_t::none) : ESP32RMT_WS2812Controller800Khz(pin, rgb_order){ setRGBW(rgbw); }
+};
+
+// SK6812 - 300ns, 300ns, 600ns
+/*
+ SK6812 controller class
+ with RTM run-time defined gpio, color order and RGBW mode
+*/
+class ESP32RMT_SK6812 : public ESP32RMT_ClocklessController<> {
+public:
+    ESP32RMT_SK6812(uint8_t pin, EOrder rgb_order, color::rgbw_mode_t rgbw = color::rgbw_mode_t::min, CRGB wp = CRGB(255, 255, 255)) : ESP32RMT_ClocklessController(pin, rgb_order, C_NS(300), C_NS(300), C_NS(600)){
+        setRGBW(rgbw, wp);
+    }
 };
 #endif  //ifdef ESP32
@@ -0,0 +1,47 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// helpers for host benchmarks, benchmarks only report timings and never fail a test
+#pragma once
+#include <chrono>
+#include <stdio.h>
+#include <unity.h>
+
+// results are accumulated here to keep optimizer from dropping benchmarked code
+inline volatile uint32_t bench_sink = 0;
+
+/**
+ * @brief run a callable repeatedly and measure average time of a single run
+ * 
+ * @param f - callable to benchmark
+ * @param runs - number of runs
+ * @return double - microseconds per run
+ */
+template <typename F>
+double bench_us(F &&f, unsigned runs){
+    // warm up caches
+    f();
+    auto t = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i != runs; ++i) f();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count() / runs;
+}
+
+/**
+ * @brief print benchmark result as a test message
+ * 
+ * @param name - benchmark name
+ * @param us - microseconds per run
+ * @param items - number of items processed per run, i.e. pixels, adds per item time if non zero
+ */
+inline void bench_report(const char *name, double us, size_t items = 0){
+    char msg[160];
+    if (items)
+        snprintf(msg, sizeof(msg), "%s: %.2f us, %.2f ns/item", name, us, us * 1000 / items);
+    else
+        snprintf(msg, sizeof(msg), "%s: %.2f us", name, us);
+    TEST_MESSAGE(msg);
+}
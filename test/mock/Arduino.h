@@ -0,0 +1,15 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// Arduino core mock for native host builds, provides only what LedFB uses
+#pragma once
+#include <stdint.h>
+
+// time source for millis(), tests drive animations by setting it directly
+inline uint32_t mock_ms = 0;
+inline uint32_t millis(){ return mock_ms; }
+inline uint32_t micros(){ return mock_ms * 1000; }
@@ -0,0 +1,37 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// Arduino_GFX mock for native host builds, drawing primitives fall back to writePixel()
+#pragma once
+#include <utility>
+#include "Arduino.h"
+
+#define GFX_NOT_DEFINED -1
+
+class Arduino_GFX {
+protected:
+    int16_t _width, _height;
+    uint8_t _rotation = 0;
+
+public:
+    Arduino_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+    virtual ~Arduino_GFX() = default;
+
+    virtual bool begin(int32_t speed = GFX_NOT_DEFINED) = 0;
+    virtual void writePixelPreclipped(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color){ writePixelPreclipped(x, y, color); }
+    virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){ for (int16_t i = 0; i < h; ++i) writePixel(x, y + i, color); }
+    virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){ for (int16_t i = 0; i < w; ++i) writePixel(x + i, y, color); }
+    virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){ for (int16_t j = 0; j < h; ++j) writeFastHLine(x, y + j, w, color); }
+    virtual void fillScreen(uint16_t color){}
+    // odd rotations swap display dimensions like Arduino_GFX does
+    virtual void setRotation(uint8_t r){ if ((r ^ _rotation) & 1) std::swap(_width, _height); _rotation = r & 3; }
+    uint8_t getRotation() const { return _rotation; }
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+};
@@ -0,0 +1,91 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// FastLED mock for native host builds
+// color math follows FastLED's reference C implementations, noise and trig are simplified
+// to cheap deterministic functions, so tests should compare code paths against each other, not against FastLED
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Arduino.h"
+
+typedef uint8_t fract8;
+
+enum EOrder { RGB=0012, RBG=0021, GRB=0102, GBR=0120, BRG=0201, BGR=0210 };
+#define RGB_BYTE0(X) ((X>>6) & 0x3)
+#define RGB_BYTE1(X) ((X>>3) & 0x3)
+#define RGB_BYTE2(X) ((X) & 0x3)
+
+inline uint8_t scale8(uint8_t i, uint8_t s){ return ((uint16_t)i * (1 + (uint16_t)s)) >> 8; }
+inline uint8_t scale8_video(uint8_t i, uint8_t s){ return (((int)i * (int)s) >> 8) + ((i && s) ? 1 : 0); }
+inline uint8_t qadd8(uint8_t a, uint8_t b){ unsigned t = a + b; return t > 255 ? 255 : t; }
+inline uint8_t qsub8(uint8_t a, uint8_t b){ return a > b ? a - b : 0; }
+inline uint8_t lerp8by8(uint8_t a, uint8_t b, fract8 f){ return b > a ? a + scale8(b - a, f) : a - scale8(a - b, f); }
+inline uint8_t inoise8(uint16_t x, uint16_t y){ return x ^ y; }
+inline uint8_t inoise8(uint16_t x, uint16_t y, uint16_t z){ return x ^ y ^ z; }
+inline uint8_t sin8(uint8_t t){ return t; }
+
+struct CRGB {
+    union {
+        struct {
+            union { uint8_t r; uint8_t red; };
+            union { uint8_t g; uint8_t green; };
+            union { uint8_t b; uint8_t blue; };
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode { Black = 0, White = 0xFFFFFF, Red = 0xFF0000 };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(uint32_t c) : r((c >> 16) & 0xff), g((c >> 8) & 0xff), b(c & 0xff) {}
+    CRGB(HTMLColorCode c) : CRGB((uint32_t)c) {}
+
+    uint8_t& operator[](uint8_t i){ return raw[i]; }
+    const uint8_t& operator[](uint8_t i) const { return raw[i]; }
+
+    CRGB& nscale8(uint8_t s){ r = scale8(r, s); g = scale8(g, s); b = scale8(b, s); return *this; }
+    CRGB& nscale8(const CRGB &s){ r = scale8(r, s.r); g = scale8(g, s.g); b = scale8(b, s.b); return *this; }
+    CRGB& nscale8_video(uint8_t s){ r = scale8_video(r, s); g = scale8_video(g, s); b = scale8_video(b, s); return *this; }
+    CRGB& fadeToBlackBy(uint8_t f){ return nscale8(255 - f); }
+    CRGB& operator+=(const CRGB &o){ r = qadd8(r, o.r); g = qadd8(g, o.g); b = qadd8(b, o.b); return *this; }
+    CRGB& operator-=(const CRGB &o){ r = qsub8(r, o.r); g = qsub8(g, o.g); b = qsub8(b, o.b); return *this; }
+    CRGB& operator|=(const CRGB &o){ if (o.r > r) r = o.r; if (o.g > g) g = o.g; if (o.b > b) b = o.b; return *this; }
+    uint8_t getAverageLight() const { return (r + g + b) / 3; }
+};
+
+inline bool operator==(const CRGB &a, const CRGB &b){ return a.r == b.r && a.g == b.g && a.b == b.b; }
+inline bool operator!=(const CRGB &a, const CRGB &b){ return !(a == b); }
+inline CRGB operator+(const CRGB &a, const CRGB &b){ CRGB r(a); r += b; return r; }
+inline CRGB& nblend(CRGB &e, const CRGB &o, fract8 a){ e.r = lerp8by8(e.r, o.r, a); e.g = lerp8by8(e.g, o.g, a); e.b = lerp8by8(e.b, o.b, a); return e; }
+inline CRGB blend(const CRGB &a, const CRGB &b, fract8 f){ CRGB r(a); return nblend(r, b, f); }
+
+struct CRGBPalette16 { CRGB entries[16]; };
+enum TBlendType { NOBLEND = 0, LINEARBLEND = 1 };
+inline CRGB ColorFromPalette(const CRGBPalette16 &p, uint8_t i, uint8_t b = 255, TBlendType = LINEARBLEND){ CRGB c = p.entries[i >> 4]; return c.nscale8(b); }
+// distinct gradients, so tests could tell palettes apart
+inline CRGBPalette16 mock_palette(uint8_t id){ CRGBPalette16 p; for (unsigned k = 0; k != 16; ++k) p.entries[k] = CRGB(k * 16 + id, 255 - k * 16, id * 32); return p; }
+inline const CRGBPalette16 RainbowColors_p = mock_palette(0), HeatColors_p = mock_palette(1), PartyColors_p = mock_palette(2), ForestColors_p = mock_palette(3),
+    OceanColors_p = mock_palette(4), LavaColors_p = mock_palette(5), CloudColors_p = mock_palette(6);
+
+class CLEDController {
+public:
+    // data array the controller outputs
+    CRGB *leds = nullptr;
+    int count = 0;
+    CLEDController& setLeds(CRGB *data, int n){ leds = data; count = n; return *this; }
+};
+
+struct CFastLED {
+    uint8_t _b = 255;
+    void show(){}
+    void setBrightness(uint8_t b){ _b = b; }
+    uint8_t getBrightness(){ return _b; }
+};
+inline CFastLED FastLED;
@@ -0,0 +1,174 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// render hot path heap activity, needs a build with LEDFB_ALLOC_TRACKING defined
+#include <new>
+#include <unity.h>
+#include "ledfb.hpp"
+#include "animclock.hpp"
+
+#ifdef LEDFB_ALLOC_TRACKING
+
+void setUp(){ mock_ms = 0; AllocTracker::reset(); }
+void tearDown(){}
+
+// display engine with front and back buffers bound to a LED controller, buffer management follows ESP32RMTDisplayEngine
+class TestEngine : public DisplayEngine<CRGB> {
+    std::shared_ptr<CLedCDB> canvas, backbuff;
+    bool _active_buff{true};
+
+    void engine_show() override { ++shows; }
+
+public:
+    CLEDController cled;
+    int shows{0};
+
+    TestEngine(size_t len) : canvas(std::make_shared<CLedCDB>(len)) { canvas->bind(&cled); }
+
+    void doubleBuffer(bool active) override {
+        if (active && !backbuff){
+            backbuff = std::make_shared<CLedCDB>(canvas->size());
+            return;
+        }
+        if (!active && backbuff){
+            if (backbuff->isBound()) canvas->rebind(*backbuff);
+            backbuff.reset();
+            _active_buff = true;
+        }
+    }
+    bool doubleBuffer() const override { return backbuff.use_count(); }
+    void flipBuffer() override { LEDFB_HOT_PATH; if (backbuff) canvas->swap(*backbuff); }
+    bool toggleBuffer() override {
+        LEDFB_HOT_PATH;
+        if (backbuff){
+            canvas->rebind(*backbuff);
+            _active_buff = !_active_buff;
+        }
+        return _active_buff;
+    }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getBuffer() override { return canvas; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getBackBuffer() override { return backbuff.use_count() ? backbuff : canvas; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getActiveBuffer() override { return _active_buff ? canvas : backbuff; }
+    void copyBack2Front() override {
+        LEDFB_HOT_PATH;
+        if (backbuff) std::copy_n(backbuff->data().cbegin(), std::min(canvas->size(), backbuff->size()), canvas->data().begin());
+    }
+    void copyFront2Back() override {
+        LEDFB_HOT_PATH;
+        if (backbuff) std::copy_n(canvas->data().cbegin(), std::min(canvas->size(), backbuff->size()), backbuff->data().begin());
+    }
+};
+
+struct alignas(64) aligned_block { uint8_t data[64]; };
+
+void test_tracker_counts_all_forms(){
+    // pointers are passed through a volatile to keep new/delete pairs from being optimized out
+    void * volatile p;
+    {
+        LEDFB_HOT_PATH;
+        p = new int(1);                             delete static_cast<int*>(p);
+        p = new int[4];                             delete[] static_cast<int*>(p);
+        p = new (std::nothrow) int(1);              delete static_cast<int*>(p);
+        p = new (std::nothrow) int[4];              delete[] static_cast<int*>(p);
+        p = new aligned_block;
+        TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(p) % alignof(aligned_block));
+        delete static_cast<aligned_block*>(p);
+        p = new aligned_block[2];                   delete[] static_cast<aligned_block*>(p);
+        p = new (std::nothrow) aligned_block;       delete static_cast<aligned_block*>(p);
+        p = ::operator new(8, std::nothrow);        ::operator delete(p, std::nothrow);
+        p = ::operator new(8, std::align_val_t(32)); ::operator delete(p, std::align_val_t(32), std::nothrow);
+    }
+    TEST_ASSERT_EQUAL(9, AllocTracker::allocs);
+    TEST_ASSERT_EQUAL(9, AllocTracker::frees);
+
+    // nothing is counted out of hot path scope
+    AllocTracker::reset();
+    p = new aligned_block;                          delete static_cast<aligned_block*>(p);
+    p = new int(1);                                 delete static_cast<int*>(p);
+    TEST_ASSERT_EQUAL(0, AllocTracker::allocs);
+    TEST_ASSERT_EQUAL(0, AllocTracker::frees);
+}
+
+void test_10k_frames_no_heap(){
+    constexpr unsigned frames = 10000;
+    auto e = std::make_shared<TestEngine>(16 * 16);
+    e->doubleBuffer(true);
+    TEST_ASSERT_TRUE(e->doubleBuffer());
+    auto clock = std::make_shared<AnimationClock>(20);
+    unsigned steps = 0;
+    clock->onStep([&](uint32_t){ ++steps; });
+    e->setClock(clock);
+    e->interpolate(true);
+    LedFB<CRGB> fx(16, 16, e->getFrameBuffer());
+    // overlay drawn straight to the back buffer
+    LedFB<CRGB> hud(16, 16, e->getBackBuffer());
+
+    auto frame = [&](unsigned i){
+        LEDFB_HOT_PATH;
+        e->beginFrame();
+        if (i % 64 == 0) fx.fill(CRGB(0, 0, 16));
+        fx.fade(32);
+        fx.at(i % 16, (i / 16) % 16) = CRGB(255, i, 0);
+        e->commitFrame();
+        for (unsigned k = 0; k != 2; ++k){
+            mock_ms += 5;
+            e->show();
+        }
+        // interpolated frame goes to back, back buffer content is shown
+        hud.at(0, 0) = CRGB(0, 255, 0);
+        e->flipBuffer();
+        e->copyFront2Back();
+        if (i % 16 == 0) e->copyBack2Front();
+        // output switches between buffers from time to time
+        if (i % 256 == 255) e->toggleBuffer();
+        for (unsigned k = 0; k != 2; ++k){
+            mock_ms += 5;
+            e->show();
+        }
+    };
+
+    // first frames may allocate lazily built state
+    for (unsigned i = 0; i != 4; ++i) frame(i);
+    AllocTracker::reset();
+
+    for (unsigned i = 0; i != frames; ++i) frame(i);
+
+    TEST_ASSERT_EQUAL(0, AllocTracker::allocs);
+    TEST_ASSERT_EQUAL(0, AllocTracker::frees);
+    TEST_ASSERT_EQUAL((frames + 4) * 4, e->shows);
+    TEST_ASSERT_TRUE(steps >= frames);
+
+    // controller follows swapped data and stays bound to the active buffer
+    auto active = e->getActiveBuffer();
+    TEST_ASSERT_TRUE(e->cled.leds == active->data().data());
+    TEST_ASSERT_EQUAL(active->size(), e->cled.count);
+    // flip swaps buffer content without copying
+    const CRGB *front = e->getBuffer()->data().data(), *back = e->getBackBuffer()->data().data();
+    e->flipBuffer();
+    TEST_ASSERT_TRUE(e->getBuffer()->data().data() == back);
+    TEST_ASSERT_TRUE(e->getBackBuffer()->data().data() == front);
+    e->doubleBuffer(false);
+    TEST_ASSERT_TRUE(e->cled.leds == e->getBuffer()->data().data());
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_tracker_counts_all_forms);
+    RUN_TEST(test_10k_frames_no_heap);
+    return UNITY_END();
+}
+
+#else
+void setUp(){}
+void tearDown(){}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    TEST_MESSAGE("LEDFB_ALLOC_TRACKING is not defined, skipped");
+    return UNITY_END();
+}
+#endif  // LEDFB_ALLOC_TRACKING
@@ -0,0 +1,176 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// fixed-timestep animation clock driven by mock millis()
+#include <unity.h>
+#include "ledfb.hpp"
+
+void setUp(){ mock_ms = 0; }
+void tearDown(){}
+
+// display engine over a single buffer, show() updates attached clock
+class TestEngine : public DisplayEngine<CRGB> {
+    void engine_show() override {}
+
+public:
+    std::shared_ptr<PixelDataBuffer<CRGB>> buff;
+
+    TestEngine(size_t len) : buff(std::make_shared<PixelDataBuffer<CRGB>>(len)) {}
+    void doubleBuffer(bool active) override {}
+    void flipBuffer() override {}
+    bool toggleBuffer() override { return false; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getBackBuffer() override { return buff; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getActiveBuffer() override { return buff; }
+    void copyBack2Front() override {}
+    void copyFront2Back() override {}
+};
+
+void test_first_update_sets_origin(){
+    AnimationClock clock(20);
+    mock_ms = 5000;
+    TEST_ASSERT_EQUAL(0, clock.advance(millis()));
+    TEST_ASSERT_EQUAL(0, clock.alpha());
+    mock_ms += 19;
+    TEST_ASSERT_EQUAL(0, clock.advance(millis()));
+    mock_ms += 1;
+    TEST_ASSERT_EQUAL(1, clock.advance(millis()));
+    TEST_ASSERT_EQUAL(1, clock.ticks());
+}
+
+void test_stall_catch_up(){
+    AnimationClock clock(10, 4);
+    std::vector<uint32_t> steps;
+    std::vector<uint8_t> alphas;
+    clock.onStep([&](uint32_t t){ steps.push_back(t); });
+    clock.onRender([&](uint8_t a){ alphas.push_back(a); });
+    clock.update(millis());
+
+    // a short stall is caught up completely, steps are numbered sequentially
+    mock_ms += 35;
+    clock.update(millis());
+    TEST_ASSERT_EQUAL(3, steps.size());
+    for (uint32_t i = 0; i != steps.size(); ++i) TEST_ASSERT_EQUAL(i + 1, steps[i]);
+    TEST_ASSERT_EQUAL(0, clock.dropped());
+    TEST_ASSERT_EQUAL(128, alphas.back());
+
+    // following frames keep fractional remainder
+    mock_ms += 5;
+    clock.update(millis());
+    TEST_ASSERT_EQUAL(4, clock.ticks());
+    TEST_ASSERT_EQUAL(0, alphas.back());
+
+    // a long stall is limited by catch-up limit, excess time is dropped, fraction is kept
+    steps.clear();
+    mock_ms += 1007;
+    clock.update(millis());
+    TEST_ASSERT_EQUAL(4, steps.size());
+    TEST_ASSERT_EQUAL(5, steps.front());
+    TEST_ASSERT_EQUAL(8, steps.back());
+    TEST_ASSERT_EQUAL(8, clock.ticks());
+    TEST_ASSERT_EQUAL(1000 - 40, clock.dropped());
+    TEST_ASSERT_EQUAL((7 << 8) / 10, alphas.back());
+
+    // clock runs at normal rate after the stall
+    mock_ms += 13;
+    TEST_ASSERT_EQUAL(2, clock.advance(millis()));
+    TEST_ASSERT_EQUAL(1000 - 40, clock.dropped());
+}
+
+void test_catch_up_limit(){
+    // limit is exactly met, nothing dropped
+    AnimationClock clock(16, 3);
+    clock.advance(0);
+    TEST_ASSERT_EQUAL(3, clock.advance(48));
+    TEST_ASSERT_EQUAL(0, clock.dropped());
+    // one step over the limit
+    TEST_ASSERT_EQUAL(3, clock.advance(48 + 64));
+    TEST_ASSERT_EQUAL(16, clock.dropped());
+
+    // limit changed on the fly
+    clock.setMaxSteps(1);
+    TEST_ASSERT_EQUAL(1, clock.advance(112 + 40));
+    TEST_ASSERT_EQUAL(16 + 16, clock.dropped());
+    TEST_ASSERT_EQUAL((8 << 8) / 16, clock.alpha());
+
+    // zero limit freezes the simulation, all whole steps are dropped
+    clock.setMaxSteps(0);
+    TEST_ASSERT_EQUAL(0, clock.advance(152 + 100));
+    TEST_ASSERT_EQUAL(16 + 16 + 96, clock.dropped());
+    TEST_ASSERT_EQUAL(7, clock.ticks());
+}
+
+void test_alpha_edges(){
+    for (uint32_t step : {1u, 3u, 16u, 20u, 1000u, 65535u}){
+        AnimationClock clock(step);
+        clock.advance(0);
+        // no time accumulated
+        TEST_ASSERT_EQUAL(0, clock.alpha());
+        // accumulator just below the step, alpha never reaches 256
+        clock.advance(step - 1);
+        uint8_t expect = ((step - 1) << 8) / step;
+        TEST_ASSERT_EQUAL(expect, clock.alpha());
+        TEST_ASSERT_TRUE(step == 1 || clock.alpha() >= 255 * (step - 1) / step);
+        // accumulator wraps to zero exactly on the step boundary
+        TEST_ASSERT_EQUAL(1, clock.advance(step));
+        TEST_ASSERT_EQUAL(0, clock.alpha());
+        // alpha grows monotonically through the step
+        uint8_t prev = 0;
+        for (uint32_t t = 1; t < step && t < 2000; ++t){
+            clock.advance(step + t);
+            TEST_ASSERT_TRUE(clock.alpha() >= prev);
+            prev = clock.alpha();
+        }
+    }
+
+    // step shortened below accumulated time resets accumulator
+    AnimationClock clock(100);
+    clock.advance(0);
+    clock.advance(60);
+    clock.setStep(50);
+    TEST_ASSERT_EQUAL(0, clock.alpha());
+    clock.setStep(0);
+    TEST_ASSERT_EQUAL(1, clock.getStep());
+}
+
+void test_timer_wrap(){
+    AnimationClock clock(10);
+    mock_ms = UINT32_MAX - 14;
+    clock.advance(millis());
+    mock_ms += 25;      // wraps
+    TEST_ASSERT_EQUAL(2, clock.advance(millis()));
+    TEST_ASSERT_EQUAL(128, clock.alpha());
+}
+
+void test_engine_drives_clock(){
+    TestEngine e(4);
+    auto clock = std::make_shared<AnimationClock>(20, 2);
+    uint32_t steps = 0;
+    clock->onStep([&](uint32_t){ ++steps; });
+    e.setClock(clock);
+    mock_ms = 100;
+    e.show();
+    mock_ms += 50;
+    e.show();
+    TEST_ASSERT_EQUAL(2, steps);
+    // stalled display
+    mock_ms += 200;
+    e.show();
+    TEST_ASSERT_EQUAL(4, steps);
+    TEST_ASSERT_EQUAL(160, clock->dropped());
+    TEST_ASSERT_EQUAL((10 << 8) / 20, clock->alpha());
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_first_update_sets_origin);
+    RUN_TEST(test_stall_catch_up);
+    RUN_TEST(test_catch_up_limit);
+    RUN_TEST(test_alpha_edges);
+    RUN_TEST(test_timer_wrap);
+    RUN_TEST(test_engine_drives_clock);
+    return UNITY_END();
+}
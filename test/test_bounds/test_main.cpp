@@ -0,0 +1,82 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// debug bounds checking of unchecked accessors, run with LEDFB_DEBUG_BOUNDS defined
+//   pio test -e native_debug -f test_bounds
+#include <unity.h>
+#include <string.h>
+#include "ledfb.hpp"
+
+void setUp(){
+#ifdef LEDFB_DEBUG_BOUNDS
+    BoundsViolationLog::reset();
+#endif
+}
+void tearDown(){}
+
+// calls with a literal 0 must resolve to coordinates overload in any build mode
+void test_literal_zero_overloads(){
+    LedFB<CRGB> fb(4, 3);
+    fb.at(2, 0) = CRGB(1, 2, 3);
+    fb.at(0, 1) = CRGB(4, 5, 6);
+    int16_t x = 2, y = 1;
+    TEST_ASSERT_TRUE(fb.at_unchecked(x, 0) == CRGB(1, 2, 3));
+    TEST_ASSERT_TRUE(fb.at_unchecked(0, y) == CRGB(4, 5, 6));
+    TEST_ASSERT_TRUE(&fb.at_unchecked(0, 0) == &fb.at(0, 0));
+    TEST_ASSERT_TRUE(&fb.at_unchecked(static_cast<size_t>(0)) == &fb.at(0, 0));
+    // scroll runs unchecked loops over the whole canvas
+    fb.scroll(1, 0);
+    TEST_ASSERT_TRUE(fb.at(3, 0) == CRGB(1, 2, 3));
+#ifdef LEDFB_DEBUG_BOUNDS
+    TEST_ASSERT_EQUAL(0, BoundsViolationLog::count);
+#endif
+}
+
+#ifdef LEDFB_DEBUG_BOUNDS
+void test_violations_are_logged(){
+    PixelDataBuffer<CRGB> b(8);
+    LedFB<CRGB> fb(4, 3);
+
+    int line = __LINE__; b.at_unchecked(8) = CRGB(255, 0, 0);
+    TEST_ASSERT_EQUAL(1, BoundsViolationLog::count);
+    TEST_ASSERT_EQUAL(line, BoundsViolationLog::sites[0].line);
+    TEST_ASSERT_NOT_NULL(strstr(BoundsViolationLog::sites[0].file, "test_bounds"));
+    // oob writes go to a stub pixel and do not touch the buffer
+    for (size_t i = 0; i != b.size(); ++i)
+        TEST_ASSERT_TRUE(b.at(i) == CRGB());
+
+    // canvas accessors report their own caller, not the buffer call inside
+    line = __LINE__; fb.at_unchecked(4, 0);
+    fb.at_unchecked(0, -1);
+    fb.at_unchecked(static_cast<size_t>(12));
+    TEST_ASSERT_EQUAL(4, BoundsViolationLog::count);
+    TEST_ASSERT_EQUAL(line, BoundsViolationLog::sites[1].line);
+    TEST_ASSERT_EQUAL(line + 1, BoundsViolationLog::sites[2].line);
+    TEST_ASSERT_EQUAL(line + 2, BoundsViolationLog::sites[3].line);
+    TEST_ASSERT_NOT_NULL(strstr(BoundsViolationLog::sites[3].file, "test_bounds"));
+
+    // in range access is not logged
+    fb.at_unchecked(3, 2);
+    fb.at_unchecked(static_cast<size_t>(11));
+    TEST_ASSERT_EQUAL(4, BoundsViolationLog::count);
+
+    // log keeps last 'depth' call sites as a ring
+    for (size_t i = 0; i != BoundsViolationLog::depth; ++i) b.at_unchecked(100);
+    TEST_ASSERT_EQUAL(4 + BoundsViolationLog::depth, BoundsViolationLog::count);
+}
+#endif
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_literal_zero_overloads);
+#ifdef LEDFB_DEBUG_BOUNDS
+    RUN_TEST(test_violations_are_logged);
+#else
+    TEST_MESSAGE("LEDFB_DEBUG_BOUNDS is not defined, violation log checks skipped");
+#endif
+    return UNITY_END();
+}
@@ -0,0 +1,217 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// output stage adjustments: segment gain, calibration and RGBW extraction applied per pixel
+#include <unity.h>
+#include "calibration.hpp"
+#include "bench.hpp"
+
+using color::rgbw_mode_t;
+
+static const color::WhitePoint neutral;
+static const std::vector<led_segment_t> no_segments;
+
+void setUp(){}
+void tearDown(){}
+
+// segment gain as it's applied to a pixel
+static CRGB seg_gain(const led_segment_t &s){ CRGB g(s.correction); return g.nscale8(s.brightness); }
+
+void test_no_adjustments_is_identity(){
+    OutputAdjuster adj(nullptr, no_segments, rgbw_mode_t::none, neutral);
+    for (unsigned i = 0; i != 256; ++i){
+        uint8_t b0 = i, b1 = 255 - i, b2 = i / 2;
+        TEST_ASSERT_EQUAL(0, adj.apply(GRB, b0, b1, b2));
+        TEST_ASSERT_EQUAL(i, b0);
+        TEST_ASSERT_EQUAL(255 - i, b1);
+        TEST_ASSERT_EQUAL(i / 2, b2);
+    }
+}
+
+void test_segment_boundaries(){
+    // segment at the start, an adjacent one, a gap, and a segment running past the end of the strip
+    std::vector<led_segment_t> segs = {
+        {0, 2, CRGB(128, 255, 255), 255},
+        {2, 3, CRGB(255, 255, 255), 64},
+        {7, 1, CRGB(255, 0, 255), 200},
+        {10, 100, CRGB(10, 20, 30), 255},
+    };
+    OutputAdjuster adj(nullptr, segs, rgbw_mode_t::none, neutral);
+    for (uint32_t i = 0; i != 16; ++i){
+        CRGB expect(255, 255, 255);
+        for (const auto &s : segs)
+            if (i >= s.start && i < s.start + s.len) expect = seg_gain(s);
+        CRGB g = adj.next();
+        char msg[32];
+        snprintf(msg, sizeof(msg), "pixel %u", static_cast<unsigned>(i));
+        TEST_ASSERT_TRUE_MESSAGE(g == expect, msg);
+    }
+}
+
+void test_segments_with_calibration(){
+    std::vector<led_segment_t> segs = {{1, 2, CRGB(255, 128, 255), 128}};
+    CalibrationMap map;
+    map.addRun(2, CRGB(200, 255, 100));
+    map.addRun(1, CRGB(255, 255, 255));
+    map.addRun(1, CRGB(0, 128, 255));
+    OutputAdjuster adj(&map, segs, rgbw_mode_t::none, neutral);
+    for (uint32_t i = 0; i != 6; ++i){
+        CRGB expect = i >= 1 && i < 3 ? seg_gain(segs[0]) : CRGB(255, 255, 255);
+        expect.nscale8(map.gain(i));
+        TEST_ASSERT_TRUE(adj.next() == expect);
+    }
+
+    // gain is applied to wire bytes by their color order, GRB sends green first
+    OutputAdjuster grb(&map, segs, rgbw_mode_t::none, neutral);
+    uint8_t b0 = 200, b1 = 200, b2 = 200;
+    grb.apply(GRB, b0, b1, b2);
+    TEST_ASSERT_EQUAL(scale8(200, 255), b0);
+    TEST_ASSERT_EQUAL(scale8(200, 200), b1);
+    TEST_ASSERT_EQUAL(scale8(200, 100), b2);
+}
+
+void test_rgbw_modes(){
+    // RGB(200, 100, 50) sent as BRG
+    auto run = [](rgbw_mode_t mode, const color::WhitePoint &wp, uint8_t &w) -> CRGB {
+        OutputAdjuster adj(nullptr, no_segments, mode, wp);
+        uint8_t b0 = 50, b1 = 200, b2 = 100;
+        w = adj.apply(BRG, b0, b1, b2);
+        return CRGB(b1, b2, b0);
+    };
+    uint8_t w;
+    TEST_ASSERT_TRUE(run(rgbw_mode_t::none, neutral, w) == CRGB(200, 100, 50));
+    TEST_ASSERT_EQUAL(0, w);
+    TEST_ASSERT_TRUE(run(rgbw_mode_t::min, neutral, w) == CRGB(150, 50, 0));
+    TEST_ASSERT_EQUAL(50, w);
+
+    // whitepoint extraction matches colormath kernel on channels in RGB order
+    color::WhitePoint warm(255, 200, 150);
+    uint8_t r = 200, g = 100, b = 50;
+    uint8_t ew = color::rgb2rgbw_whitepoint(r, g, b, warm);
+    TEST_ASSERT_TRUE(run(rgbw_mode_t::whitepoint, warm, w) == CRGB(r, g, b));
+    TEST_ASSERT_EQUAL(ew, w);
+
+    // white is extracted from adjusted color
+    std::vector<led_segment_t> segs = {{0, 1, CRGB(255, 255, 255), 128}};
+    OutputAdjuster adj(nullptr, segs, rgbw_mode_t::min, neutral);
+    uint8_t b0 = 200, b1 = 100, b2 = 50;
+    w = adj.apply(RGB, b0, b1, b2);
+    TEST_ASSERT_EQUAL(scale8(50, 128), w);
+    TEST_ASSERT_EQUAL(scale8(200, 128) - w, b0);
+}
+
+// cursor walks runs in order and switches gain exactly on run boundaries
+void test_cursor_run_boundaries(){
+    CalibrationMap map;
+    map.addRun(3, CRGB(10, 20, 30));
+    map.addRun(1, CRGB(40, 50, 60));
+    map.addRun(0, CRGB(1, 1, 1));           // empty run is ignored
+    map.addRun(2, CRGB(70, 80, 90));
+    TEST_ASSERT_EQUAL(3, map.runs());
+    TEST_ASSERT_EQUAL(6, map.size());
+
+    CalibrationMap::cursor c(map);
+    const CRGB expect[] = {
+        CRGB(10, 20, 30), CRGB(10, 20, 30), CRGB(10, 20, 30), CRGB(40, 50, 60), CRGB(70, 80, 90), CRGB(70, 80, 90),
+        // past the end of the map
+        CRGB(255, 255, 255), CRGB(255, 255, 255)
+    };
+    for (size_t i = 0; i != sizeof(expect) / sizeof(expect[0]); ++i){
+        CRGB g = c.next();
+        TEST_ASSERT_TRUE(g == expect[i]);
+        // random access lookup agrees with the cursor
+        TEST_ASSERT_TRUE(map.gain(i) == g);
+    }
+}
+
+void test_empty_map(){
+    CalibrationMap map;
+    TEST_ASSERT_EQUAL(0, map.size());
+    TEST_ASSERT_EQUAL(0, map.runs());
+    TEST_ASSERT_TRUE(map.gain(0) == CRGB(255, 255, 255));
+
+    CalibrationMap::cursor c(map), none;
+    for (size_t i = 0; i != 4; ++i){
+        TEST_ASSERT_TRUE(c.next() == CRGB(255, 255, 255));
+        TEST_ASSERT_TRUE(none.next() == CRGB(255, 255, 255));
+    }
+
+    // adjuster with an empty map does not change pixels
+    OutputAdjuster adj(&map, no_segments, rgbw_mode_t::none, neutral);
+    uint8_t b0 = 1, b1 = 2, b2 = 3;
+    adj.apply(RGB, b0, b1, b2);
+    TEST_ASSERT_EQUAL(1, b0);
+    TEST_ASSERT_EQUAL(2, b1);
+    TEST_ASSERT_EQUAL(3, b2);
+
+    // map from an empty gains vector
+    CalibrationMap v(std::vector<CRGB>{});
+    TEST_ASSERT_EQUAL(0, v.size());
+}
+
+void test_set_tiles(){
+    // 4x2 tiles, 3x2 tiles of them
+    LedTiles tiles(4, 2, 3, 2);
+    CalibrationMap map;
+    map.addRun(100, CRGB(1, 2, 3));         // previous content is dropped
+    std::vector<CRGB> gains = {CRGB(200, 255, 255), CRGB(255, 200, 255), CRGB(255, 200, 255), CRGB(255, 255, 200)};
+    map.setTiles(tiles, gains);
+
+    // equal gains of adjacent tiles are merged into a single run
+    TEST_ASSERT_EQUAL(3, map.runs());
+    // only tiles with a gain are covered
+    TEST_ASSERT_EQUAL(4 * 8, map.size());
+    CalibrationMap::cursor c(map);
+    for (size_t i = 0; i != 6 * 8; ++i){
+        CRGB expect = i < map.size() ? gains[i / 8] : CRGB(255, 255, 255);
+        TEST_ASSERT_TRUE(c.next() == expect);
+        TEST_ASSERT_TRUE(map.gain(i) == expect);
+    }
+
+    map.setTiles(tiles, {});
+    TEST_ASSERT_EQUAL(0, map.size());
+    TEST_ASSERT_EQUAL(0, map.runs());
+}
+
+// per pixel cost of the adjuster over a 1024 LED strip, segments + calibration + RGBW
+void bench_adjuster(){
+    constexpr size_t len = 1024;
+    std::vector<led_segment_t> segs;
+    for (uint32_t s = 0; s < len; s += 128) segs.push_back({s, 64, CRGB(255, 200, 180), 200});
+    CalibrationMap map;
+    for (size_t t = 0; t != len / 256; ++t) map.addRun(256, CRGB(250 - t, 240, 230 + t));
+    std::vector<uint8_t> wire(len * 3);
+    for (size_t i = 0; i != wire.size(); ++i) wire[i] = i * 7;
+
+    bench_report("plain load 1024", bench_us([&](){
+        uint32_t acc = 0;
+        for (size_t i = 0; i != wire.size(); ++i) acc += wire[i];
+        bench_sink += acc;
+    }, 2000), len);
+    bench_report("adjusted load 1024", bench_us([&](){
+        OutputAdjuster adj(&map, segs, rgbw_mode_t::min, neutral);
+        uint32_t acc = 0;
+        for (size_t i = 0; i != wire.size(); i += 3){
+            uint8_t b0 = wire[i], b1 = wire[i + 1], b2 = wire[i + 2];
+            acc += adj.apply(GRB, b0, b1, b2) + b0 + b1 + b2;
+        }
+        bench_sink += acc;
+    }, 2000), len);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_no_adjustments_is_identity);
+    RUN_TEST(test_segment_boundaries);
+    RUN_TEST(test_segments_with_calibration);
+    RUN_TEST(test_rgbw_modes);
+    RUN_TEST(test_cursor_run_boundaries);
+    RUN_TEST(test_empty_map);
+    RUN_TEST(test_set_tiles);
+    RUN_TEST(bench_adjuster);
+    return UNITY_END();
+}
@@ -0,0 +1,127 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// RGB to RGBW white channel extraction kernels
+#include <vector>
+#include <unity.h>
+#include "colormath.h"
+#include "bench.hpp"
+
+using color::rgbw_mode_t;
+
+void setUp(){}
+void tearDown(){}
+
+// walk RGB cube with a coarse step, calls f(r, g, b)
+template <typename F>
+static void rgb_cube(F &&f){
+    for (unsigned r = 0; r < 256; r += 15)
+        for (unsigned g = 0; g < 256; g += 15)
+            for (unsigned b = 0; b < 256; b += 15)
+                f(r, g, b);
+}
+
+void test_none_mode_keeps_rgb(){
+    color::WhitePoint wp;
+    rgb_cube([&](uint8_t r, uint8_t g, uint8_t b){
+        uint8_t r1 = r, g1 = g, b1 = b;
+        TEST_ASSERT_EQUAL_UINT8(0, color::rgb2rgbw(r1, g1, b1, rgbw_mode_t::none, wp));
+        TEST_ASSERT_EQUAL_UINT8(r, r1);
+        TEST_ASSERT_EQUAL_UINT8(g, g1);
+        TEST_ASSERT_EQUAL_UINT8(b, b1);
+    });
+}
+
+void test_min_mode_moves_common_part(){
+    rgb_cube([](uint8_t r, uint8_t g, uint8_t b){
+        uint8_t m = std::min(r, std::min(g, b));
+        uint8_t r1 = r, g1 = g, b1 = b;
+        uint8_t w = color::rgb2rgbw_min(r1, g1, b1);
+        TEST_ASSERT_EQUAL_UINT8(m, w);
+        TEST_ASSERT_EQUAL_UINT8(r - m, r1);
+        TEST_ASSERT_EQUAL_UINT8(g - m, g1);
+        TEST_ASSERT_EQUAL_UINT8(b - m, b1);
+    });
+}
+
+// neutral white LED should give exactly the same result as min method
+void test_whitepoint_neutral_matches_min(){
+    color::WhitePoint wp(255, 255, 255);
+    rgb_cube([&](uint8_t r, uint8_t g, uint8_t b){
+        uint8_t r1 = r, g1 = g, b1 = b, r2 = r, g2 = g, b2 = b;
+        TEST_ASSERT_EQUAL_UINT8(color::rgb2rgbw_min(r1, g1, b1), color::rgb2rgbw(r2, g2, b2, rgbw_mode_t::whitepoint, wp));
+        TEST_ASSERT_EQUAL_UINT8(r1, r2);
+        TEST_ASSERT_EQUAL_UINT8(g1, g2);
+        TEST_ASSERT_EQUAL_UINT8(b1, b2);
+    });
+}
+
+// tinted white LED: residual RGB plus white LED contribution reproduces original color
+// and white is maxed out, i.e. the limiting channel is (almost) emptied
+void test_whitepoint_tinted_reconstructs(){
+    color::WhitePoint wp(255, 200, 140);
+    rgb_cube([&](uint8_t r, uint8_t g, uint8_t b){
+        uint8_t r1 = r, g1 = g, b1 = b;
+        uint8_t w = color::rgb2rgbw_whitepoint(r1, g1, b1, wp);
+        TEST_ASSERT_LESS_OR_EQUAL(r, r1);
+        TEST_ASSERT_LESS_OR_EQUAL(g, g1);
+        TEST_ASSERT_LESS_OR_EQUAL(b, b1);
+        TEST_ASSERT_UINT8_WITHIN(2, r, r1 + ((w * (wp.r + 1)) >> 8));
+        TEST_ASSERT_UINT8_WITHIN(2, g, g1 + ((w * (wp.g + 1)) >> 8));
+        TEST_ASSERT_UINT8_WITHIN(2, b, b1 + ((w * (wp.b + 1)) >> 8));
+        if (w != 255)
+            TEST_ASSERT_LESS_OR_EQUAL(2, std::min(r1, std::min(g1, b1)));
+    });
+}
+
+// white LED with no blue component never takes blue channel over
+void test_whitepoint_zero_channel(){
+    color::WhitePoint wp(255, 255, 0);
+    uint8_t r = 100, g = 150, b = 200;
+    uint8_t w = color::rgb2rgbw_whitepoint(r, g, b, wp);
+    TEST_ASSERT_EQUAL_UINT8(100, w);
+    TEST_ASSERT_EQUAL_UINT8(0, r);
+    TEST_ASSERT_EQUAL_UINT8(50, g);
+    TEST_ASSERT_EQUAL_UINT8(200, b);
+}
+
+// extraction cost per pixel for a 64x64 canvas, compared to plain RGB copy
+void bench_rgbw_extraction(){
+    constexpr size_t len = 64 * 64;
+    std::vector<uint8_t> src(len * 3), dst(len * 4);
+    uint32_t seed = 1;
+    for (auto &c : src){ seed = seed * 1664525 + 1013904223; c = seed >> 24; }
+    color::WhitePoint wp(255, 200, 140);
+
+    auto run = [&](rgbw_mode_t mode){
+        return [&, mode](){
+            const uint8_t *s = src.data();
+            uint8_t *d = dst.data();
+            for (size_t i = 0; i != len; ++i, s += 3){
+                uint8_t r = s[0], g = s[1], b = s[2];
+                uint8_t w = color::rgb2rgbw(r, g, b, mode, wp);
+                *d++ = r; *d++ = g; *d++ = b;
+                if (mode != rgbw_mode_t::none) *d++ = w;
+            }
+            bench_sink = bench_sink + dst[len];
+        };
+    };
+    bench_report("rgb copy 64x64", bench_us(run(rgbw_mode_t::none), 2000), len);
+    bench_report("rgbw min 64x64", bench_us(run(rgbw_mode_t::min), 2000), len);
+    bench_report("rgbw whitepoint 64x64", bench_us(run(rgbw_mode_t::whitepoint), 2000), len);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_none_mode_keeps_rgb);
+    RUN_TEST(test_min_mode_moves_common_part);
+    RUN_TEST(test_whitepoint_neutral_matches_min);
+    RUN_TEST(test_whitepoint_tinted_reconstructs);
+    RUN_TEST(test_whitepoint_zero_channel);
+    RUN_TEST(bench_rgbw_extraction);
+    return UNITY_END();
+}
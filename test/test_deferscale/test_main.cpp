@@ -0,0 +1,155 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// deferred buffer scaling: unchecked access leaves pending scale alone,
+// loop entry points fold it once so results match operations on a folded buffer
+#include <unity.h>
+#include "ledcube.hpp"
+#include "bench.hpp"
+
+using axis_t = LedCube<CRGB>::axis_t;
+constexpr uint32_t scale_one = PixelDataBuffer<CRGB>::scale_one;
+
+static uint32_t seed;
+static uint32_t rnd(){ seed = seed * 1664525 + 1013904223; return seed >> 8; }
+
+static void random_fill(PixelDataBuffer<CRGB> &b){
+    for (auto &c : b) c = CRGB(rnd(), rnd(), rnd());
+}
+
+// copy of a buffer with it's pending scale applied
+static std::shared_ptr<PixelDataBuffer<CRGB>> folded(const PixelDataBuffer<CRGB> &b){
+    auto r = std::make_shared<PixelDataBuffer<CRGB>>(b.size());
+    for (size_t i = 0; i != b.size(); ++i) r->at(i) = b.output(i);
+    return r;
+}
+
+static void assert_same(PixelDataBuffer<CRGB> &a, PixelDataBuffer<CRGB> &b){
+    TEST_ASSERT_EQUAL(a.size(), b.size());
+    for (size_t i = 0; i != a.size(); ++i)
+        if (!(a.at(i) == b.at(i))){
+            char msg[64];
+            snprintf(msg, sizeof(msg), "pixel %u differs", static_cast<unsigned>(i));
+            TEST_FAIL_MESSAGE(msg);
+        }
+}
+
+void setUp(){ seed = 1; }
+void tearDown(){}
+
+void test_unchecked_does_not_fold(){
+    PixelDataBuffer<CRGB> b(16);
+    random_fill(b);
+    b.scaleDeferred(128);
+    uint32_t pending = b.deferredScale();
+    TEST_ASSERT_TRUE(pending != scale_one);
+
+    // stored value is returned as-is
+    CRGB stored = std::as_const(b).data()[3];
+    TEST_ASSERT_TRUE(b.at_unchecked(3) == stored);
+    b.at_unchecked(5) = CRGB(200, 100, 50);
+    TEST_ASSERT_EQUAL(pending, b.deferredScale());
+
+    // mutable access points fold
+    b.fold();
+    TEST_ASSERT_EQUAL(scale_one, b.deferredScale());
+    b.scaleDeferred(128);
+    b.span();
+    TEST_ASSERT_EQUAL(scale_one, b.deferredScale());
+    b.scaleDeferred(128);
+    b.begin();
+    TEST_ASSERT_EQUAL(scale_one, b.deferredScale());
+    b.scaleDeferred(128);
+    b.at(0);
+    TEST_ASSERT_EQUAL(scale_one, b.deferredScale());
+}
+
+void test_canvas_ops_fold(){
+    constexpr uint16_t w = 12, h = 7;
+    auto lb = std::make_shared<PixelDataBuffer<CRGB>>(w * h);
+    LedFB<CRGB> lazy(w, h, lb);
+    lazy.deferFade(true);
+
+    // scroll with fill color
+    random_fill(*lb);
+    lazy.fade(100);
+    TEST_ASSERT_TRUE(lb->deferredScale() != scale_one);
+    LedFB<CRGB> ref(w, h, folded(*lb));
+    lazy.scroll(3, -2, CRGB(255, 0, 0));
+    ref.scroll(3, -2, CRGB(255, 0, 0));
+    TEST_ASSERT_EQUAL(scale_one, lb->deferredScale());
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x)
+            TEST_ASSERT_TRUE(lazy.at(x, y) == ref.at(x, y));
+
+    // blit from a faded source
+    auto sb = std::make_shared<PixelDataBuffer<CRGB>>(5 * 4);
+    LedFB<CRGB> src(5, 4, sb);
+    src.deferFade(true);
+    random_fill(*sb);
+    src.fade(60);
+    LedFB<CRGB> src_ref(5, 4, folded(*sb));
+    lazy.blit(2, 1, src);
+    ref.blit(2, 1, src_ref);
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x)
+            TEST_ASSERT_TRUE(lazy.at(x, y) == ref.at(x, y));
+
+    // logical iterator reads pixels as they are output
+    lazy.fade(30);
+    auto it_ref = folded(*lb);
+    LedFB<CRGB> ref2(w, h, it_ref);
+    auto r = ref2.logical().begin();
+    for (auto &c : lazy.logical()){
+        TEST_ASSERT_TRUE(c == *r);
+        ++r;
+    }
+}
+
+void test_cube_ops_fold(){
+    LedCube<CRGB> cube(4, 3, 5, LedStripe(true), true);
+    auto cb = cube.getBuffer();
+    auto step = [&](auto &&op){
+        random_fill(*cb);
+        cb->scaleDeferred(90);
+        auto rb = folded(*cb);
+        LedCube<CRGB> ref(4, 3, 5, LedStripe(true), true, rb);
+        op(cube);
+        op(ref);
+        assert_same(*cb, *rb);
+    };
+    step([](LedCube<CRGB> &c){ c.at(1, 2, 3) += CRGB(10, 10, 10); });
+    step([](LedCube<CRGB> &c){ c.fillPlane(axis_t::y, 1, CRGB(0, 255, 0)); });
+    step([](LedCube<CRGB> &c){ c.shift(axis_t::z, 2, CRGB(0, 0, 255)); });
+    step([](LedCube<CRGB> &c){ c.slice(axis_t::x, 2)->fill(CRGB(7, 8, 9)); });
+    step([](LedCube<CRGB> &c){ c.slice(axis_t::z, 4)->dim(128); });
+}
+
+// per pixel read-modify-write loop over a faded 64x64 canvas, fold once + unchecked vs at()
+void bench_unchecked_loop(){
+    constexpr size_t len = 64 * 64;
+    PixelDataBuffer<CRGB> b(len);
+    random_fill(b);
+    bench_report("at() rmw 64x64", bench_us([&](){
+        b.scaleDeferred(250);
+        for (size_t i = 0; i != len; ++i) b.at(i) += CRGB(1, 1, 1);
+    }, 2000), len);
+    bench_report("fold + at_unchecked() rmw 64x64", bench_us([&](){
+        b.scaleDeferred(250);
+        b.fold();
+        for (size_t i = 0; i != len; ++i) b.at_unchecked(i) += CRGB(1, 1, 1);
+    }, 2000), len);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_unchecked_does_not_fold);
+    RUN_TEST(test_canvas_ops_fold);
+    RUN_TEST(test_cube_ops_fold);
+    RUN_TEST(bench_unchecked_loop);
+    return UNITY_END();
+}
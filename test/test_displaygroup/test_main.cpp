@@ -0,0 +1,106 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// multi-output display group
+#include <unity.h>
+#include "displaygroup.hpp"
+
+void setUp(){}
+void tearDown(){}
+
+// display engine that only counts show() calls
+template <class COLOR_TYPE>
+class TestEngine : public DisplayEngine<COLOR_TYPE> {
+    void engine_show() override { ++shows; }
+
+public:
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> buff;
+    int shows{0};
+
+    TestEngine(size_t len) : buff(std::make_shared<PixelDataBuffer<COLOR_TYPE>>(len)) {}
+    void doubleBuffer(bool active) override {}
+    void flipBuffer() override {}
+    bool toggleBuffer() override { return false; }
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> getBackBuffer() override { return buff; }
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> getActiveBuffer() override { return buff; }
+    void copyBack2Front() override {}
+    void copyFront2Back() override {}
+};
+
+void test_scaled_outputs(){
+    DisplayGroup g(8, 4);
+    auto e1 = std::make_shared<TestEngine<CRGB>>(32);
+    auto f1 = std::make_shared<LedFB<CRGB>>(8, 4, e1->buff);
+    auto e2 = std::make_shared<TestEngine<uint16_t>>(16 * 8);
+    auto f2 = std::make_shared<LedFB<uint16_t>>(16, 8, e2->buff);
+    g.addOutput<CRGB>(e1, f1);
+    g.addOutput<uint16_t>(e2, f2);
+
+    auto c = g.getCanvas();
+    c->at(7, 3) = CRGB(255, 0, 0);
+    g.show();
+    TEST_ASSERT_TRUE(f1->at(7, 3) == CRGB(255, 0, 0));
+    // 2x upscale covers 2x2 block
+    TEST_ASSERT_EQUAL_HEX32(0xf800, f2->at(14, 6));
+    TEST_ASSERT_EQUAL_HEX32(0xf800, f2->at(15, 7));
+    TEST_ASSERT_EQUAL_HEX32(0, f2->at(13, 7));
+
+    // only changed pixels are converted
+    c->at(7, 3) = CRGB(0, 0, 0);
+    g.show();
+    TEST_ASSERT_TRUE(f1->at(7, 3) == CRGB(0, 0, 0));
+    TEST_ASSERT_EQUAL_HEX32(0, f2->at(15, 7));
+    TEST_ASSERT_EQUAL(2, e1->shows);
+}
+
+// topology that maps outside of output buffer must not produce writes past it
+void test_unmapped_targets_dropped(){
+    DisplayGroup g(4, 4);
+    // output canvas is larger than it's buffer
+    auto e1 = std::make_shared<TestEngine<CRGB>>(8);
+    auto f1 = std::make_shared<LedFB<CRGB>>(4, 4, e1->buff);
+    // topology with unmapped column
+    auto e2 = std::make_shared<TestEngine<CRGB>>(16);
+    auto f2 = std::make_shared<LedFB<CRGB>>(4, 4, e2->buff);
+    f2->setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return x == 3 ? LedFB<CRGB>::npos : y * w + x; });
+    g.addOutput<CRGB>(e1, f1);
+    g.addOutput<CRGB>(e2, f2);
+
+    g.getCanvas()->fill(CRGB(9, 9, 9));
+    g.show();
+    TEST_ASSERT_EQUAL(9, e1->buff->at(7).r);
+    TEST_ASSERT_EQUAL(9, e2->buff->at(2).r);
+    TEST_ASSERT_EQUAL(0, e2->buff->at(3).r);
+}
+
+// deferred canvas fades must reach outputs
+void test_deferred_fade_reaches_outputs(){
+    DisplayGroup g(4, 2);
+    auto e1 = std::make_shared<TestEngine<CRGB>>(8);
+    auto f1 = std::make_shared<LedFB<CRGB>>(4, 2, e1->buff);
+    g.addOutput<CRGB>(e1, f1);
+    auto c = g.getCanvas();
+    c->deferFade(true);
+    c->fill(CRGB(200, 100, 50));
+    g.show();
+    TEST_ASSERT_TRUE(f1->at(3, 1) == CRGB(200, 100, 50));
+
+    c->fade(128);
+    g.show();
+    CRGB e(200, 100, 50);
+    e.nscale8(127);
+    TEST_ASSERT_TRUE(f1->at(0, 0) == e);
+    TEST_ASSERT_TRUE(f1->at(3, 1) == e);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_scaled_outputs);
+    RUN_TEST(test_unmapped_targets_dropped);
+    RUN_TEST(test_deferred_fade_reaches_outputs);
+    return UNITY_END();
+}
@@ -0,0 +1,74 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// DisplayEngine frame interpolation
+#include <unity.h>
+#include "ledfb.hpp"
+
+void setUp(){ mock_ms = 0; }
+void tearDown(){}
+
+// display engine over a single buffer
+class TestEngine : public DisplayEngine<CRGB> {
+    void engine_show() override { ++shows; }
+
+public:
+    std::shared_ptr<PixelDataBuffer<CRGB>> buff;
+    int shows{0};
+
+    TestEngine(size_t len) : buff(len ? std::make_shared<PixelDataBuffer<CRGB>>(len) : nullptr) {}
+    void doubleBuffer(bool active) override {}
+    void flipBuffer() override {}
+    bool toggleBuffer() override { return false; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getBackBuffer() override { return buff; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getActiveBuffer() override { return buff; }
+    void copyBack2Front() override {}
+    void copyFront2Back() override {}
+};
+
+void test_begin_frame_without_interpolation(){
+    TestEngine e(4);
+    TEST_ASSERT_FALSE(e.interpolate());
+    // frame is drawn directly to active buffer
+    TEST_ASSERT_TRUE(&e.beginFrame() == e.buff.get());
+    e.commitFrame();
+
+    // no buffer at all
+    TestEngine n(0);
+    n.interpolate(true);
+    TEST_ASSERT_FALSE(n.interpolate());
+    TEST_ASSERT_EQUAL(0, n.beginFrame().size());
+    TEST_ASSERT_NULL(n.getFrameBuffer().get());
+}
+
+void test_interpolated_frames_blend(){
+    TestEngine e(4);
+    e.interpolate(true);
+    TEST_ASSERT_TRUE(e.interpolate());
+    LedFB<CRGB> fx(2, 2, e.getFrameBuffer());
+    e.commitFrame();
+
+    mock_ms += 40;
+    TEST_ASSERT_TRUE(&e.beginFrame() != e.buff.get());
+    fx.fill(CRGB(200, 0, 0));
+    e.commitFrame();
+
+    // halfway through measured frame interval output is a half blend, then it reaches the frame
+    mock_ms += 20;
+    e.show();
+    TEST_ASSERT_UINT8_WITHIN(2, 100, e.buff->at(0).r);
+    mock_ms += 20;
+    e.show();
+    TEST_ASSERT_UINT8_WITHIN(1, 200, e.buff->at(3).r);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_frame_without_interpolation);
+    RUN_TEST(test_interpolated_frames_blend);
+    return UNITY_END();
+}
@@ -0,0 +1,164 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// execution policy aware buffer operations: results must match serial ones,
+// benchmarks show scaling across buffer sizes and thread counts and justify LEDFB_PAR_THRESHOLD
+#include <unity.h>
+#include <thread>
+#include "ledcube.hpp"
+#include "bench.hpp"
+// libstdc++ parallel backend, thread count could be limited only with TBB
+#ifdef _PSTL_PAR_BACKEND_TBB
+  #include <tbb/global_control.h>
+  #define TEST_WITH_TBB
+#endif
+
+void setUp(){}
+void tearDown(){}
+
+#ifdef LEDFB_WITH_EXECUTION
+static void random_fill(PixelDataBuffer<CRGB> &b, uint32_t seed){
+    for (auto &c : b.data()){
+        seed = seed * 1664525 + 1013904223;
+        c = CRGB(seed >> 8);
+    }
+}
+
+// sizes on both sides of LEDFB_PAR_THRESHOLD
+static const size_t sizes[] = {LEDFB_PAR_THRESHOLD / 4, LEDFB_PAR_THRESHOLD, LEDFB_PAR_THRESHOLD * 4, LEDFB_PAR_THRESHOLD * 16};
+
+void test_policies_match_serial(){
+    for (size_t len : sizes){
+        PixelDataBuffer<CRGB> a(len), b(len), s(len), p(len);
+        random_fill(a, 1);
+        random_fill(b, 2);
+
+        s.lerp(a, b, 100);
+        p.lerp(std::execution::par_unseq, a, b, 100);
+        TEST_ASSERT_EQUAL_MEMORY(s.data().data(), p.data().data(), len * sizeof(CRGB));
+
+        for (auto &c : s.data()) c.nscale8(77);
+        p.for_each(std::execution::par, [](CRGB &c){ c.nscale8(77); });
+        TEST_ASSERT_EQUAL_MEMORY(s.data().data(), p.data().data(), len * sizeof(CRGB));
+
+        p.fill(std::execution::par_unseq, CRGB(1, 2, 3));
+        TEST_ASSERT_TRUE(p.at(0) == CRGB(1, 2, 3));
+        TEST_ASSERT_TRUE(p.at(len - 1) == CRGB(1, 2, 3));
+    }
+}
+
+void test_rgb565_lerp_matches_serial(){
+    const size_t len = LEDFB_PAR_THRESHOLD * 2 + 7;
+    PixelDataBuffer<uint16_t> a(len), b(len), s(len), p(len);
+    for (size_t i = 0; i != len; ++i){ a.data()[i] = i * 2654435761u; b.data()[i] = i * 40503u; }
+    s.lerp(a, b, 180);
+    p.lerp(std::execution::par_unseq, a, b, 180);
+    TEST_ASSERT_EQUAL_MEMORY(s.data().data(), p.data().data(), len * sizeof(uint16_t));
+}
+
+void test_canvas_dim_matches_serial(){
+    auto sb = std::make_shared<PixelDataBuffer<CRGB>>(256 * 256), pb = std::make_shared<PixelDataBuffer<CRGB>>(256 * 256);
+    random_fill(*sb, 3);
+    random_fill(*pb, 3);
+    LedFB<CRGB> s(256, 256, sb), p(256, 256, pb);
+    s.deferFade(false);
+    p.deferFade(false);
+    s.dim(120);
+    p.dim(std::execution::par_unseq, 120);
+    TEST_ASSERT_EQUAL_MEMORY(sb->data().data(), pb->data().data(), 256 * 256 * sizeof(CRGB));
+}
+
+void test_canvas_policy_overloads_honor_overrides(){
+    // deferred fade is accumulated, pixel data is not touched
+    auto pb = std::make_shared<PixelDataBuffer<CRGB>>(256 * 256), sb = std::make_shared<PixelDataBuffer<CRGB>>(256 * 256);
+    random_fill(*pb, 4);
+    random_fill(*sb, 4);
+    LedFB<CRGB> p(256, 256, pb), s(256, 256, sb);
+    p.deferFade(true);
+    s.deferFade(true);
+    p.fade(std::execution::par_unseq, 30);
+    p.dim(std::execution::par, 200);
+    s.fade(30);
+    s.dim(200);
+    TEST_ASSERT_TRUE(pb->deferredScale() != PixelDataBuffer<CRGB>::scale_one);
+    TEST_ASSERT_EQUAL(sb->deferredScale(), pb->deferredScale());
+    p.deferFade(false);
+    s.deferFade(false);
+    TEST_ASSERT_EQUAL_MEMORY(sb->data().data(), pb->data().data(), 256 * 256 * sizeof(CRGB));
+
+    // cube is large enough for parallel processing, slice operations still touch slice pixels only
+    LedCube<CRGB> cube(32, 32, 32, LedStripe(true));
+    TEST_ASSERT_TRUE(cube.size() >= LEDFB_PAR_THRESHOLD);
+    cube.getBuffer()->fill(CRGB(100, 100, 100));
+    auto top = cube.slice(LedCube<CRGB>::axis_t::z, 31), side = cube.slice(LedCube<CRGB>::axis_t::x, 0);
+    top->fill(std::execution::par_unseq, CRGB(255, 0, 0));
+    side->dim(std::execution::par, 128);
+    auto front = cube.slice(LedCube<CRGB>::axis_t::y, 0);
+    front->clear(std::execution::par_unseq);
+    front->fill(std::execution::par, CRGB(0, 0, 255));
+    front->fade(std::execution::par_unseq, 127);
+    for (unsigned z = 0; z != 32; ++z)
+        for (unsigned y = 0; y != 32; ++y)
+            for (unsigned x = 0; x != 32; ++x){
+                CRGB e = z == 31 ? CRGB(255, 0, 0) : CRGB(100, 100, 100);
+                if (x == 0) e.nscale8(128);
+                if (y == 0){ e = CRGB(0, 0, 255); e.nscale8(128); }
+                TEST_ASSERT_TRUE(cube.at(x, y, z) == e);
+            }
+}
+
+// lerp and per-pixel scale across buffer sizes, serial vs parallel policies
+static void bench_sizes(){
+    char name[80];
+    for (size_t len : sizes){
+        PixelDataBuffer<CRGB> a(len), b(len), d(len);
+        random_fill(a, 1);
+        random_fill(b, 2);
+        unsigned runs = 64 * LEDFB_PAR_THRESHOLD / len + 4;
+
+        snprintf(name, sizeof(name), "lerp seq %zu px", len);
+        bench_report(name, bench_us([&](){ d.lerp(a, b, 100); }, runs), len);
+        snprintf(name, sizeof(name), "lerp par_unseq %zu px", len);
+        bench_report(name, bench_us([&](){ d.lerp(std::execution::par_unseq, a, b, 100); }, runs), len);
+
+        snprintf(name, sizeof(name), "for_each seq %zu px", len);
+        bench_report(name, bench_us([&](){ for (auto &c : d.data()) c.nscale8(250); }, runs), len);
+        snprintf(name, sizeof(name), "for_each par %zu px", len);
+        bench_report(name, bench_us([&](){ d.for_each(std::execution::par, [](CRGB &c){ c.nscale8(250); }); }, runs), len);
+        bench_sink = bench_sink + d.at(0).r;
+    }
+}
+
+void bench_policy_scaling(){
+#ifdef TEST_WITH_TBB
+    // limit worker threads to see how operations scale with core count
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 1; t <= hw; t *= 2){
+        tbb::global_control limit(tbb::global_control::max_allowed_parallelism, t);
+        char msg[48];
+        snprintf(msg, sizeof(msg), "threads: %u", t);
+        TEST_MESSAGE(msg);
+        bench_sizes();
+    }
+#else
+    TEST_MESSAGE("standard library parallel backend is not available, parallel policies run serially");
+    bench_sizes();
+#endif
+}
+#endif  // LEDFB_WITH_EXECUTION
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+#ifdef LEDFB_WITH_EXECUTION
+    RUN_TEST(test_policies_match_serial);
+    RUN_TEST(test_rgb565_lerp_matches_serial);
+    RUN_TEST(test_canvas_dim_matches_serial);
+    RUN_TEST(test_canvas_policy_overloads_honor_overrides);
+    RUN_TEST(bench_policy_scaling);
+#endif
+    return UNITY_END();
+}
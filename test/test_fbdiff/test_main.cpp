@@ -0,0 +1,156 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// changed runs detection, compared to a naive per-pixel scan
+#include <unity.h>
+#include "fbdiff.hpp"
+#include "bench.hpp"
+
+void setUp(){}
+void tearDown(){}
+
+static constexpr size_t W = 128, H = 128, LEN = W * H;
+
+// naive reference: per-pixel compare, runs broken on row boundaries, then merged over gaps
+template <class T>
+static size_t naive_diff(const T *a, const T *b, size_t count, std::vector<diff_run_t> &runs, size_t row_len, size_t merge_gap){
+    size_t changed = 0;
+    const size_t first = runs.size();
+    for (size_t i = 0; i != count; ++i){
+        if (a[i] == b[i]) continue;
+        bool cont = i && a[i - 1] != b[i - 1] && (!row_len || i % row_len);
+        if (runs.size() > first && (cont || i - (runs.back().start + runs.back().len) <= merge_gap)){
+            changed += i + 1 - (runs.back().start + runs.back().len);
+            runs.back().len = i + 1 - runs.back().start;
+        } else {
+            runs.push_back({static_cast<uint32_t>(i), 1});
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+// change approximately 'permille' of pixels, in short clusters like sprites do
+static void scatter(PixelDataBuffer<CRGB> &b, unsigned permille, uint32_t seed){
+    for (size_t i = 0; i < LEN; ++i){
+        seed = seed * 1664525 + 1013904223;
+        if ((seed >> 16) % 1000 < permille) b.data()[i] += CRGB(1, 2, 3);
+    }
+}
+
+static bool same_runs(const std::vector<diff_run_t> &x, const std::vector<diff_run_t> &y){
+    if (x.size() != y.size()) return false;
+    for (size_t i = 0; i != x.size(); ++i)
+        if (x[i].start != y[i].start || x[i].len != y[i].len) return false;
+    return true;
+}
+
+void test_matches_naive_scan(){
+    for (unsigned permille : {0u, 5u, 100u, 300u, 500u, 900u, 1000u}){
+        for (size_t gap : {size_t(0), size_t(3)}){
+            for (size_t row : {size_t(0), W}){
+                PixelDataBuffer<CRGB> a(LEN), b(LEN);
+                scatter(b, permille, permille + 1);
+                std::vector<diff_run_t> r, n;
+                size_t c = buffer_diff(a, b, r, row, gap);
+                TEST_ASSERT_EQUAL(naive_diff(a.data().data(), b.data().data(), LEN, n, row, gap), c);
+                TEST_ASSERT_TRUE(same_runs(n, r));
+            }
+        }
+    }
+}
+
+// dense changes switch to a per-pixel scan midway through a row, results are the same for any pixel size
+template <class T>
+static void check_pixel_size(){
+    for (unsigned permille : {100u, 500u, 900u}){
+        std::vector<T> a(LEN), b(LEN);
+        uint32_t seed = permille;
+        for (auto &p : b){
+            seed = seed * 1664525 + 1013904223;
+            if ((seed >> 16) % 1000 < permille) p = static_cast<T>(seed | 1);
+        }
+        for (size_t row : {size_t(0), W}){
+            std::vector<diff_run_t> r, n;
+            size_t c = buffer_diff(a.data(), b.data(), LEN, sizeof(T), r, row, 1);
+            TEST_ASSERT_EQUAL(naive_diff(a.data(), b.data(), LEN, n, row, 1), c);
+            TEST_ASSERT_TRUE(same_runs(n, r));
+        }
+    }
+}
+
+void test_dense_pixel_sizes(){
+    check_pixel_size<uint16_t>();
+    check_pixel_size<uint32_t>();
+    check_pixel_size<uint64_t>();
+}
+
+// runs appended by a previous call must not be merged with, nor produce a wrapped around gap
+void test_append_keeps_previous_runs(){
+    PixelDataBuffer<CRGB> a(64), b(64);
+    b.data()[10] = CRGB(1, 1, 1);
+    b.data()[12] = CRGB(1, 1, 1);
+    std::vector<diff_run_t> runs{{100, 5}};
+    TEST_ASSERT_EQUAL(3, buffer_diff(a, b, runs, 0, 4));
+    TEST_ASSERT_EQUAL(2, runs.size());
+    TEST_ASSERT_EQUAL(100, runs[0].start);
+    TEST_ASSERT_EQUAL(5, runs[0].len);
+    TEST_ASSERT_EQUAL(10, runs[1].start);
+    TEST_ASSERT_EQUAL(3, runs[1].len);
+
+    // a run right before new ones is not merged either
+    runs.assign({{8, 1}});
+    TEST_ASSERT_EQUAL(3, buffer_diff(a, b, runs, 0, 4));
+    TEST_ASSERT_EQUAL(2, runs.size());
+    TEST_ASSERT_EQUAL(8, runs[0].start);
+    TEST_ASSERT_EQUAL(1, runs[0].len);
+}
+
+void test_frame_diff_snapshot(){
+    PixelDataBuffer<CRGB> b(LEN);
+    FrameDiff<CRGB> d(W);
+    TEST_ASSERT_EQUAL(1, d.update(b).size());
+    TEST_ASSERT_EQUAL(LEN, d.changed());
+    TEST_ASSERT_EQUAL(0, d.update(b).size());
+    b.data()[W + 5] = CRGB(9, 9, 9);
+    TEST_ASSERT_EQUAL(1, d.update(b).size());
+    TEST_ASSERT_EQUAL(W + 5, d.runs()[0].start);
+    TEST_ASSERT_EQUAL(0, d.update(b).size());
+
+    // pending deferred scale is folded, faded pixels are reported
+    b.scaleDeferred(128);
+    TEST_ASSERT_EQUAL(1, d.update(b).size());
+    TEST_ASSERT_EQUAL(1, d.changed());
+    TEST_ASSERT_EQUAL(PixelDataBuffer<CRGB>::scale_one, b.deferredScale());
+}
+
+// diff cost across change ratios, compared to naive per-pixel scan.
+// Word-wise skipping wins while unchanged spans are longer than a few pixels, i.e. up to ~30% of randomly changed pixels,
+// denser rows fall back to per-pixel scan after LEDFB_DIFF_DENSE_PROBE spans and run at about naive scan speed
+void bench_change_ratio(){
+    char name[64];
+    std::vector<diff_run_t> runs;
+    runs.reserve(LEN);
+    for (unsigned permille : {0u, 1u, 10u, 100u, 300u, 500u, 900u, 1000u}){
+        PixelDataBuffer<CRGB> a(LEN), b(LEN);
+        scatter(b, permille, 7);
+        snprintf(name, sizeof(name), "buffer_diff %.1f%% changed", permille / 10.0);
+        bench_report(name, bench_us([&](){ runs.clear(); bench_sink = bench_sink + buffer_diff(a, b, runs, W, 2); }, 500), LEN);
+        snprintf(name, sizeof(name), "naive scan %.1f%% changed", permille / 10.0);
+        bench_report(name, bench_us([&](){ runs.clear(); bench_sink = bench_sink + naive_diff(a.data().data(), b.data().data(), LEN, runs, W, 2); }, 500), LEN);
+    }
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_naive_scan);
+    RUN_TEST(test_dense_pixel_sizes);
+    RUN_TEST(test_append_keeps_previous_runs);
+    RUN_TEST(test_frame_diff_snapshot);
+    RUN_TEST(bench_change_ratio);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// fused buffer operations, SWAR kernels vs scalar ops
+#include <unity.h>
+#include "fbexpr.hpp"
+#include "bench.hpp"
+
+using namespace fbexpr;
+
+static uint32_t seed;
+static uint32_t rnd(){ seed = seed * 1664525 + 1013904223; return seed >> 8; }
+static CRGB rnd_color(){ return CRGB(rnd(), rnd(), rnd()); }
+
+void setUp(){ seed = 1; }
+void tearDown(){}
+
+// run a word kernel over all byte pairs, each pair is placed in every lane of a word along with random neighbours
+template <typename W, typename B>
+static void check_kernel(W &&word, B &&byte){
+    for (unsigned x = 0; x != 256; ++x)
+        for (unsigned y = 0; y != 256; ++y){
+            uint32_t r = rnd() << 8 ^ rnd(), s = rnd() << 8 ^ rnd();
+            for (unsigned lane = 0; lane != 4; ++lane){
+                uint32_t wx = (r & ~(0xffu << lane * 8)) | x << lane * 8;
+                uint32_t wy = (s & ~(0xffu << lane * 8)) | y << lane * 8;
+                uint32_t w = word(wx, wy);
+                for (unsigned k = 0; k != 4; ++k)
+                    if ((w >> k * 8 & 0xff) != byte(wx >> k * 8 & 0xff, wy >> k * 8 & 0xff)){
+                        char msg[96];
+                        snprintf(msg, sizeof(msg), "x=%08x y=%08x lane %u: %08x", wx, wy, k, w);
+                        TEST_FAIL_MESSAGE(msg);
+                    }
+            }
+        }
+}
+
+void test_add_sub_kernels(){
+    add_op add;
+    sub_op sub;
+    check_kernel([&](uint32_t x, uint32_t y){ return add.word(x, y); }, [](unsigned x, unsigned y){ return x + y > 255 ? 255 : x + y; });
+    check_kernel([&](uint32_t x, uint32_t y){ return sub.word(x, y); }, [](unsigned x, unsigned y){ return x > y ? x - y : 0; });
+}
+
+void test_blend_scale_kernels(){
+    for (unsigned amount : {0, 1, 127, 128, 254, 255}){
+        blend_op b{static_cast<uint16_t>(256 - amount), static_cast<uint16_t>(amount)};
+        check_kernel([&](uint32_t x, uint32_t y){ return b.word(x, y); }, [&](unsigned x, unsigned y){ return (x * (256 - amount) + y * amount) >> 8; });
+    }
+    // scale is unary, words are fed through a 4 pixel buffer operand and y is ignored
+    uint8_t px[12];
+    buffer_t b(reinterpret_cast<const CRGB*>(px), 4);
+    for (unsigned s : {0, 1, 128, 255, 256}){
+        scale_t<buffer_t> node(b, s);
+        check_kernel([&](uint32_t x, uint32_t){ memcpy(px, &x, 4); return node.word(0); }, [&](unsigned x, unsigned){ return node.op(x); });
+    }
+}
+
+// chained passes evaluated pixel by pixel
+static std::vector<CRGB> reference(const std::vector<CRGB> &a, const std::vector<CRGB> &l, const std::vector<CRGB> &g, uint8_t f, uint8_t amount){
+    std::vector<CRGB> r(a);
+    for (size_t i = 0; i != r.size(); ++i){
+        CRGB c = a[i];
+        c.nscale8(255 - f);
+        // blend is a + (b - a) * amount / 256 with exact lerp8_buffer() rounding
+        CRGB bl(((c.r * (256 - amount)) + l[i].r * amount) >> 8, ((c.g * (256 - amount)) + l[i].g * amount) >> 8, ((c.b * (256 - amount)) + l[i].b * amount) >> 8);
+        bl += g[i];
+        r[i] = bl;
+    }
+    return r;
+}
+
+void test_fused_expression(){
+    // odd lengths leave a byte tail after 4 byte words
+    for (size_t len : {1, 2, 3, 5, 64, 67}){
+        std::vector<CRGB> a(len), l(len), g(len);
+        for (size_t i = 0; i != len; ++i){ a[i] = rnd_color(); l[i] = rnd_color(); g[i] = rnd_color(); }
+        PixelDataBuffer<CRGB> canvas(len), layer(len), glow(len);
+        std::copy(a.begin(), a.end(), canvas.begin());
+        std::copy(l.begin(), l.end(), layer.begin());
+        std::copy(g.begin(), g.end(), glow.begin());
+
+        // destination is an operand too
+        canvas = blend(fade(src(canvas), 20), layer, 128) + glow;
+        auto r = reference(a, l, g, 20, 128);
+        TEST_ASSERT_EQUAL_MEMORY(r.data(), canvas.data().data(), len * sizeof(CRGB));
+    }
+}
+
+void test_solid_and_sub(){
+    PixelDataBuffer<CRGB> a(7), out(7);
+    for (auto &c : a) c = rnd_color();
+    // solid color falls back to per pixel loop, channels differ
+    out = src(a) - CRGB(10, 200, 0);
+    for (size_t i = 0; i != 7; ++i){
+        CRGB e(qsub8(a.at(i).r, 10), qsub8(a.at(i).g, 200), a.at(i).b);
+        TEST_ASSERT_TRUE(out.at(i) == e);
+    }
+    out = scale(src(a), 127) + CRGB(1, 2, 3);
+    for (size_t i = 0; i != 7; ++i){
+        CRGB e(a.at(i));
+        e.nscale8(127);
+        e += CRGB(1, 2, 3);
+        TEST_ASSERT_TRUE(out.at(i) == e);
+    }
+}
+
+void test_deferred_scale(){
+    PixelDataBuffer<CRGB> a(8), b(8), out(12);
+    for (auto &c : a) c = CRGB(200, 100, 50);
+    for (auto &c : b) c = CRGB(10, 10, 10);
+    a.scaleDeferred(128);
+    // mutable operand is folded before it's read
+    out = src(a) + b;
+    CRGB e(200, 100, 50);
+    e.nscale8(128);
+    e += CRGB(10, 10, 10);
+    TEST_ASSERT_TRUE(out.at(0) == e);
+
+    // destination longer than expression keeps its pending scale on the tail
+    for (auto &c : out) c = CRGB(100, 100, 100);
+    out.scaleDeferred(64);
+    out = src(b);
+    TEST_ASSERT_TRUE(out.at(0) == CRGB(10, 10, 10));
+    CRGB t(100, 100, 100);
+    t.nscale8(64);
+    TEST_ASSERT_TRUE(out.at(11) == t);
+}
+
+// fade + blend + add over a 64x64 canvas, fused SWAR expression vs three separate passes
+void bench_fused_vs_passes(){
+    constexpr size_t len = 64 * 64;
+    PixelDataBuffer<CRGB> canvas(len), layer(len), glow(len);
+    for (size_t i = 0; i != len; ++i){ canvas.at(i) = rnd_color(); layer.at(i) = rnd_color(); glow.at(i) = rnd_color(); }
+    PixelDataBuffer<CRGB> c2(canvas);
+
+    bench_report("fused fade+blend+add 64x64", bench_us([&](){ canvas = blend(fade(src(canvas), 20), layer, 128) + glow; }, 2000), len);
+    bench_report("passes fade+blend+add 64x64", bench_us([&](){
+        for (auto &c : c2) c.nscale8(235);
+        for (size_t i = 0; i != len; ++i) nblend(c2.at_unchecked(i), layer.at_unchecked(i), 128);
+        for (size_t i = 0; i != len; ++i) c2.at_unchecked(i) += glow.at_unchecked(i);
+    }, 2000), len);
+    bench_report("per-pixel fused 64x64", bench_us([&](){
+        // same expression with a solid operand forces the per-pixel path
+        canvas = blend(fade(src(canvas), 20), layer, 128) + CRGB(1, 1, 1);
+    }, 2000), len);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_add_sub_kernels);
+    RUN_TEST(test_blend_scale_kernels);
+    RUN_TEST(test_fused_expression);
+    RUN_TEST(test_solid_and_sub);
+    RUN_TEST(test_deferred_scale);
+    RUN_TEST(bench_fused_vs_passes);
+    return UNITY_END();
+}
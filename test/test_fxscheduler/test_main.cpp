@@ -0,0 +1,192 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// coroutine effect scheduler, needs C++20
+//   pio test -e native_cpp20 -f test_fxscheduler
+#include <unity.h>
+#include "fxscheduler.hpp"
+
+void setUp(){}
+void tearDown(){}
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+// display engine over a single buffer that counts show() calls
+class TestEngine : public DisplayEngine<CRGB> {
+    void engine_show() override { ++shows; }
+
+public:
+    std::shared_ptr<PixelDataBuffer<CRGB>> buff;
+    int shows{0};
+
+    TestEngine(size_t len) : buff(std::make_shared<PixelDataBuffer<CRGB>>(len)) {}
+    void doubleBuffer(bool active) override {}
+    void flipBuffer() override {}
+    bool toggleBuffer() override { return false; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getBackBuffer() override { return buff; }
+    std::shared_ptr<PixelDataBuffer<CRGB>> getActiveBuffer() override { return buff; }
+    void copyBack2Front() override {}
+    void copyFront2Back() override {}
+};
+
+// toggles a pixel every 'ms' milliseconds, 'count' times
+EffectTask blink(LedFB<CRGB> &fb, int16_t x, uint32_t ms, int count){
+    for (int i = 0; i != count; ++i){
+        fb.at(x, 0) = i & 1 ? CRGB::Black : CRGB::Red;
+        co_await sleep_for(ms);
+    }
+}
+
+// counts frame ticks
+EffectTask ticker(int &ticks){
+    for (;;){
+        ++ticks;
+        co_await next_frame();
+    }
+}
+
+// spawns a child effect from a running effect
+EffectTask parent(EffectScheduler<CRGB> &sched, int &ticks){
+    co_await next_frame();
+    sched.spawn(ticker(ticks));
+}
+
+// keeps a frame larger than a pool block alive across a suspension
+EffectTask big_frame(int &sum){
+    volatile uint8_t scratch[LEDFB_CORO_BLOCK_SIZE * 2];
+    for (size_t i = 0; i != sizeof(scratch); ++i) scratch[i] = i;
+    co_await next_frame();
+    for (size_t i = 0; i != sizeof(scratch); ++i) sum += scratch[i];
+}
+
+void test_sleep_and_frames(){
+    auto engine = std::make_shared<TestEngine>(4);
+    LedFB<CRGB> fb(4, 1, engine->buff);
+    EffectScheduler<CRGB> sched(engine, 20);
+    int ticks = 0;
+    sched.spawn(blink(fb, 0, 100, 3));
+    sched.spawn(ticker(ticks));
+    TEST_ASSERT_EQUAL(2, sched.size());
+
+    // both effects run on the first call
+    TEST_ASSERT_TRUE(sched.run(0));
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Red));
+    TEST_ASSERT_EQUAL(1, ticks);
+    TEST_ASSERT_EQUAL(1, engine->shows);
+
+    // nothing is due before next frame interval
+    TEST_ASSERT_FALSE(sched.run(10));
+    TEST_ASSERT_EQUAL(1, engine->shows);
+
+    // frame tick resumes the ticker only
+    TEST_ASSERT_TRUE(sched.run(20));
+    TEST_ASSERT_EQUAL(2, ticks);
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Red));
+
+    // sleeping effect wakes up on it's deadline, even between frame ticks
+    TEST_ASSERT_TRUE(sched.run(99));
+    TEST_ASSERT_EQUAL(3, ticks);
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Red));
+    TEST_ASSERT_TRUE(sched.run(100));
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Black));
+    TEST_ASSERT_EQUAL(3, ticks);
+    TEST_ASSERT_EQUAL(2, sched.size());
+
+    // blink finishes after it's last sleep and is dropped
+    sched.run(200);
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Red));
+    sched.run(300);
+    TEST_ASSERT_EQUAL(1, sched.size());
+
+    sched.clear();
+    TEST_ASSERT_EQUAL(0, sched.size());
+    TEST_ASSERT_FALSE(sched.run(400));
+}
+
+void test_spawn_from_effect(){
+    EffectScheduler<CRGB> sched(nullptr, 10);
+    int ticks = 0;
+    sched.spawn(parent(sched, ticks));
+    sched.run(0);
+    TEST_ASSERT_EQUAL(1, sched.size());
+
+    // child is added while parent runs, but starts on the next call
+    sched.run(10);
+    TEST_ASSERT_EQUAL(1, sched.size());
+    TEST_ASSERT_EQUAL(0, ticks);
+    sched.run(20);
+    TEST_ASSERT_EQUAL(1, ticks);
+
+    // empty tasks are not scheduled
+    sched.spawn(EffectTask());
+    TEST_ASSERT_EQUAL(1, sched.size());
+}
+
+void test_timer_wraparound(){
+    EffectScheduler<CRGB> sched(nullptr, 20);
+    LedFB<CRGB> fb(1, 1);
+    uint32_t t0 = UINT32_MAX - 50;
+    sched.spawn(blink(fb, 0, 100, 2));
+    sched.run(t0);
+    // deadline is past the millis() wrap
+    TEST_ASSERT_FALSE(sched.run(t0 + 99));
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Red));
+    TEST_ASSERT_TRUE(sched.run(t0 + 100));
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(CRGB::Black));
+}
+
+void test_frame_pool_fallback(){
+    auto &pool = CoroFramePool::instance();
+    EffectScheduler<CRGB> sched(nullptr, 10);
+    std::vector<int> ticks(LEDFB_CORO_POOL_BLOCKS + 2);
+
+    // pool serves up to LEDFB_CORO_POOL_BLOCKS frames, then effects go to heap
+    size_t fb = pool.fallbacks();
+    for (size_t i = 0; i != LEDFB_CORO_POOL_BLOCKS; ++i) sched.spawn(ticker(ticks[i]));
+    TEST_ASSERT_EQUAL(fb, pool.fallbacks());
+    sched.spawn(ticker(ticks[LEDFB_CORO_POOL_BLOCKS]));
+    sched.spawn(ticker(ticks[LEDFB_CORO_POOL_BLOCKS + 1]));
+    TEST_ASSERT_EQUAL(fb + 2, pool.fallbacks());
+    TEST_ASSERT_EQUAL(LEDFB_CORO_POOL_BLOCKS + 2, sched.size());
+
+    // heap and pool frames run alike
+    sched.run(0);
+    for (auto t : ticks) TEST_ASSERT_EQUAL(1, t);
+
+    // released blocks are reused
+    sched.clear();
+    fb = pool.fallbacks();
+    for (size_t i = 0; i != LEDFB_CORO_POOL_BLOCKS; ++i) sched.spawn(ticker(ticks[i]));
+    TEST_ASSERT_EQUAL(fb, pool.fallbacks());
+    sched.clear();
+
+    // frames larger than a block are allocated from heap
+    int sum = 0;
+    sched.spawn(big_frame(sum));
+    TEST_ASSERT_EQUAL(fb + 1, pool.fallbacks());
+    sched.run(100);
+    sched.run(110);
+    TEST_ASSERT_EQUAL(0, sched.size());
+    int expect = 0;
+    for (size_t i = 0; i != LEDFB_CORO_BLOCK_SIZE * 2; ++i) expect += static_cast<uint8_t>(i);
+    TEST_ASSERT_EQUAL(expect, sum);
+}
+
+#endif  // __cplusplus >= 202002L
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+    RUN_TEST(test_sleep_and_frames);
+    RUN_TEST(test_spawn_from_effect);
+    RUN_TEST(test_timer_wraparound);
+    RUN_TEST(test_frame_pool_fallback);
+#else
+    TEST_MESSAGE("fxscheduler needs C++20, run with native_cpp20 env");
+#endif
+    return UNITY_END();
+}
@@ -0,0 +1,329 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// bytecode VM: assembler, loader validation, step budget and effects vs equivalent native loops
+#include <unity.h>
+#include "fxvm.hpp"
+#include "bench.hpp"
+
+using op_t = FxVM::op_t;
+
+void setUp(){}
+void tearDown(){}
+
+static bool load_src(FxVM &vm, const char *src){
+    std::vector<uint8_t> code;
+    FxVM::asm_error_t e{0, nullptr};
+    if (!FxVM::assemble(src, code, &e)){
+        TEST_MESSAGE(e.msg);
+        return false;
+    }
+    return vm.load(code.data(), code.size());
+}
+
+static bool load_bytes(FxVM &vm, std::initializer_list<uint8_t> code){ return vm.load(code.begin(), code.size()); }
+
+static void assert_same(LedFB<CRGB> &a, LedFB<CRGB> &b){
+    for (unsigned y = 0; y != a.h(); ++y)
+        for (unsigned x = 0; x != a.w(); ++x)
+            if (a.at(x, y) != b.at(x, y)){
+                char msg[64];
+                snprintf(msg, sizeof(msg), "pixel %u:%u differs", x, y);
+                TEST_FAIL_MESSAGE(msg);
+            }
+}
+
+void test_assemble_encoding(){
+    std::vector<uint8_t> code;
+    TEST_ASSERT_TRUE(FxVM::assemble(
+        "start:  ldi r1, 0x12345678   ; comment\n"
+        "        env r2, frame\n"
+        "\n"
+        "        shr r3, r1, 4\n"
+        "        jnz r0, done\n"
+        "        jmp start\n"
+        "done:   end\n", code));
+    const uint8_t expect[] = {
+        static_cast<uint8_t>(op_t::ldi), 1, 0x78, 0x56, 0x34, 0x12,
+        static_cast<uint8_t>(op_t::env), 2, static_cast<uint8_t>(FxVM::env_t::frame),
+        static_cast<uint8_t>(op_t::shr), 3, 1, 4,
+        static_cast<uint8_t>(op_t::jnz), 0, 20, 0,
+        static_cast<uint8_t>(op_t::jmp), 0, 0,
+        static_cast<uint8_t>(op_t::end)
+    };
+    TEST_ASSERT_EQUAL(sizeof(expect), code.size());
+    TEST_ASSERT_EQUAL_MEMORY(expect, code.data(), sizeof(expect));
+
+    // immediates: negative, hex color, palette and env by name or number
+    TEST_ASSERT_TRUE(FxVM::assemble("ldi r0, -1\nldi r1, #102030\npalsel heat\nenv r2, 1\n", code));
+    const uint8_t imm[] = {
+        static_cast<uint8_t>(op_t::ldi), 0, 0xff, 0xff, 0xff, 0xff,
+        static_cast<uint8_t>(op_t::ldi), 1, 0x30, 0x20, 0x10, 0,
+        static_cast<uint8_t>(op_t::palsel), static_cast<uint8_t>(FxVM::pal_t::heat),
+        static_cast<uint8_t>(op_t::env), 2, static_cast<uint8_t>(FxVM::env_t::h)
+    };
+    TEST_ASSERT_EQUAL(sizeof(imm), code.size());
+    TEST_ASSERT_EQUAL_MEMORY(imm, code.data(), sizeof(imm));
+}
+
+void test_load_and_run_roundtrip(){
+    FxVM vm;
+    LedFB<CRGB> fb(8, 4);
+    TEST_ASSERT_TRUE(load_src(vm,
+        "        ldi r1, 0x12345678\n"
+        "        ldi r2, 5\n"
+        "        ldi r3, 0\n"
+        "sum:    add r3, r3, r2      ; 5+4+3+2+1\n"
+        "        loop r2, sum\n"
+        "        env r4, w\n"
+        "        env r5, h\n"
+        "        env r6, frame\n"
+        "        addi r7, 1          ; registers survive runs\n"));
+    TEST_ASSERT_EQUAL(9, vm.size());
+    TEST_ASSERT_TRUE(vm.run(fb));
+    TEST_ASSERT_EQUAL(0x12345678, vm.getReg(1));
+    TEST_ASSERT_EQUAL(15, vm.getReg(3));
+    TEST_ASSERT_EQUAL(8, vm.getReg(4));
+    TEST_ASSERT_EQUAL(4, vm.getReg(5));
+    TEST_ASSERT_EQUAL(0, vm.getReg(6));
+    TEST_ASSERT_EQUAL(3 + 2 * 5 + 4, vm.steps());
+    TEST_ASSERT_TRUE(vm.run(fb));
+    TEST_ASSERT_EQUAL(1, vm.getReg(6));
+    TEST_ASSERT_EQUAL(2, vm.getReg(7));
+    // register access is bounds checked
+    vm.setReg(FxVM::regs, 1);
+    TEST_ASSERT_EQUAL(0, vm.getReg(FxVM::regs));
+
+    vm.reset();
+    TEST_ASSERT_EQUAL(0, vm.getReg(7));
+}
+
+void test_assembler_errors(){
+    std::vector<uint8_t> code;
+    FxVM::asm_error_t e{0, nullptr};
+    struct { const char *src; unsigned line; } bad[] = {
+        {"ldi r0, 1\nfoo r1\n", 2},             // unknown instruction
+        {"ldi r16, 1\n", 1},                    // bad register
+        {"mov r0, x1\n", 1},                    // register expected
+        {"end\n\njmp nowhere\n", 3},            // undefined label
+        {"add r0, r1\n", 1},                    // wrong number of operands
+        {"a: end\na: end\n", 2},                // duplicate label
+        {"env r0, bogus\n", 1},
+        {"palsel 7\n", 1},
+        {"shr r0, r1, 256\n", 1},
+        {"ldi r0, 0x100000000\n", 1},
+        {"ldi r0, #12345\n", 1},
+        {": end\n", 1},                         // empty label
+    };
+    for (auto &b : bad){
+        code.assign(4, 0xaa);
+        e = {0, nullptr};
+        TEST_ASSERT_TRUE_MESSAGE(!FxVM::assemble(b.src, code, &e), b.src);
+        TEST_ASSERT_EQUAL_MESSAGE(b.line, e.line, b.src);
+        TEST_ASSERT_NOT_NULL(e.msg);
+        TEST_ASSERT_EQUAL(0, code.size());
+    }
+    TEST_ASSERT_FALSE(FxVM::assemble(nullptr, code));
+}
+
+void test_load_rejects_malformed(){
+    FxVM vm;
+    LedFB<CRGB> fb(4, 4);
+    const uint8_t ldi = static_cast<uint8_t>(op_t::ldi), mov = static_cast<uint8_t>(op_t::mov), jmp = static_cast<uint8_t>(op_t::jmp);
+
+    TEST_ASSERT_FALSE(load_bytes(vm, {static_cast<uint8_t>(op_t::count)}));        // unknown opcode
+    TEST_ASSERT_FALSE(load_bytes(vm, {ldi, 0, 1, 2}));                              // truncated imm32
+    TEST_ASSERT_FALSE(load_bytes(vm, {mov, 0, FxVM::regs}));                        // register out of range
+    TEST_ASSERT_FALSE(load_bytes(vm, {mov, 0xff, 0}));
+    TEST_ASSERT_FALSE(load_bytes(vm, {static_cast<uint8_t>(op_t::env), 0, static_cast<uint8_t>(FxVM::env_t::count)}));
+    TEST_ASSERT_FALSE(load_bytes(vm, {static_cast<uint8_t>(op_t::palsel), static_cast<uint8_t>(FxVM::pal_t::count)}));
+    TEST_ASSERT_FALSE(load_bytes(vm, {jmp, 1, 0}));                                 // jump into operand
+    TEST_ASSERT_FALSE(load_bytes(vm, {jmp, 4, 0}));                                 // jump past the end
+    TEST_ASSERT_FALSE(load_bytes(vm, {ldi, 0, 1, 0, 0, 0, jmp, 3, 0}));             // jump into imm32
+    TEST_ASSERT_FALSE(vm.load(nullptr, 0));
+    TEST_ASSERT_FALSE(vm.load(nullptr, 3));
+
+    // rejected code clears previous program, nothing runs
+    TEST_ASSERT_TRUE(load_bytes(vm, {ldi, 1, 7, 0, 0, 0}));
+    TEST_ASSERT_EQUAL(1, vm.size());
+    TEST_ASSERT_FALSE(load_bytes(vm, {mov, 0, 16}));
+    TEST_ASSERT_EQUAL(0, vm.size());
+    TEST_ASSERT_FALSE(vm.run(fb));
+    TEST_ASSERT_EQUAL(0, vm.getReg(1));
+
+    // jumps to instruction starts and to the end of code are valid
+    TEST_ASSERT_TRUE(load_bytes(vm, {jmp, 3, 0}));
+    TEST_ASSERT_TRUE(load_bytes(vm, {ldi, 0, 1, 0, 0, 0, jmp, 0, 0, jmp, 6, 0}));
+}
+
+void test_step_cap(){
+    FxVM vm;
+    LedFB<CRGB> fb(4, 4);
+    // runaway loop is stopped after the budget, two instructions per iteration
+    TEST_ASSERT_TRUE(load_src(vm, "l: addi r0, 1\njmp l\n"));
+    TEST_ASSERT_FALSE(vm.run(fb));
+    TEST_ASSERT_EQUAL(LEDFB_FXVM_MAX_STEPS / 2, vm.getReg(0));
+    TEST_ASSERT_TRUE(vm.steps() <= LEDFB_FXVM_MAX_STEPS + 1);
+
+    // program that takes exactly the budget completes, one more step does not
+    char src[64];
+    snprintf(src, sizeof(src), "ldi r0, %d\nl: loop r0, l\n", LEDFB_FXVM_MAX_STEPS - 1);
+    TEST_ASSERT_TRUE(load_src(vm, src));
+    TEST_ASSERT_TRUE(vm.run(fb));
+    TEST_ASSERT_EQUAL(LEDFB_FXVM_MAX_STEPS, vm.steps());
+    snprintf(src, sizeof(src), "ldi r0, %d\nl: loop r0, l\n", LEDFB_FXVM_MAX_STEPS);
+    TEST_ASSERT_TRUE(load_src(vm, src));
+    TEST_ASSERT_FALSE(vm.run(fb));
+}
+
+void test_loop_counter_wraps(){
+    FxVM vm;
+    LedFB<CRGB> fb(4, 4);
+    // counter is decremented modulo 2^32 like add/sub, the most negative value wraps to the most positive one
+    TEST_ASSERT_TRUE(load_src(vm, "ldi r0, -2147483648\nloop r0, done\ndone: addi r1, 1\n"));
+    TEST_ASSERT_TRUE(vm.run(fb));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, vm.getReg(0));
+    TEST_ASSERT_EQUAL(1, vm.getReg(1));
+}
+
+void test_canvas_primitives(){
+    FxVM vm;
+    LedFB<CRGB> fb(8, 4);
+    // fill, clipped hline, scroll right by one
+    TEST_ASSERT_TRUE(load_src(vm,
+        "ldi r0, #102030\n fill r0\n"
+        "ldi r1, 1\n ldi r2, -2\n ldi r3, 5\n ldi r4, 0xff0000\n hline r1, r2, r3, r4\n"
+        "ldi r5, 0\n ldi r6, 1\n shift r6, r5\n"
+        "ldi r7, 3\n ldi r8, 2\n ldi r9, #00ff00\n pset r7, r8, r9\n"));
+    TEST_ASSERT_TRUE(vm.run(fb));
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(0, 0, 0));
+    TEST_ASSERT_TRUE(fb.at(1, 0) == CRGB(0x10, 0x20, 0x30));
+    TEST_ASSERT_TRUE(fb.at(1, 1) == CRGB(255, 0, 0));
+    TEST_ASSERT_TRUE(fb.at(3, 1) == CRGB(255, 0, 0));
+    TEST_ASSERT_TRUE(fb.at(4, 1) == CRGB(0x10, 0x20, 0x30));
+    TEST_ASSERT_TRUE(fb.at(3, 2) == CRGB(0, 255, 0));
+
+    // ramp through a palette, then blend row towards white
+    TEST_ASSERT_TRUE(load_src(vm,
+        "palsel lava\n ldi r0, 2\n ldi r1, 10\n ldi r2, 40\n ramp r1, r2\n ldi r3, 255\n pal r0, r3\n"
+        "ldi r0, 3\n pal r0, r3\n ldi r4, #ffffff\n ldi r5, 128\n blend r0, r4, r5\n"
+        "ldi r0, 9\n pal r0, r3\n"));
+    TEST_ASSERT_TRUE(vm.run(fb));
+    for (unsigned x = 0; x != 8; ++x){
+        CRGB c = ColorFromPalette(LavaColors_p, 10 + x * 40, 255, LINEARBLEND);
+        TEST_ASSERT_TRUE(fb.at(x, 2) == c);
+        TEST_ASSERT_TRUE(fb.at(x, 3) == blend(c, CRGB(255, 255, 255), 128));
+    }
+}
+
+static const char *noise_src =
+    "        env r1, h       ; rows\n"
+    "        env r2, frame\n"
+    "        shl r2, r2, 4\n"
+    "        ldi r3, 30      ; noise scale\n"
+    "        ldi r4, 255\n"
+    "        palsel heat\n"
+    "        ldi r0, 0\n"
+    "row:    noise r0, r3, r2\n"
+    "        pal r0, r4\n"
+    "        addi r0, 1\n"
+    "        jlt r0, r1, row\n"
+    "        end\n";
+
+static void native_noise(LedFB<CRGB> &fb, uint32_t frame){
+    uint32_t z = frame << 4;
+    for (unsigned y = 0; y != fb.h(); ++y)
+        for (unsigned x = 0; x != fb.w(); ++x)
+            fb.at(x, y) = ColorFromPalette(HeatColors_p, inoise8(x * 30, y * 30, z), 255, LINEARBLEND);
+}
+
+static const char *spark_src =
+    "        ldi r5, 24      ; fade\n"
+    "        fade r5\n"
+    "        env r6, w\n"
+    "        env r7, h\n"
+    "        ldi r8, 8       ; sparks per frame\n"
+    "next:   rnd r0, r6\n"
+    "        rnd r1, r7\n"
+    "        rnd r2, r9      ; r9 = 0 gives a 16 bit value\n"
+    "        shl r2, r2, 8\n"
+    "        pset r0, r1, r2\n"
+    "        loop r8, next\n";
+
+// same xorshift32 generator and seed as VM's rnd
+struct xorshift {
+    uint32_t s{0x2545f491};
+    uint32_t operator()(){ s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+};
+
+static void native_spark(LedFB<CRGB> &fb, xorshift &rng){
+    fb.fade(24);
+    for (unsigned k = 0; k != 8; ++k){
+        uint32_t x = rng() % fb.w(), y = rng() % fb.h(), c = (rng() & 0xffff) << 8;
+        fb.at(x, y) = CRGB((c >> 16) & 0xff, (c >> 8) & 0xff, c & 0xff);
+    }
+}
+
+void test_effects_match_native(){
+    for (uint16_t sz : {16, 64}){
+        LedFB<CRGB> a(sz, sz), b(sz, sz);
+        FxVM vm;
+        TEST_ASSERT_TRUE(load_src(vm, noise_src));
+        for (uint32_t f = 0; f != 3; ++f){
+            TEST_ASSERT_TRUE(vm.run(a));
+            native_noise(b, f);
+        }
+        assert_same(a, b);
+    }
+
+    LedFB<CRGB> a(32, 32), b(32, 32);
+    FxVM vm;
+    xorshift rng;
+    TEST_ASSERT_TRUE(load_src(vm, spark_src));
+    for (unsigned f = 0; f != 50; ++f){
+        TEST_ASSERT_TRUE(vm.run(a));
+        native_spark(b, rng);
+    }
+    assert_same(a, b);
+}
+
+// VM effects vs equivalent native loops, row primitives should keep interpretation overhead small
+void bench_vm_vs_native(){
+    char name[48];
+    for (uint16_t sz : {16, 64}){
+        LedFB<CRGB> a(sz, sz), b(sz, sz);
+        FxVM vm;
+        load_src(vm, noise_src);
+        uint32_t f = 0;
+        snprintf(name, sizeof(name), "vm noise %ux%u", sz, sz);
+        bench_report(name, bench_us([&](){ vm.run(a); }, 2000), a.size());
+        snprintf(name, sizeof(name), "native noise %ux%u", sz, sz);
+        bench_report(name, bench_us([&](){ native_noise(b, f++); }, 2000), b.size());
+    }
+
+    LedFB<CRGB> a(32, 32), b(32, 32);
+    FxVM vm;
+    xorshift rng;
+    load_src(vm, spark_src);
+    bench_report("vm sparks 32x32", bench_us([&](){ vm.run(a); }, 20000), a.size());
+    bench_report("native sparks 32x32", bench_us([&](){ native_spark(b, rng); }, 20000), b.size());
+    bench_sink += a.at(0, 0).r + b.at(0, 0).r;
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_assemble_encoding);
+    RUN_TEST(test_load_and_run_roundtrip);
+    RUN_TEST(test_assembler_errors);
+    RUN_TEST(test_load_rejects_malformed);
+    RUN_TEST(test_step_cap);
+    RUN_TEST(test_loop_counter_wraps);
+    RUN_TEST(test_canvas_primitives);
+    RUN_TEST(test_effects_match_native);
+    RUN_TEST(bench_vm_vs_native);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// Arduino_GFX canvas classes: shared rotation and bitmap drawing, variant vs templated canvas
+#include <unity.h>
+#include "hub75planes.hpp"
+#include "bench.hpp"
+
+constexpr int16_t side = 16;
+
+// 12x5 test bitmap, rows padded to whole bytes
+static const uint8_t bitmap[] = {
+    0b11110000, 0b10100000,
+    0b10011001, 0b01010000,
+    0b00111100, 0b11110000,
+    0b10000001, 0b00000000,
+    0b01010101, 0b10100000,
+};
+
+static uint32_t seed;
+static CRGB rnd_color(){ seed = seed * 1664525 + 1013904223; return CRGB(seed >> 8, seed >> 16, seed >> 24); }
+
+void setUp(){ seed = 1; }
+void tearDown(){}
+
+// draws the same scene with bitmap functions on any canvas
+template <class GFX>
+static void draw_scene(GFX &gfx, uint8_t rotation){
+    gfx.setRotation(rotation);
+    gfx.drawBitmap_alphablend(1, 2, bitmap, 12, 5, CRGB(255, 0, 0), 255, CRGB(0, 0, 255), 100);
+    gfx.drawBitmap_alphablend(-3, 9, bitmap, 12, 5, CRGB(0, 200, 0), 60);
+    gfx.drawBitmap_bgfade(6, 6, bitmap, 12, 5, CRGB(10, 20, 30), 128);
+    gfx.drawBitmap_scale_colors(2, 11, bitmap, 12, 5, CRGB(255, 128, 0), CRGB(0, 0, 0));
+    gfx.drawBitmap_scale_colors(8, 0, bitmap, 12, 5, CRGB(255, 255, 255), CRGB(100, 200, 50));
+}
+
+template <class GFX>
+static void check_rotation(GFX &gfx){
+    // a pixel is drawn at the rotated position, read-modify-write ops use the same mapping
+    static const uint8_t dot[] = { 0b10000000 };
+    gfx.setRotation(1);
+    gfx.drawBitmap_bgfade(0, 0, dot, 2, 1, CRGB(255, 0, 0), 0);
+    gfx.drawBitmap_alphablend(0, 1, dot, 2, 1, CRGB(0, 255, 0), 128, CRGB(0, 0, 255), 255);
+}
+
+// canvas over it's own buffer
+template <class COLOR_TYPE>
+struct canvas_t {
+    std::shared_ptr<PixelDataBuffer<COLOR_TYPE>> buff;
+    std::shared_ptr<LedFB<COLOR_TYPE>> fb;
+    canvas_t(int16_t w, int16_t h) : buff(std::make_shared<PixelDataBuffer<COLOR_TYPE>>(w * h)), fb(std::make_shared<LedFB<COLOR_TYPE>>(w, h, buff)) {}
+    const COLOR_TYPE* data() const { return buff->data().data(); }
+};
+
+// canvas with each pixel of a distinct color
+template <class COLOR_TYPE>
+static void noise(LedFB<COLOR_TYPE> &fb);
+template <> void noise(LedFB<CRGB> &fb){ for (auto &c : fb.logical()) c = rnd_color(); }
+template <> void noise(LedFB<uint16_t> &fb){ for (auto &c : fb.logical()) c = LedFB_GFX::color565(rnd_color()); }
+
+void test_variant_matches_templated(){
+    for (uint8_t r = 0; r != 4; ++r){
+        canvas_t<CRGB> a(side, side), b(side, side);
+        noise(*a.fb);
+        b.fb->blit(0, 0, *a.fb);
+        LedFB_GFX va(a.fb);
+        LedFB_GFX_T<CRGB> tb(b.fb);
+        draw_scene(va, r);
+        draw_scene(tb, r);
+        TEST_ASSERT_EQUAL_MEMORY(a.data(), b.data(), side * side * sizeof(CRGB));
+
+        canvas_t<uint16_t> c(side, side), d(side, side);
+        noise(*c.fb);
+        d.fb->blit(0, 0, *c.fb);
+        LedFB_GFX vc(c.fb);
+        LedFB_GFX_T<uint16_t> td(d.fb);
+        draw_scene(vc, r);
+        draw_scene(td, r);
+        TEST_ASSERT_EQUAL_MEMORY(c.data(), d.data(), side * side * sizeof(uint16_t));
+    }
+}
+
+void test_hub75_matches_canvas(){
+    for (uint8_t r = 0; r != 4; ++r){
+        canvas_t<CRGB> c(side, side);
+        auto &fb = c.fb;
+        auto db = std::make_shared<HUB75PlaneDB>(side, side);
+        noise(*fb);
+        db->blit(0, 0, side, side, c.data());
+        LedFB_GFX_T<CRGB> t(fb);
+        HUB75Plane_GFX h(db);
+        draw_scene(t, r);
+        draw_scene(h, r);
+        for (int16_t y = 0; y != side; ++y)
+            for (int16_t x = 0; x != side; ++x)
+                TEST_ASSERT_TRUE(db->get(x, y) == fb->at(x, y));
+    }
+}
+
+void test_rotated_rmw(){
+    auto fb = std::make_shared<LedFB<CRGB>>(side, side);
+    fb->fill(CRGB(200, 200, 200));
+    LedFB_GFX gfx(fb);
+    check_rotation(gfx);
+    // rotation 1 maps (x, y) to (w - 1 - y, x)
+    TEST_ASSERT_TRUE(fb->at(side - 1, 0) == CRGB(255, 0, 0));       // foreground of bgfade at (0,0)
+    TEST_ASSERT_TRUE(fb->at(side - 1, 1) == CRGB(0, 0, 0));         // faded background at (1,0)
+    CRGB blended(200, 200, 200);
+    nblend(blended, CRGB(0, 255, 0), 128);
+    TEST_ASSERT_TRUE(fb->at(side - 2, 0) == blended);               // blended foreground at (0,1)
+    TEST_ASSERT_TRUE(fb->at(side - 2, 1) == CRGB(0, 0, 255));       // opaque background at (1,1)
+    size_t touched = 0;
+    for (auto &c : fb->logical()) touched += !(c == CRGB(200, 200, 200));
+    TEST_ASSERT_EQUAL(4, touched);
+}
+
+// per pixel writes and bitmap blending on a 64x64 canvas, variant visiting LedFB_GFX vs LedFB_GFX_T
+void bench_variant_vs_templated(){
+    constexpr int16_t w = 64, h = 64;
+    canvas_t<CRGB> a(w, h), b(w, h);
+    LedFB_GFX va(a.fb);
+    LedFB_GFX_T<CRGB> tb(b.fb);
+    auto pixels = [](auto &gfx){
+        return bench_us([&](){
+            for (int16_t y = 0; y != h; ++y)
+                for (int16_t x = 0; x != w; ++x) gfx.writePixel(x, y, CRGB(x * 4, y * 4, 0));
+        }, 1000);
+    };
+    auto bitmaps = [](auto &gfx){
+        return bench_us([&](){
+            for (int16_t y = 0; y < h; y += 5)
+                for (int16_t x = 0; x < w; x += 12) gfx.drawBitmap_alphablend(x, y, bitmap, 12, 5, CRGB(255, 0, 0), 200, CRGB(0, 0, 255), 50);
+        }, 1000);
+    };
+    bench_report("variant writePixel 64x64", pixels(va), w * h);
+    bench_report("templated writePixel 64x64", pixels(tb), w * h);
+    bench_report("variant alphablend 64x64", bitmaps(va), w * h);
+    bench_report("templated alphablend 64x64", bitmaps(tb), w * h);
+    TEST_ASSERT_EQUAL_MEMORY(a.data(), b.data(), w * h * sizeof(CRGB));
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_variant_matches_templated);
+    RUN_TEST(test_hub75_matches_canvas);
+    RUN_TEST(test_rotated_rmw);
+    RUN_TEST(bench_variant_vs_templated);
+    return UNITY_END();
+}
@@ -0,0 +1,249 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// HUB75 bit-plane packing and write-through plane buffer
+#include <unity.h>
+#include "hub75planes.hpp"
+#include "bench.hpp"
+
+static uint32_t seed;
+static uint32_t rnd(){ seed = seed * 1664525 + 1013904223; return seed; }
+static CRGB rnd_color(){ uint32_t v = rnd(); return CRGB(v >> 24, v >> 16, v >> 8); }
+
+void setUp(){ seed = 1; }
+void tearDown(){}
+
+// per-bit reference transpose
+static uint64_t transpose8_ref(uint64_t x){
+    uint64_t r = 0;
+    for (unsigned row = 0; row != 8; ++row)
+        for (unsigned col = 0; col != 8; ++col)
+            if (x >> (row * 8 + col) & 1) r |= 1ULL << (col * 8 + row);
+    return r;
+}
+
+// per-bit reference packer, color bit 'k' of a pixel pair goes to plane 'k - (8 - depth)'
+static void pack_ref(HUB75BitPlanes &p, const std::vector<CRGB> &px){
+    for (uint16_t r = 0; r != p.scanRows(); ++r)
+        for (uint16_t x = 0; x != p.w(); ++x){
+            const CRGB &t = px[r * p.w() + x], &b = px[(r + p.scanRows()) * p.w() + x];
+            for (uint8_t pl = 0; pl != p.depth(); ++pl){
+                unsigned bit = 8 - p.depth() + pl;
+                uint16_t &w = p.row(pl, r)[x];
+                w &= ~HUB75BitPlanes::COLOR_MASK;
+                w |= (t.r >> bit & 1) | (t.g >> bit & 1) << 1 | (t.b >> bit & 1) << 2 | (b.r >> bit & 1) << 3 | (b.g >> bit & 1) << 4 | (b.b >> bit & 1) << 5;
+            }
+        }
+}
+
+void test_transpose8(){
+    TEST_ASSERT_TRUE(0 == HUB75BitPlanes::transpose8(0));
+    TEST_ASSERT_TRUE(~0ULL == HUB75BitPlanes::transpose8(~0ULL));
+    // first row becomes first column
+    TEST_ASSERT_TRUE(0x0101010101010101ULL == HUB75BitPlanes::transpose8(0xff));
+    for (unsigned i = 0; i != 1000; ++i){
+        uint64_t x = static_cast<uint64_t>(rnd()) << 32 | rnd();
+        uint64_t t = HUB75BitPlanes::transpose8(x);
+        TEST_ASSERT_TRUE(transpose8_ref(x) == t);
+        TEST_ASSERT_TRUE(x == HUB75BitPlanes::transpose8(t));
+    }
+}
+
+void test_pack_matches_reference(){
+    for (uint8_t depth : {8, 5, 1}){
+        HUB75BitPlanes p(16, 8, depth), ref(16, 8, depth);
+        std::vector<CRGB> px(16 * 8);
+        for (auto &c : px) c = rnd_color();
+        for (uint16_t r = 0; r != p.scanRows(); ++r)
+            p.packRow(r, &px[r * 16], &px[(r + 4) * 16], 0, 16);
+        pack_ref(ref, px);
+        TEST_ASSERT_EQUAL_MEMORY(ref.data(), p.data(), 16 * 4 * depth * sizeof(uint16_t));
+    }
+}
+
+void test_pack_unpack_roundtrip(){
+    std::vector<CRGB> px(32 * 16);
+    for (auto &c : px) c = rnd_color();
+    PixelDataBuffer<CRGB> buff(px.size());
+    std::copy(px.begin(), px.end(), buff.begin());
+
+    HUB75BitPlanes p(32, 16);
+    TEST_ASSERT_TRUE(p.pack(buff));
+    for (uint16_t y = 0; y != 16; ++y)
+        for (uint16_t x = 0; x != 32; ++x)
+            TEST_ASSERT_TRUE(p.unpack(x, y) == px[y * 32 + x]);
+
+    // lower depth keeps only most significant bits
+    HUB75BitPlanes p4(32, 16, 4);
+    TEST_ASSERT_TRUE(p4.pack(buff));
+    for (size_t i = 0; i != px.size(); ++i){
+        CRGB c = p4.unpack(i % 32, i / 32);
+        TEST_ASSERT_EQUAL_HEX8(px[i].r & 0xf0, c.r);
+        TEST_ASSERT_EQUAL_HEX8(px[i].g & 0xf0, c.g);
+        TEST_ASSERT_EQUAL_HEX8(px[i].b & 0xf0, c.b);
+    }
+
+    // pending deferred scale is applied to packed pixels, buffer is left intact
+    buff.scaleDeferred(100);
+    TEST_ASSERT_TRUE(p.pack(buff));
+    TEST_ASSERT_TRUE(buff.deferredScale() != PixelDataBuffer<CRGB>::scale_one);
+    for (size_t i = 0; i != px.size(); ++i)
+        TEST_ASSERT_TRUE(p.unpack(i % 32, i / 32) == buff.output(i));
+
+    // buffer of wrong size is rejected
+    PixelDataBuffer<CRGB> small(10);
+    TEST_ASSERT_FALSE(p.pack(small));
+}
+
+void test_pack_rgb565(){
+    std::vector<uint16_t> px(16 * 8);
+    for (auto &c : px) c = rnd();
+    HUB75BitPlanes p(16, 8);
+    for (uint16_t r = 0; r != p.scanRows(); ++r)
+        p.packRow(r, &px[r * 16], &px[(r + 4) * 16], 0, 16);
+    for (size_t i = 0; i != px.size(); ++i)
+        TEST_ASSERT_TRUE(p.unpack(i % 16, i / 16) == LedFB_GFX::colorCRGB(px[i]));
+}
+
+void test_control_bits_and_partial_rows(){
+    HUB75BitPlanes p(16, 8);
+    // driver's control bits must survive packing
+    std::fill_n(p.data(), 16 * 4 * 8, 0xabc0);
+    std::vector<CRGB> top(16, CRGB(255, 0, 255)), bottom(16, CRGB(0, 255, 0));
+    // partial row is clipped to panel width
+    p.packRow(1, top.data(), bottom.data(), 10, 16);
+    for (uint8_t pl = 0; pl != 8; ++pl)
+        for (uint16_t x = 0; x != 16; ++x){
+            uint16_t w = p.row(pl, 1)[x];
+            TEST_ASSERT_EQUAL_HEX16(0xabc0, w & ~HUB75BitPlanes::COLOR_MASK);
+            TEST_ASSERT_EQUAL_HEX16(x < 10 ? 0 : HUB75BitPlanes::BIT_R1 | HUB75BitPlanes::BIT_B1 | HUB75BitPlanes::BIT_G2, w & HUB75BitPlanes::COLOR_MASK);
+        }
+    // out of range rows are ignored
+    p.packRow(4, top.data(), bottom.data(), 0, 16);
+    TEST_ASSERT_TRUE(p.unpack(0, 4) == CRGB());
+}
+
+// packing a 128x64 panel, bit-matrix transpose vs per-bit loops
+void bench_pack(){
+    constexpr uint16_t w = 128, h = 64;
+    PixelDataBuffer<CRGB> buff(w * h);
+    std::vector<CRGB> px(w * h);
+    for (auto &c : px) c = rnd_color();
+    std::copy(px.begin(), px.end(), buff.begin());
+    HUB75BitPlanes p(w, h), ref(w, h);
+    bench_report("pack transpose8 128x64", bench_us([&](){ p.pack(buff); }, 200), w * h);
+    bench_report("pack per-bit 128x64", bench_us([&](){ pack_ref(ref, px); }, 200), w * h);
+    TEST_ASSERT_EQUAL_MEMORY(ref.data(), p.data(), w * h / 2 * 8 * sizeof(uint16_t));
+}
+
+void test_planedb_write_through(){
+    HUB75PlaneDB db(16, 8);
+    std::vector<CRGB> run(12);
+    for (auto &c : run) c = rnd_color();
+    db.setRun(2, 1, run.data(), 12);
+    db.set(5, 5, CRGB(1, 2, 3));
+    // a write to the upper half row keeps paired lower half row intact and vice versa
+    for (uint16_t i = 0; i != 12; ++i)
+        TEST_ASSERT_TRUE(db.get(2 + i, 1) == run[i]);
+    TEST_ASSERT_TRUE(db.get(5, 5) == CRGB(1, 2, 3));
+    TEST_ASSERT_TRUE(db.get(5, 1) == run[3]);
+    TEST_ASSERT_TRUE(db.get(0, 5) == CRGB());
+    // runs are clipped to panel width, out of range writes are ignored
+    db.setRun(14, 2, run.data(), 12);
+    db.setRun(0, 8, run.data(), 12);
+    TEST_ASSERT_TRUE(db.get(15, 2) == run[1]);
+    TEST_ASSERT_TRUE(db.get(0, 3) == CRGB());
+    TEST_ASSERT_TRUE(db.get(16, 2) == CRGB());
+}
+
+void test_planedb_shadow_reads(){
+    HUB75PlaneDB db(8, 4, 4, true), planes_only(8, 4, 4);
+    TEST_ASSERT_TRUE(db.shadow());
+    CRGB c(0x9c, 0x47, 0xe1);
+    db.set(3, 2, c);
+    planes_only.set(3, 2, c);
+    // shadow keeps RGB565 precision, planes only keep 'depth' bits
+    TEST_ASSERT_TRUE(db.get(3, 2) == LedFB_GFX::colorCRGB(LedFB_GFX::color565(c)));
+    TEST_ASSERT_TRUE(planes_only.get(3, 2) == CRGB(0x90, 0x40, 0xe0));
+    // planes are the same either way
+    TEST_ASSERT_EQUAL_MEMORY(planes_only.planes().data(), db.planes().data(), 8 * 2 * 4 * sizeof(uint16_t));
+}
+
+void test_planedb_fill_and_clip(){
+    HUB75PlaneDB db(16, 8, 8, true);
+    db.fill(CRGB(10, 20, 30));
+    // rectangle partially out of panel on every side
+    db.fillRect(-3, -2, 6, 4, CRGB(255, 0, 0));
+    db.fillRect(12, 6, 10, 10, CRGB(0, 255, 0));
+    for (uint16_t y = 0; y != 8; ++y)
+        for (uint16_t x = 0; x != 16; ++x){
+            CRGB e = x < 3 && y < 2 ? CRGB(255, 0, 0) : x >= 12 && y >= 6 ? CRGB(0, 255, 0) : CRGB(10, 20, 30);
+            TEST_ASSERT_TRUE(db.planes().unpack(x, y) == e);
+            TEST_ASSERT_TRUE(db.get(x, y) == LedFB_GFX::colorCRGB(LedFB_GFX::color565(e)));
+        }
+
+    // blit with negative offset and a source stride
+    std::vector<CRGB> src(5 * 4);
+    for (auto &c : src) c = rnd_color();
+    db.clear();
+    db.blit(-1, -2, 3, 4, src.data(), 5);
+    for (uint16_t y = 0; y != 2; ++y)
+        for (uint16_t x = 0; x != 2; ++x)
+            TEST_ASSERT_TRUE(db.planes().unpack(x, y) == src[(y + 2) * 5 + x + 1]);
+    TEST_ASSERT_TRUE(db.planes().unpack(2, 0) == CRGB());
+    TEST_ASSERT_TRUE(db.planes().unpack(0, 2) == CRGB());
+}
+
+void test_planedb_gfx(){
+    auto db = std::make_shared<HUB75PlaneDB>(16, 8);
+    HUB75Plane_GFX gfx(db);
+    uint16_t white = LedFB_GFX::color565(CRGB(255, 255, 255));
+    gfx.fillScreen(LedFB_GFX::color565(CRGB(0, 0, 255)));
+    gfx.writeFastHLine(-2, 3, 6, white);
+    gfx.writePixel(15, 7, white);
+    for (uint16_t x = 0; x != 16; ++x)
+        TEST_ASSERT_TRUE(db->get(x, 3) == (x < 4 ? CRGB(255, 255, 255) : CRGB(0, 0, 255)));
+    TEST_ASSERT_TRUE(db->get(15, 7) == CRGB(255, 255, 255));
+}
+
+// clear and draw 8 horizontal bars on a 128x64 panel, write-through planes vs CRGB canvas + full pack()
+void bench_write_through(){
+    constexpr uint16_t w = 128, h = 64;
+    HUB75PlaneDB db(w, h);
+    bench_report("write-through bars 128x64", bench_us([&](){
+        db.clear();
+        for (int16_t i = 0; i != 8; ++i) db.fillRect(0, i * 8, w, 4, CRGB(i * 30, 255 - i * 30, 0));
+    }, 500), w * h);
+
+    auto buff = std::make_shared<PixelDataBuffer<CRGB>>(w * h);
+    LedFB<CRGB> canvas(w, h, buff);
+    HUB75BitPlanes planes(w, h);
+    bench_report("canvas + pack bars 128x64", bench_us([&](){
+        canvas.clear();
+        for (int16_t i = 0; i != 8; ++i)
+            for (int16_t y = i * 8; y != i * 8 + 4; ++y)
+                for (int16_t x = 0; x != w; ++x) canvas.at(x, y) = CRGB(i * 30, 255 - i * 30, 0);
+        planes.pack(*buff);
+    }, 500), w * h);
+    TEST_ASSERT_EQUAL_MEMORY(planes.data(), db.planes().data(), w * h / 2 * 8 * sizeof(uint16_t));
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_transpose8);
+    RUN_TEST(test_pack_matches_reference);
+    RUN_TEST(test_pack_unpack_roundtrip);
+    RUN_TEST(test_pack_rgb565);
+    RUN_TEST(test_control_bits_and_partial_rows);
+    RUN_TEST(bench_pack);
+    RUN_TEST(test_planedb_write_through);
+    RUN_TEST(test_planedb_shadow_reads);
+    RUN_TEST(test_planedb_fill_and_clip);
+    RUN_TEST(test_planedb_gfx);
+    RUN_TEST(bench_write_through);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// canvas iterators and ranges: physical(), logical() and row() with standard algorithms, with and without compiled map
+#include <unity.h>
+#include <algorithm>
+#include "ledfb.hpp"
+
+constexpr uint16_t w = 7, h = 5;
+
+void setUp(){}
+void tearDown(){}
+
+// canvas over a serpentine chain, topology resolved either by a function or by a compiled map
+static std::shared_ptr<LedFB<CRGB>> make_canvas(bool lut){
+    auto fb = std::make_shared<LedFB<CRGB>>(w, h);
+    LedStripe snake(true);
+    if (lut){
+        auto map = std::make_shared<LedMapLUT>();
+        map->build(snake, w, h);
+        TEST_ASSERT_TRUE(fb->setRemapLUT(map));
+    } else
+        fb->setRemapFunction([snake](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return snake.transpose(w, h, x, y); });
+    return fb;
+}
+
+void test_logical_order(){
+    for (bool lut : {false, true}){
+        auto fb = make_canvas(lut);
+        auto r = fb->logical();
+        TEST_ASSERT_EQUAL(w * h, r.size());
+        size_t n = 0;
+        for (auto it = r.begin(); it != r.end(); ++it, ++n){
+            int16_t x = n % w, y = n / w;
+            TEST_ASSERT_EQUAL(x, it.x());
+            TEST_ASSERT_EQUAL(y, it.y());
+            TEST_ASSERT_TRUE(&*it == &fb->at(x, y));
+        }
+        // serpentine chain, odd rows run backwards in physical order
+        TEST_ASSERT_TRUE(&fb->logical().begin()[w] == &fb->begin()[2 * w - 1]);
+
+        // random access arithmetic
+        auto b = r.begin(), e = r.end();
+        TEST_ASSERT_EQUAL(w * h, e - b);
+        TEST_ASSERT_TRUE(&b[17] == &*(b + 17));
+        TEST_ASSERT_TRUE(&*(e - 1) == &fb->at(w - 1, h - 1));
+        TEST_ASSERT_TRUE(&*(3 + b) == &fb->at(3, 0));
+        auto it = b;
+        it += 10; it -= 3; --it; it--;
+        TEST_ASSERT_EQUAL(5, it - b);
+        TEST_ASSERT_TRUE(b < it && it <= it && it > b && e >= it && b != it);
+        TEST_ASSERT_TRUE(std::prev(e)->r == fb->at(w - 1, h - 1).r);
+    }
+}
+
+void test_row(){
+    for (bool lut : {false, true}){
+        auto fb = make_canvas(lut);
+        for (int16_t y = 0; y != h; ++y){
+            auto r = fb->row(y);
+            TEST_ASSERT_EQUAL(w, r.size());
+            int16_t x = 0;
+            for (auto &c : r) TEST_ASSERT_TRUE(&c == &fb->at(x++, y));
+        }
+
+        // fill a single row, others are untouched
+        std::fill(fb->row(2).begin(), fb->row(2).end(), CRGB(1, 2, 3));
+        for (int16_t y = 0; y != h; ++y)
+            for (int16_t x = 0; x != w; ++x)
+                TEST_ASSERT_TRUE(fb->at(x, y) == (y == 2 ? CRGB(1, 2, 3) : CRGB(0, 0, 0)));
+
+        // reversing a row mirrors it
+        auto r = fb->row(3);
+        int16_t x = 0;
+        for (auto &c : r) c = CRGB(x++, 0, 0);
+        std::reverse(r.begin(), r.end());
+        for (x = 0; x != w; ++x) TEST_ASSERT_EQUAL(w - 1 - x, fb->at(x, 3).r);
+    }
+}
+
+void test_fill_transform(){
+    for (bool lut : {false, true}){
+        auto fb = make_canvas(lut);
+        auto r = fb->logical();
+        std::fill(r.begin(), r.end(), CRGB(9, 9, 9));
+        for (auto &c : fb->physical()) TEST_ASSERT_TRUE(c == CRGB(9, 9, 9));
+
+        // logical number of each pixel, written through the iterator
+        uint8_t n = 0;
+        std::transform(r.begin(), r.end(), r.begin(), [&n](const CRGB &c){ return CRGB(n++, c.g, 0); });
+        for (int16_t y = 0; y != h; ++y)
+            for (int16_t x = 0; x != w; ++x){
+                TEST_ASSERT_EQUAL(y * w + x, fb->at(x, y).r);
+                TEST_ASSERT_EQUAL(9, fb->at(x, y).g);
+            }
+
+        // per row transform reads one row and writes another
+        std::transform(fb->row(0).begin(), fb->row(0).end(), fb->row(4).begin(), [](const CRGB &c){ return CRGB(c.r, 0, 1); });
+        for (int16_t x = 0; x != w; ++x) TEST_ASSERT_TRUE(fb->at(x, 4) == CRGB(x, 0, 1));
+    }
+}
+
+void test_sort(){
+    for (bool lut : {false, true}){
+        auto fb = make_canvas(lut);
+        // descending values in physical order
+        uint8_t v = w * h;
+        for (auto &c : fb->physical()) c = CRGB(v--, 0, 0);
+        auto by_red = [](const CRGB &a, const CRGB &b){ return a.r < b.r; };
+
+        // sorting each row orders it's pixels left to right, chain direction does not matter
+        for (int16_t y = 0; y != h; ++y){
+            auto r = fb->row(y);
+            std::sort(r.begin(), r.end(), by_red);
+            TEST_ASSERT_TRUE(std::is_sorted(r.begin(), r.end(), by_red));
+            for (int16_t x = 1; x != w; ++x) TEST_ASSERT_TRUE(fb->at(x - 1, y).r < fb->at(x, y).r);
+        }
+
+        // whole canvas sort, values ascend in row-major order
+        auto r = fb->logical();
+        std::sort(r.begin(), r.end(), by_red);
+        for (int16_t y = 0; y != h; ++y)
+            for (int16_t x = 0; x != w; ++x)
+                TEST_ASSERT_EQUAL(y * w + x + 1, fb->at(x, y).r);
+        // binary search over logical order
+        TEST_ASSERT_TRUE(std::lower_bound(r.begin(), r.end(), CRGB(20, 0, 0), by_red) - r.begin() == 19);
+    }
+}
+
+void test_physical(){
+    auto fb = make_canvas(true);
+    auto r = fb->physical();
+    TEST_ASSERT_EQUAL(w * h, r.size());
+    const CRGB *data = fb->span().data();
+    size_t n = 0;
+    for (auto &c : r) TEST_ASSERT_TRUE(&c == data + n++);
+    std::fill(r.begin(), r.end(), CRGB(4, 5, 6));
+    for (auto &c : fb->logical()) TEST_ASSERT_TRUE(c == CRGB(4, 5, 6));
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_logical_order);
+    RUN_TEST(test_row);
+    RUN_TEST(test_fill_transform);
+    RUN_TEST(test_sort);
+    RUN_TEST(test_physical);
+    return UNITY_END();
+}
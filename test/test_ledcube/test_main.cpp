@@ -0,0 +1,138 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// LedCube 3D canvas and slices
+#include <unity.h>
+#include "ledcube.hpp"
+#include "bench.hpp"
+
+using axis_t = LedCube<CRGB>::axis_t;
+
+void setUp(){}
+void tearDown(){}
+
+// a distinct color for each voxel
+static CRGB voxel(unsigned x, unsigned y, unsigned z){ return CRGB(x, y, z); }
+
+static void paint(LedCube<CRGB> &cube){
+    for (unsigned z = 0; z != cube.d(); ++z)
+        for (unsigned y = 0; y != cube.h(); ++y)
+            for (unsigned x = 0; x != cube.w(); ++x)
+                cube.at(x, y, z) = voxel(x, y, z);
+}
+
+void test_index_table(){
+    LedStripe layout(true, false, false, false);
+    LedCube<CRGB> cube(4, 3, 5, layout, true);
+    TEST_ASSERT_EQUAL(60, cube.size());
+    TEST_ASSERT_EQUAL(60, cube.getBuffer()->size());
+    std::vector<bool> seen(cube.size());
+    for (unsigned z = 0; z != 5; ++z)
+        for (unsigned y = 0; y != 3; ++y)
+            for (unsigned x = 0; x != 4; ++x){
+                size_t i = cube.index(x, y, z);
+                TEST_ASSERT_TRUE(i < cube.size());
+                TEST_ASSERT_FALSE(seen[i]);
+                seen[i] = true;
+                // layer is wired by its layout, odd layers in reverse
+                size_t t = layout.transpose(4, 3, x, y);
+                TEST_ASSERT_EQUAL(z * 12 + (z & 1 ? 11 - t : t), i);
+            }
+
+    // out of cube access goes to a stub pixel
+    TEST_ASSERT_TRUE(&cube.at(4, 0, 0) == &cube.getBuffer()->stub_pixel);
+    TEST_ASSERT_TRUE(&cube.at(0, 0, -1) == &cube.getBuffer()->stub_pixel);
+}
+
+void test_slices(){
+    LedCube<CRGB> cube(4, 3, 5, LedStripe(true), true);
+    paint(cube);
+    TEST_ASSERT_NULL(cube.slice(axis_t::x, 4).get());
+    TEST_ASSERT_NULL(cube.slice(axis_t::z, 5).get());
+
+    auto sz = cube.slice(axis_t::z, 2), sy = cube.slice(axis_t::y, 1), sx = cube.slice(axis_t::x, 3);
+    TEST_ASSERT_EQUAL(4, sz->w()); TEST_ASSERT_EQUAL(3, sz->h());
+    TEST_ASSERT_EQUAL(4, sy->w()); TEST_ASSERT_EQUAL(5, sy->h());
+    TEST_ASSERT_EQUAL(5, sx->w()); TEST_ASSERT_EQUAL(3, sx->h());
+    for (unsigned y = 0; y != 3; ++y)
+        for (unsigned x = 0; x != 4; ++x) TEST_ASSERT_TRUE(sz->at(x, y) == voxel(x, y, 2));
+    for (unsigned z = 0; z != 5; ++z)
+        for (unsigned x = 0; x != 4; ++x) TEST_ASSERT_TRUE(sy->at(x, z) == voxel(x, 1, z));
+    for (unsigned y = 0; y != 3; ++y)
+        for (unsigned z = 0; z != 5; ++z) TEST_ASSERT_TRUE(sx->at(z, y) == voxel(3, y, z));
+
+    // buffer-wide operations on a slice touch only slice pixels
+    sy->fill(CRGB(255, 255, 255));
+    sx->fade(128);
+    for (unsigned z = 0; z != 5; ++z)
+        for (unsigned y = 0; y != 3; ++y)
+            for (unsigned x = 0; x != 4; ++x){
+                CRGB e = y == 1 ? CRGB(255, 255, 255) : voxel(x, y, z);
+                if (x == 3) e.nscale8(127);
+                TEST_ASSERT_TRUE(cube.at(x, y, z) == e);
+            }
+}
+
+void test_shift_and_planes(){
+    for (axis_t axis : {axis_t::x, axis_t::y, axis_t::z}){
+        for (int steps : {1, -2, 5, 0}){
+            LedCube<CRGB> cube(4, 3, 5, LedStripe(true, true), true);
+            paint(cube);
+            cube.shift(axis, steps, CRGB(1, 1, 1));
+            for (int z = 0; z != 5; ++z)
+                for (int y = 0; y != 3; ++y)
+                    for (int x = 0; x != 4; ++x){
+                        int c[3] = {x, y, z};
+                        int &p = c[static_cast<int>(axis)];
+                        int n = static_cast<int>(axis) == 0 ? 4 : static_cast<int>(axis) == 1 ? 3 : 5;
+                        p -= steps;
+                        CRGB e = p < 0 || p >= n ? CRGB(1, 1, 1) : voxel(c[0], c[1], c[2]);
+                        TEST_ASSERT_TRUE(cube.at(x, y, z) == e);
+                    }
+        }
+    }
+
+    LedCube<CRGB> cube(4, 3, 5);
+    cube.fillPlane(axis_t::y, 2, CRGB(9, 9, 9));
+    cube.fillPlane(axis_t::y, 3, CRGB(7, 7, 7));
+    for (size_t i = 0; i != cube.size(); ++i){
+        unsigned x = i % 4, y = i / 4 % 3, z = i / 12;
+        TEST_ASSERT_TRUE(cube.at(x, y, z) == (y == 2 ? CRGB(9, 9, 9) : CRGB()));
+    }
+}
+
+// voxel access on a 16x16x16 cube, lookup table vs resolving layer layout on each access
+void bench_voxel_access(){
+    constexpr unsigned n = 16;
+    LedStripe layout(true, true, false, true);
+    LedCube<CRGB> cube(n, n, n, layout, true);
+    bench_report("cube LUT at() 16^3", bench_us([&](){
+        for (unsigned z = 0; z != n; ++z)
+            for (unsigned y = 0; y != n; ++y)
+                for (unsigned x = 0; x != n; ++x) cube.at(x, y, z) = voxel(x, y, z);
+    }, 1000), n * n * n);
+
+    PixelDataBuffer<CRGB> buff(n * n * n);
+    bench_report("cube transpose() 16^3", bench_us([&](){
+        for (unsigned z = 0; z != n; ++z)
+            for (unsigned y = 0; y != n; ++y)
+                for (unsigned x = 0; x != n; ++x){
+                    size_t t = layout.transpose(n, n, x, y);
+                    buff.at(z * n * n + (z & 1 ? n * n - 1 - t : t)) = voxel(x, y, z);
+                }
+    }, 1000), n * n * n);
+    TEST_ASSERT_EQUAL_MEMORY(buff.data().data(), cube.getBuffer()->data().data(), n * n * n * sizeof(CRGB));
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_index_table);
+    RUN_TEST(test_slices);
+    RUN_TEST(test_shift_and_planes);
+    RUN_TEST(bench_voxel_access);
+    return UNITY_END();
+}
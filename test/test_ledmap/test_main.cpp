@@ -0,0 +1,208 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// compiled topology map: build, serialize, zero-copy attach, load fallback and blob rejection
+#include <unity.h>
+#include <string.h>
+#include "ledmap.hpp"
+#include "bench.hpp"
+
+using header_t = LedMapLUT::header_t;
+
+void setUp(){}
+void tearDown(){}
+
+static void assert_matches(const LedMapLUT &map, const LedStripe &layout, uint16_t w, uint16_t h){
+    TEST_ASSERT_FALSE(map.empty());
+    TEST_ASSERT_EQUAL(w, map.w());
+    TEST_ASSERT_EQUAL(h, map.h());
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x)
+            TEST_ASSERT_EQUAL(layout.transpose(w, h, x, y), map.transpose(w, h, x, y));
+}
+
+// blob storage, aligned for index_t
+static std::vector<uint32_t> make_blob(const LedMapLUT &map){
+    std::vector<uint32_t> blob((map.blobSize() + 3) / 4);
+    TEST_ASSERT_EQUAL(map.blobSize(), map.serialize(blob.data(), blob.size() * 4));
+    return blob;
+}
+
+void test_build(){
+    LedStripe snake(true, true, false, true);
+    LedTiles tiles(8, 8, 3, 2, true);
+    LedMapLUT map;
+    TEST_ASSERT_TRUE(map.empty());
+    TEST_ASSERT_TRUE(map.build(snake, 13, 7));
+    assert_matches(map, snake, 13, 7);
+    TEST_ASSERT_EQUAL(LedMapLUT::makeKey(snake, 13, 7), map.key());
+    TEST_ASSERT_TRUE(map.build(tiles, 24, 16));
+    assert_matches(map, tiles, 24, 16);
+
+    // key depends on layout and dimensions
+    TEST_ASSERT_TRUE(LedMapLUT::makeKey(snake, 13, 7) != LedMapLUT::makeKey(LedStripe(), 13, 7));
+    TEST_ASSERT_TRUE(LedMapLUT::makeKey(snake, 13, 7) != LedMapLUT::makeKey(snake, 7, 13));
+    TEST_ASSERT_TRUE(LedMapLUT::makeKey(tiles, 24, 16) != LedMapLUT::makeKey(LedTiles(8, 8, 3, 2, false), 24, 16));
+}
+
+void test_size_limit(){
+    LedMapLUT map;
+    // largest table uses the whole index_t range
+    TEST_ASSERT_TRUE(map.build(LedStripe(false), 256, 256));
+    TEST_ASSERT_EQUAL(LedMapLUT::max_pixels, static_cast<size_t>(map.w()) * map.h());
+    TEST_ASSERT_EQUAL(UINT16_MAX, map.transpose(256, 256, 255, 255));
+
+    // one row more does not fit, map is left empty
+    TEST_ASSERT_FALSE(map.build(LedStripe(), 256, 257));
+    TEST_ASSERT_TRUE(map.empty());
+    TEST_ASSERT_EQUAL(0, map.blobSize());
+    TEST_ASSERT_FALSE(map.build(LedStripe(), 1024, 1024));
+    TEST_ASSERT_FALSE(map.build(LedStripe(), 0, 16));
+    TEST_ASSERT_TRUE(map.empty());
+
+    // oversized blob header is rejected
+    LedMapLUT small;
+    small.build(LedStripe(), 4, 4);
+    auto blob = make_blob(small);
+    header_t hdr;
+    memcpy(&hdr, blob.data(), sizeof(hdr));
+    hdr.w = 512; hdr.h = 512;
+    hdr.key = LedMapLUT::makeKey(LedStripe(), 512, 512);
+    memcpy(blob.data(), &hdr, sizeof(hdr));
+    TEST_ASSERT_FALSE(map.attach(blob.data(), SIZE_MAX / 2, hdr.key));
+}
+
+void test_serialize_attach(){
+    LedStripe layout(true, false, true);
+    LedMapLUT map;
+    map.build(layout, 10, 6);
+    TEST_ASSERT_EQUAL(sizeof(header_t) + 60 * sizeof(LedMapLUT::index_t), map.blobSize());
+
+    // buffer must fit the blob
+    std::vector<uint8_t> small(map.blobSize() - 1);
+    TEST_ASSERT_EQUAL(0, map.serialize(small.data(), small.size()));
+    TEST_ASSERT_EQUAL(0, map.serialize(nullptr, 1024));
+    TEST_ASSERT_EQUAL(0, LedMapLUT().serialize(small.data(), small.size()));
+
+    auto blob = make_blob(map);
+    header_t hdr;
+    memcpy(&hdr, blob.data(), sizeof(hdr));
+    TEST_ASSERT_EQUAL_HEX32(LedMapLUT::magic, hdr.magic);
+    TEST_ASSERT_EQUAL(LedMapLUT::version, hdr.version);
+    TEST_ASSERT_EQUAL(sizeof(LedMapLUT::index_t), hdr.index_size);
+    TEST_ASSERT_EQUAL(map.key(), hdr.key);
+
+    // aligned blob is referenced in place
+    LedMapLUT att;
+    TEST_ASSERT_TRUE(att.attach(blob.data(), map.blobSize(), map.key()));
+    TEST_ASSERT_TRUE(att.data() == reinterpret_cast<const LedMapLUT::index_t*>(reinterpret_cast<const uint8_t*>(blob.data()) + sizeof(header_t)));
+    assert_matches(att, layout, 10, 6);
+    TEST_ASSERT_EQUAL(map.key(), att.key());
+
+    // misaligned blob is copied
+    std::vector<uint8_t> shifted(map.blobSize() + 1);
+    memcpy(shifted.data() + 1, blob.data(), map.blobSize());
+    TEST_ASSERT_TRUE(att.attach(shifted.data() + 1, map.blobSize(), map.key()));
+    TEST_ASSERT_TRUE(reinterpret_cast<const uint8_t*>(att.data()) != shifted.data() + 1 + sizeof(header_t));
+    assert_matches(att, layout, 10, 6);
+}
+
+void test_attach_rejects(){
+    LedStripe layout;
+    LedMapLUT map;
+    map.build(layout, 8, 8);
+    auto blob = make_blob(map);
+    size_t len = map.blobSize();
+    uint32_t key = map.key();
+    LedMapLUT att;
+
+    TEST_ASSERT_FALSE(att.attach(nullptr, len, key));
+    TEST_ASSERT_FALSE(att.attach(blob.data(), sizeof(header_t) - 1, key));
+    // truncated table
+    TEST_ASSERT_FALSE(att.attach(blob.data(), len - 1, key));
+    // key mismatch, i.e. blob was built for another layout
+    TEST_ASSERT_FALSE(att.attach(blob.data(), len, LedMapLUT::makeKey(LedStripe(false), 8, 8)));
+    TEST_ASSERT_TRUE(att.empty());
+
+    // corrupted header fields
+    auto corrupt = [&](auto &&mod){
+        auto b = blob;
+        header_t hdr;
+        memcpy(&hdr, b.data(), sizeof(hdr));
+        mod(hdr);
+        memcpy(b.data(), &hdr, sizeof(hdr));
+        return att.attach(b.data(), len, key);
+    };
+    TEST_ASSERT_FALSE(corrupt([](header_t &h){ h.magic ^= 1; }));
+    TEST_ASSERT_FALSE(corrupt([](header_t &h){ ++h.version; }));
+    TEST_ASSERT_FALSE(corrupt([](header_t &h){ h.index_size = 4; }));
+    TEST_ASSERT_FALSE(corrupt([](header_t &h){ h.w = 0; }));
+    TEST_ASSERT_TRUE(att.empty());
+    TEST_ASSERT_TRUE(corrupt([](header_t &h){}));
+}
+
+void test_load_fallback(){
+    LedStripe layout(true), other(false, true);
+    LedMapLUT map;
+    map.build(layout, 16, 8);
+    auto blob = make_blob(map);
+    size_t len = map.blobSize();
+
+    // matching blob is attached
+    LedMapLUT l;
+    TEST_ASSERT_TRUE(l.load(blob.data(), len, layout, 16, 8));
+    TEST_ASSERT_TRUE(reinterpret_cast<const uint8_t*>(l.data()) == reinterpret_cast<const uint8_t*>(blob.data()) + sizeof(header_t));
+
+    // layout signature mismatch, map is recomputed for the requested layout
+    TEST_ASSERT_FALSE(l.load(blob.data(), len, other, 16, 8));
+    assert_matches(l, other, 16, 8);
+    TEST_ASSERT_EQUAL(LedMapLUT::makeKey(other, 16, 8), l.key());
+
+    // dimensions mismatch
+    TEST_ASSERT_FALSE(l.load(blob.data(), len, layout, 8, 16));
+    assert_matches(l, layout, 8, 16);
+
+    // no blob at all
+    TEST_ASSERT_FALSE(l.load(nullptr, 0, layout, 16, 8));
+    assert_matches(l, layout, 16, 8);
+
+    // recomputed map serializes to a blob that loads next time
+    auto fresh = make_blob(l);
+    LedMapLUT n;
+    TEST_ASSERT_TRUE(n.load(fresh.data(), l.blobSize(), layout, 16, 8));
+}
+
+// startup cost of a map, computed from layout vs loaded from a blob
+void bench_startup(){
+    LedTiles tiles(16, 16, 8, 8, true, false, false, true);
+    constexpr uint16_t w = 128, h = 128;
+    LedMapLUT map;
+    auto build_us = bench_us([&](){ map.build(tiles, w, h); }, 100);
+    bench_report("build tiled map 128x128", build_us, w * h);
+    auto blob = make_blob(map);
+    size_t len = map.blobSize();
+
+    LedMapLUT l;
+    auto attach_us = bench_us([&](){ l.load(blob.data(), len, tiles, w, h); }, 100);
+    bench_report("load (zero-copy) tiled map 128x128", attach_us, w * h);
+    std::vector<uint8_t> shifted(len + 1);
+    memcpy(shifted.data() + 1, blob.data(), len);
+    bench_report("load (copy) tiled map 128x128", bench_us([&](){ l.load(shifted.data() + 1, len, tiles, w, h); }, 100), w * h);
+    TEST_ASSERT_TRUE(l.load(blob.data(), len, tiles, w, h));
+    TEST_ASSERT_TRUE(attach_us < build_us);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_build);
+    RUN_TEST(test_size_limit);
+    RUN_TEST(test_serialize_attach);
+    RUN_TEST(test_attach_rejects);
+    RUN_TEST(test_load_fallback);
+    RUN_TEST(bench_startup);
+    return UNITY_END();
+}
@@ -0,0 +1,137 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// batched sparse pixel writes
+#include <unity.h>
+#include "pixelbatch.hpp"
+#include "bench.hpp"
+
+using op_t = PixelBatch<CRGB>::op_t;
+
+static uint32_t seed;
+static uint32_t rnd(){ seed = seed * 1664525 + 1013904223; return seed >> 8; }
+
+void setUp(){ seed = 1; }
+void tearDown(){}
+
+// snake canvas, so physical order differs from insertion order
+static void snake(LedFB<CRGB> &fb){
+    fb.setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return (y & 1) ? y * w + w - 1 - x : y * w + x; });
+}
+
+void test_ops_match_at(){
+    for (bool sort : {false, true}){
+        LedFB<CRGB> fb(16, 8), ref(16, 8);
+        snake(fb); snake(ref);
+        fb.fill(CRGB(100, 50, 200)); ref.fill(CRGB(100, 50, 200));
+        PixelBatch<CRGB> batch(4);
+        for (unsigned i = 0; i != 300; ++i){
+            // some writes are out of canvas, many hit the same pixels
+            int16_t x = rnd() % 20 - 2, y = rnd() % 10 - 1;
+            CRGB c(rnd(), rnd(), rnd());
+            op_t op = static_cast<op_t>(rnd() % 4);
+            uint8_t a = rnd();
+            batch.add(x, y, c, op, a);
+            CRGB &p = ref.at(x, y);
+            switch (op){
+            case op_t::set : p = c; break;
+            case op_t::add : p += c; break;
+            case op_t::blend : nblend(p, c, a); break;
+            case op_t::max : p = CRGB(std::max(p.r, c.r), std::max(p.g, c.g), std::max(p.b, c.b)); break;
+            }
+        }
+        TEST_ASSERT_EQUAL(300, batch.size());
+        batch.apply(fb, sort);
+        TEST_ASSERT_EQUAL_MEMORY(ref.span().data(), fb.span().data(), 16 * 8 * sizeof(CRGB));
+    }
+}
+
+void test_uniform_batches(){
+    for (op_t op : {op_t::set, op_t::add}){
+        LedFB<CRGB> fb(8, 8), ref(8, 8);
+        snake(fb); snake(ref);
+        fb.setWrap(LedFB<CRGB>::wrap_t::x); ref.setWrap(LedFB<CRGB>::wrap_t::x);
+        PixelBatch<CRGB> batch;
+        for (unsigned i = 0; i != 200; ++i){
+            int16_t x = rnd() % 24 - 8, y = rnd() % 8;
+            CRGB c(rnd() & 0x3f, rnd() & 0x3f, rnd() & 0x3f);
+            batch.add(x, y, c, op);
+            if (op == op_t::set) ref.at(x, y) = c; else ref.at(x, y) += c;
+        }
+        batch.apply(fb, true);
+        TEST_ASSERT_EQUAL_MEMORY(ref.span().data(), fb.span().data(), 8 * 8 * sizeof(CRGB));
+    }
+}
+
+void test_rgb565_ops(){
+    LedFB<uint16_t> fb(4, 4);
+    uint16_t base = LedFB_GFX::color565(CRGB(200, 100, 0));
+    fb.fill(base);
+    PixelBatch<uint16_t> batch;
+    // uniform add batch, channels saturate instead of overflowing into each other
+    batch.add(0, 0, LedFB_GFX::color565(CRGB(100, 200, 8)), PixelBatch<uint16_t>::op_t::add);
+    batch.add(1, 0, LedFB_GFX::color565(CRGB(0, 0, 255)), PixelBatch<uint16_t>::op_t::add);
+    batch.apply(fb, true);
+    TEST_ASSERT_EQUAL_HEX16(LedFB_GFX::color565(CRGB(255, 255, LedFB_GFX::colorCRGB(LedFB_GFX::color565(CRGB(0, 0, 8))).b)), fb.at(0, 0));
+    TEST_ASSERT_EQUAL_HEX16(LedFB_GFX::color565(CRGB(LedFB_GFX::colorCRGB(base).r, LedFB_GFX::colorCRGB(base).g, 255)), fb.at(1, 0));
+    TEST_ASSERT_EQUAL_HEX16(base, fb.at(2, 0));
+
+    batch.clear();
+    TEST_ASSERT_EQUAL(0, batch.size());
+    batch.add(3, 3, 0x1234);
+    batch.apply(fb);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, fb.at(3, 3));
+}
+
+// 512 scattered writes per frame on a 64x64 snake canvas, with topology mapper callback and with a compiled map
+void bench_batch_vs_at(){
+    constexpr uint16_t w = 64, h = 64;
+    constexpr size_t n = 512;
+    std::vector<int16_t> xs(n), ys(n);
+    std::vector<CRGB> cs(n);
+    for (size_t i = 0; i != n; ++i){ xs[i] = rnd() % w; ys[i] = rnd() % h; cs[i] = CRGB(rnd() & 7, rnd() & 7, rnd() & 7); }
+    LedFB<CRGB> fb(w, h);
+    snake(fb);
+    auto lut = std::make_shared<LedMapLUT>();
+    lut->build(LedStripe(true), w, h);
+    PixelBatch<CRGB> batch(n);
+    char name[64];
+
+    for (bool compiled : {false, true}){
+        if (compiled) TEST_ASSERT_TRUE(fb.setRemapLUT(lut));
+        const char *map = compiled ? "LUT" : "callback";
+        snprintf(name, sizeof(name), "%s: at() add", map);
+        bench_report(name, bench_us([&](){
+            for (size_t i = 0; i != n; ++i) fb.at(xs[i], ys[i]) += cs[i];
+        }, 2000), n);
+        for (bool sort : {false, true}){
+            snprintf(name, sizeof(name), "%s: batch uniform add%s", map, sort ? ", sorted" : "");
+            bench_report(name, bench_us([&](){
+                batch.clear();
+                for (size_t i = 0; i != n; ++i) batch.add(xs[i], ys[i], cs[i], op_t::add);
+                batch.apply(fb, sort);
+            }, 2000), n);
+            // a single write with another op turns off the uniform fast path
+            snprintf(name, sizeof(name), "%s: batch per-pixel dispatch%s", map, sort ? ", sorted" : "");
+            bench_report(name, bench_us([&](){
+                batch.clear();
+                batch.add(0, 0, CRGB(), op_t::max);
+                for (size_t i = 1; i != n; ++i) batch.add(xs[i], ys[i], cs[i], op_t::add);
+                batch.apply(fb, sort);
+            }, 2000), n);
+        }
+    }
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_ops_match_at);
+    RUN_TEST(test_uniform_batches);
+    RUN_TEST(test_rgb565_ops);
+    RUN_TEST(bench_batch_vs_at);
+    return UNITY_END();
+}
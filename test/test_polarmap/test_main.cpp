@@ -0,0 +1,145 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// precomputed polar coordinate maps
+#include <math.h>
+#include <unity.h>
+#include "ledfb.hpp"
+#include "bench.hpp"
+
+void setUp(){}
+void tearDown(){}
+
+static size_t row_major(unsigned x, unsigned y){ return y * 9 + x; }
+
+void test_angles_and_radii(){
+    PolarMap m;
+    TEST_ASSERT_FALSE(m.build(0, 9, row_major, 4, 4));
+    TEST_ASSERT_TRUE(m.build(9, 9, row_major, 4, 4));
+    TEST_ASSERT_EQUAL(81, m.size());
+    // 0 points to +X, grows towards +Y
+    TEST_ASSERT_EQUAL(0, m.angle16(row_major(8, 4)));
+    TEST_ASSERT_EQUAL(16384, m.angle16(row_major(4, 8)));
+    TEST_ASSERT_EQUAL(32768, m.angle16(row_major(0, 4)));
+    TEST_ASSERT_EQUAL(49152, m.angle16(row_major(4, 0)));
+    TEST_ASSERT_EQUAL(32, m.angle8(row_major(8, 8)));
+    TEST_ASSERT_EQUAL(0, m.radius16(row_major(4, 4)));
+    TEST_ASSERT_EQUAL(4 << 8, m.radius16(row_major(0, 4)));
+    TEST_ASSERT_EQUAL(5, m.radius(row_major(7, 0)));
+    TEST_ASSERT_EQUAL(lroundf(sqrtf(32) * 256), m.maxRadius());
+}
+
+void test_shared_maps(){
+    LedFB<CRGB> fb(8, 6);
+    auto a = fb.polarMap();
+    auto b = fb.polarMap(3.5f, 2.5f);
+    TEST_ASSERT_TRUE(a == b);
+    // other centre or topology gives another map
+    auto c = fb.polarMap(0, 0);
+    TEST_ASSERT_TRUE(a != c);
+    fb.setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return (h - 1 - y) * w + x; });
+    auto d = fb.polarMap();
+    TEST_ASSERT_TRUE(a != d);
+    // flipped vertically, up to truncation
+    TEST_ASSERT_INT_WITHIN(1, a->angle16(fb.index(7, 0)), 65536 - d->angle16(fb.index(7, 0)));
+
+    // cache does not keep maps alive, a map is rebuilt after all users have dropped it
+    std::weak_ptr<const PolarMap> wc(c);
+    c.reset();
+    TEST_ASSERT_TRUE(wc.expired());
+    fb.setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return y * w + x; });
+    auto e = fb.polarMap(0, 0);
+    TEST_ASSERT_EQUAL(0, e->radius16(fb.index(0, 0)));
+    TEST_ASSERT_EQUAL(7 << 8, e->radius16(fb.index(7, 0)));
+}
+
+void test_cache_key(){
+    // cached map is found without calling the mapper
+    size_t calls = 0;
+    auto counted = [&calls](unsigned x, unsigned y) -> size_t { ++calls; return row_major(x, y); };
+    uint64_t id = PolarMap::topologyId();
+    TEST_ASSERT_TRUE(id != PolarMap::topologyId());
+    auto a = PolarMap::get(9, 9, id, counted, 4, 4);
+    TEST_ASSERT_TRUE(calls >= 81);
+    calls = 0;
+    auto b = PolarMap::get(9, 9, id, counted, 4, 4);
+    TEST_ASSERT_TRUE(a == b);
+    TEST_ASSERT_EQUAL(0, calls);
+    // other topology id or dimensions build a new map
+    TEST_ASSERT_TRUE(a != PolarMap::get(9, 9, PolarMap::topologyId(), counted, 4, 4));
+    TEST_ASSERT_TRUE(a != PolarMap::get(9, 8, id, counted, 4, 4));
+
+    // canvases with same compiled map share polar maps, a custom mapper gets it's own
+    LedStripe snake(true);
+    auto lut = std::make_shared<LedMapLUT>();
+    lut->build(snake, 8, 6);
+    LedFB<CRGB> f1(8, 6), f2(8, 6), f3(8, 6);
+    TEST_ASSERT_TRUE(f1.setRemapLUT(lut));
+    TEST_ASSERT_TRUE(f2.setRemapLUT(lut));
+    f3.setRemapFunction([snake](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return snake.transpose(w, h, x, y); });
+    auto m1 = f1.polarMap(), m2 = f2.polarMap(), m3 = f3.polarMap();
+    TEST_ASSERT_TRUE(m1 == m2);
+    TEST_ASSERT_TRUE(m1 != m3);
+    TEST_ASSERT_EQUAL_MEMORY(m1->angles().data(), m3->angles().data(), 48 * sizeof(uint16_t));
+
+    // resize drops compiled map, canvas is back to row-major order
+    TEST_ASSERT_TRUE(f1.resize(4, 4));
+    LedFB<CRGB> plain(4, 4);
+    TEST_ASSERT_TRUE(f1.polarMap() == plain.polarMap());
+}
+
+void test_fill_skips_unmapped(){
+    // canvas rows are 6 pixels wide in a buffer with 8 pixel rows, last 2 slots of each row are not mapped
+    auto buff = std::make_shared<PixelDataBuffer<CRGB>>(8 * 4);
+    LedFB<CRGB> fb(6, 4, buff);
+    fb.setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return y * 8 + x; });
+    buff->fill(CRGB(1, 2, 3));
+    auto map = fb.polarMap();
+    TEST_ASSERT_EQUAL(8 * 3 + 6, map->size());
+    TEST_ASSERT_EQUAL(PolarMap::unmapped, map->radius16(6));
+
+    fb.fillPolar(*map, [](uint16_t a, uint16_t r){ return CRGB(a >> 8, r >> 8, 255); });
+    for (size_t i = 0; i != buff->size(); ++i){
+        if (i % 8 >= 6)
+            TEST_ASSERT_TRUE(buff->at(i) == CRGB(1, 2, 3));
+        else
+            TEST_ASSERT_TRUE(buff->at(i) == CRGB(map->angle8(i), map->radius(i), 255));
+    }
+}
+
+// a spiral on a 64x64 canvas, polar map vs per-pixel atan2f/sqrtf
+void bench_spiral(){
+    constexpr uint16_t w = 64, h = 64;
+    LedFB<CRGB> fb(w, h);
+    auto map = fb.polarMap();
+    auto spiral = [](uint16_t a, uint16_t r){ uint8_t v = (a >> 8) + (r >> 5); return CRGB(v, 255 - v, 0); };
+    bench_report("spiral polar map 64x64", bench_us([&](){ fb.fillPolar(*map, spiral); }, 1000), w * h);
+    bench_report("cached polar map lookup 64x64", bench_us([&](){ bench_sink = bench_sink + fb.polarMap()->size(); }, 1000), 1);
+
+    LedFB<CRGB> ref(w, h);
+    bench_report("spiral atan2f 64x64", bench_us([&](){
+        for (unsigned y = 0; y != h; ++y)
+            for (unsigned x = 0; x != w; ++x){
+                float dx = x - 31.5f, dy = y - 31.5f;
+                float a = atan2f(dy, dx);
+                if (a < 0) a += 2 * static_cast<float>(M_PI);
+                uint16_t a16 = static_cast<uint32_t>(a * (65536 / (2 * static_cast<float>(M_PI)))) & 0xffff;
+                ref.at(x, y) = spiral(a16, sqrtf(dx * dx + dy * dy) * 256 + 0.5f);
+            }
+    }, 1000), w * h);
+    TEST_ASSERT_EQUAL_MEMORY(ref.span().data(), fb.span().data(), w * h * sizeof(CRGB));
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_angles_and_radii);
+    RUN_TEST(test_shared_maps);
+    RUN_TEST(test_cache_key);
+    RUN_TEST(test_fill_skips_unmapped);
+    RUN_TEST(bench_spiral);
+    return UNITY_END();
+}
@@ -0,0 +1,132 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// framebuffer-less scanline rendering
+#include <unity.h>
+#include "scanline.hpp"
+#include "bench.hpp"
+
+void setUp(){}
+void tearDown(){}
+
+// test pattern in logical coordinates
+static CRGB pattern(unsigned x, unsigned y){ return CRGB(x * 7, y * 13, (x ^ y) * 3); }
+
+// render the same pattern into a full buffer in physical order and feed it to a sink
+static uint32_t reference_checksum(uint16_t w, uint16_t h, const LedStripe *layout){
+    std::vector<CRGB> buff(w * h);
+    for (unsigned y = 0; y != h; ++y)
+        for (unsigned x = 0; x != w; ++x)
+            buff[layout ? layout->transpose(w, h, x, y) : y * w + x] = pattern(x, y);
+    NullScanlineSink ref;
+    ref.begin(buff.size());
+    ref.write(buff.data(), buff.size());
+    ref.end();
+    return ref.checksum();
+}
+
+void test_chunks_cover_frame_in_order(){
+    auto sink = std::make_shared<NullScanlineSink>();
+    // chunk length is not a divisor of canvas size, last chunk is a partial one
+    ScanlineDisplayEngine e(10, 5, sink, nullptr, 7, 3);
+    size_t next = 0, calls = 0;
+    std::vector<const CRGB*> slots;
+    e.onRender([&](scanline_chunk_t &c){
+        TEST_ASSERT_EQUAL(next, c.start);
+        for (size_t i = 0; i != c.len; ++i){
+            TEST_ASSERT_EQUAL((c.start + i) % 10, c.x[i]);
+            TEST_ASSERT_EQUAL((c.start + i) / 10, c.y[i]);
+            c.px[i] = pattern(c.x[i], c.y[i]);
+        }
+        next += c.len;
+        ++calls;
+        slots.push_back(c.px);
+    });
+    e.show();
+
+    TEST_ASSERT_EQUAL(50, next);
+    TEST_ASSERT_EQUAL(8, calls);
+    TEST_ASSERT_EQUAL(1, sink->frames());
+    TEST_ASSERT_EQUAL(50, sink->pixels());
+    TEST_ASSERT_EQUAL_HEX32(reference_checksum(10, 5, nullptr), sink->checksum());
+    // chunks rotate through a ring of 3 slots
+    TEST_ASSERT_TRUE(slots[0] != slots[1] && slots[1] != slots[2] && slots[0] != slots[2]);
+    TEST_ASSERT_TRUE(slots[3] == slots[0] && slots[7] == slots[1]);
+    TEST_ASSERT_EQUAL((7 * 3) * sizeof(CRGB) + 7 * 2 * sizeof(uint16_t), e.memUsage());
+}
+
+void test_layout_matches_framebuffer(){
+    auto sink = std::make_shared<NullScanlineSink>();
+    auto layout = std::make_shared<LedStripe>(true, true, true, false);
+    ScanlineDisplayEngine e(12, 6, sink, layout);
+    e.onRender([](scanline_chunk_t &c){
+        for (size_t i = 0; i != c.len; ++i) c.px[i] = pattern(c.x[i], c.y[i]);
+    });
+    e.show();
+    TEST_ASSERT_EQUAL_HEX32(reference_checksum(12, 6, layout.get()), sink->checksum());
+    TEST_ASSERT_TRUE(reference_checksum(12, 6, nullptr) != sink->checksum());
+}
+
+void test_brightness_and_empty_render(){
+    auto sink = std::make_shared<NullScanlineSink>();
+    ScanlineDisplayEngine e(4, 4, sink);
+    // nothing is sent until render callback is set
+    e.show();
+    TEST_ASSERT_EQUAL(0, sink->frames());
+
+    e.onRender([](scanline_chunk_t &c){
+        for (size_t i = 0; i != c.len; ++i) c.px[i] = CRGB(200, 100, 50);
+    });
+    e.brightness(128);
+    e.show();
+    CRGB c(200, 100, 50);
+    c.nscale8_video(128);
+    std::vector<CRGB> expected(16, c);
+    NullScanlineSink ref;
+    ref.begin(16);
+    ref.write(expected.data(), expected.size());
+    ref.end();
+    TEST_ASSERT_EQUAL(1, sink->frames());
+    TEST_ASSERT_EQUAL_HEX32(ref.checksum(), sink->checksum());
+}
+
+// 64x64 snake canvas: scanline rendering vs drawing a full framebuffer and sending it
+void bench_scanline_vs_framebuffer(){
+    constexpr uint16_t w = 64, h = 64;
+    auto layout = std::make_shared<LedStripe>(true);
+    auto sink = std::make_shared<NullScanlineSink>();
+    ScanlineDisplayEngine e(w, h, sink, layout);
+    e.onRender([](scanline_chunk_t &c){
+        for (size_t i = 0; i != c.len; ++i) c.px[i] = pattern(c.x[i], c.y[i]);
+    });
+    bench_report("scanline 64x64", bench_us([&](){ e.show(); }, 500), w * h);
+
+    LedFB<CRGB> fb(w, h);
+    fb.setRemapFunction([layout](unsigned w, unsigned h, unsigned x, unsigned y){ return layout->transpose(w, h, x, y); });
+    NullScanlineSink ref;
+    bench_report("framebuffer 64x64", bench_us([&](){
+        for (unsigned y = 0; y != h; ++y)
+            for (unsigned x = 0; x != w; ++x)
+                fb.at(x, y) = pattern(x, y);
+        ref.begin(w * h);
+        ref.write(fb.span().data(), w * h);
+        ref.end();
+    }, 500), w * h);
+    TEST_ASSERT_EQUAL_HEX32(ref.checksum(), sink->checksum());
+    char msg[80];
+    snprintf(msg, sizeof(msg), "resident memory: scanline %u bytes, framebuffer %u bytes", unsigned(e.memUsage()), unsigned(w * h * sizeof(CRGB)));
+    TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_chunks_cover_frame_in_order);
+    RUN_TEST(test_layout_matches_framebuffer);
+    RUN_TEST(test_brightness_and_empty_render);
+    RUN_TEST(bench_scanline_vs_framebuffer);
+    return UNITY_END();
+}
@@ -0,0 +1,181 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// symmetry maps: mirror and radial run tables, rounding at radial sector edges, bounds of run copies
+#include <unity.h>
+#include <math.h>
+#include "ledfb.hpp"
+
+using sym_t = SymmetryMap::mode_t;
+
+void setUp(){}
+void tearDown(){}
+
+// encodes pixel's own coordinates into it's color
+static CRGB tag(unsigned x, unsigned y){ return CRGB(x, y, 1); }
+
+// canvas with fundamental region tagged, rest is black
+static void render(LedFB<CRGB> &fb, const SymmetryMap &map){
+    fb.clear();
+    for (unsigned y = 0; y != fb.h(); ++y)
+        for (unsigned x = 0; x != fb.w(); ++x)
+            if (map.fundamental(x, y)) fb.at(x, y) = tag(x, y);
+}
+
+// check every pixel is a copy of the expected source
+template <typename F>
+static void check_sources(LedFB<CRGB> &fb, F source){
+    for (unsigned y = 0; y != fb.h(); ++y)
+        for (unsigned x = 0; x != fb.w(); ++x){
+            unsigned sx, sy;
+            source(x, y, sx, sy);
+            if (!(fb.at(x, y) == tag(sx, sy))){
+                char msg[64];
+                snprintf(msg, sizeof(msg), "pixel %u,%u expected from %u,%u", x, y, sx, sy);
+                TEST_FAIL_MESSAGE(msg);
+            }
+        }
+}
+
+void test_mirror(){
+    // odd and even dimensions, parallel and snake chains
+    for (uint16_t w : {7, 8})
+        for (bool snake : {false, true}){
+            LedFB<CRGB> fb(w, 5);
+            fb.setRemapFunction([snake](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return LedStripe(snake).transpose(w, h, x, y); });
+            SymmetryMap map;
+            TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::mirror_x));
+            // right half of each row is a single backward or forward run in a chain
+            TEST_ASSERT_EQUAL(5, map.runs().size());
+            for (const auto &r : map.runs()) TEST_ASSERT_EQUAL(w / 2, r.len);
+            render(fb, map);
+            fb.mirror(map);
+            check_sources(fb, [w](unsigned x, unsigned y, unsigned &sx, unsigned &sy){ sx = x < (w + 1u) / 2 ? x : w - 1 - x; sy = y; });
+        }
+
+    LedFB<CRGB> fb(6, 9);
+    SymmetryMap map;
+    TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::mirror_y));
+    render(fb, map);
+    fb.mirror(map);
+    check_sources(fb, [](unsigned x, unsigned y, unsigned &sx, unsigned &sy){ sx = x; sy = y < 5 ? y : 8 - y; });
+
+    TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::quad));
+    render(fb, map);
+    fb.mirror(map);
+    check_sources(fb, [](unsigned x, unsigned y, unsigned &sx, unsigned &sy){ sx = x < 3 ? x : 5 - x; sy = y < 5 ? y : 8 - y; });
+}
+
+void test_octa(){
+    LedFB<CRGB> fb(8, 8);
+    SymmetryMap map;
+    TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::octa));
+    // fundamental region is a triangle of a quadrant
+    for (unsigned y = 0; y != 8; ++y)
+        for (unsigned x = 0; x != 8; ++x)
+            TEST_ASSERT_EQUAL(x < 4 && y < 4 && y <= x, map.fundamental(x, y));
+    render(fb, map);
+    fb.mirror(map);
+    check_sources(fb, [](unsigned x, unsigned y, unsigned &sx, unsigned &sy){
+        sx = x < 4 ? x : 7 - x; sy = y < 4 ? y : 7 - y;
+        if (sy > sx) std::swap(sx, sy);
+    });
+}
+
+void test_radial_quarter_turns(){
+    // 4 folds on an odd square canvas rotate pixel centers onto pixel centers, no rounding involved
+    LedFB<CRGB> fb(9, 9);
+    SymmetryMap map;
+    TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::radial, 4));
+    render(fb, map);
+    fb.mirror(map);
+    check_sources(fb, [](unsigned x, unsigned y, unsigned &sx, unsigned &sy){
+        // rotate back around (4,4) until pixel falls into the first quadrant [0, 90) degrees
+        int dx = x - 4, dy = y - 4;
+        while (!(dx == 0 && dy == 0) && !(dx > 0 && dy >= 0)){ int t = dx; dx = dy; dy = -t; }
+        sx = 4 + dx; sy = 4 + dy;
+    });
+}
+
+void test_radial_rounding(){
+    for (uint16_t side : {8, 11})
+        for (uint8_t folds : {3, 5, 6}){
+            LedFB<CRGB> fb(side, side);
+            SymmetryMap map;
+            TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::radial, folds));
+            render(fb, map);
+            fb.mirror(map);
+
+            float c = (side - 1) / 2.0f, sector = 2 * M_PI / folds;
+            for (unsigned y = 0; y != side; ++y)
+                for (unsigned x = 0; x != side; ++x){
+                    if (map.fundamental(x, y)){
+                        TEST_ASSERT_TRUE(fb.at(x, y) == tag(x, y));
+                        continue;
+                    }
+                    // copied pixel comes from a fundamental pixel nearest to it's exact rotated-back position
+                    CRGB p = fb.at(x, y);
+                    TEST_ASSERT_EQUAL(1, p.b);
+                    TEST_ASSERT_TRUE(map.fundamental(p.r, p.g));
+                    float dx = x - c, dy = y - c;
+                    float a = atan2f(dy, dx);
+                    if (a < 0) a += 2 * M_PI;
+                    int k = static_cast<int>(a / sector);
+                    float rx = c + dx * cosf(k * sector) + dy * sinf(k * sector);
+                    float ry = c - dx * sinf(k * sector) + dy * cosf(k * sector);
+                    TEST_ASSERT_TRUE(fabsf(rx - p.r) <= 0.5f + 1e-3f);
+                    TEST_ASSERT_TRUE(fabsf(ry - p.g) <= 0.5f + 1e-3f);
+                }
+
+            // corners rotated back fall outside of the canvas, they have no source and are rendered by an effect
+            if (folds == 5){
+                TEST_ASSERT_TRUE(map.fundamental(0, 0));
+                TEST_ASSERT_TRUE(map.fundamental(side - 1, 0));
+            }
+        }
+}
+
+void test_run_bounds(){
+    // map built for a canvas larger than the buffer it's applied to,
+    // reversed chain puts fundamental region at the end of the buffer and mirrored pixels at the start
+    LedFB<CRGB> fb(8, 8);
+    fb.setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return w * h - 1 - (y * w + x); });
+    SymmetryMap map;
+    TEST_ASSERT_TRUE(fb.buildSymmetry(map, sym_t::quad));
+    std::vector<CRGB> data(64);
+    constexpr size_t len = 40;
+    for (size_t i = 0; i != len; ++i) data[i] = CRGB(i, 0, 0);
+    for (size_t i = len; i != data.size(); ++i) data[i] = CRGB(255, 0, 0);
+    map.apply(data.data(), len);
+    // nothing is read or written past the end, runs with sources in range are still copied
+    size_t copied = 0;
+    for (size_t i = 0; i != len; ++i){
+        TEST_ASSERT_TRUE(data[i].r != 255);
+        copied += data[i].r != i;
+    }
+    TEST_ASSERT_TRUE(copied > 0);
+    for (size_t i = len; i != data.size(); ++i) TEST_ASSERT_TRUE(data[i] == CRGB(255, 0, 0));
+
+    // map of other dimensions is not applied by a canvas
+    LedFB<CRGB> small(4, 4);
+    small.fill(CRGB(9, 9, 9));
+    small.at(0, 0) = CRGB(7, 7, 7);
+    small.mirror(map);
+    TEST_ASSERT_TRUE(small.at(3, 3) == CRGB(9, 9, 9));
+    TEST_ASSERT_EQUAL(8, map.w());
+    TEST_ASSERT_EQUAL(8, map.h());
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_mirror);
+    RUN_TEST(test_octa);
+    RUN_TEST(test_radial_quarter_turns);
+    RUN_TEST(test_radial_rounding);
+    RUN_TEST(test_run_bounds);
+    return UNITY_END();
+}
@@ -0,0 +1,158 @@
+/*
+    This file is a part of LedFB library project
+    https://github.com/vortigont/LedFB
+
+    Copyright © 2023-2024 Emil Muratov (vortigont)
+*/
+
+// wrap-around (cylindrical / toroidal) addressing
+#include <unity.h>
+#include "ledfb.hpp"
+#include "bench.hpp"
+
+using wrap_t = LedFB<CRGB>::wrap_t;
+
+void setUp(){}
+void tearDown(){}
+
+// reference wrap, always a modulo
+static int wrap_ref(int v, int len){ return ((v % len) + len) % len; }
+
+// coordinates around edges, far away from canvas and at int16 limits
+static const int16_t coords[] = {0, 1, -1, 2, -2, 3, -3, 4, 5, 7, 8, 9, 15, 16, 17, -15, -16, -17, 31, 32, 33, -33, 100, -100, 1000, -1000, 32767, -32768, 32766, -32767};
+
+void test_wrapped_at_matches_modulo(){
+    // power-of-two and odd dimensions take different paths
+    for (uint16_t w : {1, 2, 3, 5, 8, 16, 17}){
+        for (uint16_t h : {1, 4, 7}){
+            LedFB<CRGB> fb(w, h);
+            fb.setWrap(wrap_t::both);
+            for (int16_t x : coords)
+                for (int16_t y : coords)
+                    TEST_ASSERT_TRUE(&fb.at(x, y) == &fb.at_unchecked(wrap_ref(x, w), wrap_ref(y, h)));
+        }
+    }
+}
+
+void test_single_axis_wrap(){
+    LedFB<CRGB> fb(6, 4);
+    CRGB *stub = &fb.at(-1, -1);
+    fb.setWrap(wrap_t::x);
+    TEST_ASSERT_TRUE(&fb.at(-1, 2) == &fb.at_unchecked(5, 2));
+    TEST_ASSERT_TRUE(&fb.at(13, 0) == &fb.at_unchecked(1, 0));
+    TEST_ASSERT_TRUE(&fb.at(0, 4) == stub);
+    TEST_ASSERT_TRUE(&fb.at(0, -1) == stub);
+    fb.setWrap(wrap_t::y);
+    TEST_ASSERT_TRUE(&fb.at(1, -1) == &fb.at_unchecked(1, 3));
+    TEST_ASSERT_TRUE(&fb.at(6, 0) == stub);
+    fb.setWrap(wrap_t::none);
+    TEST_ASSERT_TRUE(&fb.at(1, -1) == stub);
+
+    // masks follow canvas resize, 6 -> 8 switches to power-of-two path and back
+    fb.setWrap(wrap_t::both);
+    TEST_ASSERT_TRUE(fb.resize(8, 4));
+    TEST_ASSERT_TRUE(&fb.at(-1, 5) == &fb.at_unchecked(7, 1));
+    TEST_ASSERT_TRUE(fb.resize(5, 3));
+    TEST_ASSERT_TRUE(&fb.at(-1, 5) == &fb.at_unchecked(4, 2));
+
+    // wrapped coordinates of a long stripe do not fit int16
+    LedFB<CRGB> stripe(40000, 1);
+    stripe.setWrap(wrap_t::x);
+    // last pixel is addressed by index, x = 39999 does not fit accessor's int16 coordinates either
+    TEST_ASSERT_TRUE(&stripe.at(-1, 0) == &stripe.at_unchecked(static_cast<size_t>(39999)));
+}
+
+void test_empty_canvas_wrap(){
+    auto buff = std::make_shared<PixelDataBuffer<CRGB>>(0);
+    LedFB<CRGB> fb(0, 0, buff);
+    fb.setWrap(wrap_t::both);
+    // nothing to wrap to, all coordinates are out of canvas
+    TEST_ASSERT_TRUE(&fb.at(0, 0) == &buff->stub_pixel);
+    TEST_ASSERT_TRUE(&fb.at(-5, 7) == &buff->stub_pixel);
+    int16_t x = 3, y = -3;
+    uint32_t idx;
+    fb.index(&x, &y, 1, &idx);
+    TEST_ASSERT_EQUAL(LedFB<CRGB>::npos, idx);
+}
+
+void test_batch_index_and_blit(){
+    LedFB<CRGB> fb(5, 4);
+    fb.setRemapFunction([](unsigned w, unsigned h, unsigned x, unsigned y) -> size_t { return (y & 1) ? y * w + w - 1 - x : y * w + x; });
+    for (wrap_t mode : {wrap_t::none, wrap_t::x, wrap_t::y, wrap_t::both}){
+        fb.setWrap(mode);
+        std::vector<int16_t> xs, ys;
+        for (int16_t x : coords)
+            for (int16_t y : coords){ xs.push_back(x); ys.push_back(y); }
+        std::vector<uint32_t> idx(xs.size());
+        fb.index(xs.data(), ys.data(), xs.size(), idx.data());
+        for (size_t i = 0; i != xs.size(); ++i){
+            CRGB *p = &fb.at(xs[i], ys[i]);
+            if (idx[i] == LedFB<CRGB>::npos)
+                TEST_ASSERT_TRUE(p == &fb.at(-1, -1) || mode != wrap_t::none);
+            else
+                TEST_ASSERT_TRUE(p == &fb.span()[idx[i]]);
+        }
+    }
+
+    // a block crossing the corner of a torus comes out on all four corners
+    fb.setWrap(wrap_t::both);
+    fb.clear();
+    CRGB block[4] = {CRGB(1, 0, 0), CRGB(2, 0, 0), CRGB(3, 0, 0), CRGB(4, 0, 0)};
+    fb.blit(-1, -1, block, 2, 2);
+    TEST_ASSERT_TRUE(fb.at_unchecked(4, 3) == block[0]);
+    TEST_ASSERT_TRUE(fb.at_unchecked(0, 3) == block[1]);
+    TEST_ASSERT_TRUE(fb.at_unchecked(4, 0) == block[2]);
+    TEST_ASSERT_TRUE(fb.at_unchecked(0, 0) == block[3]);
+}
+
+void test_scroll_wraps(){
+    LedFB<CRGB> fb(5, 3), ref(5, 3);
+    for (unsigned y = 0; y != 3; ++y)
+        for (unsigned x = 0; x != 5; ++x) ref.at(x, y) = fb.at(x, y) = CRGB(x, y, 0);
+    fb.setWrap(wrap_t::both);
+    fb.scroll(-7, 4);
+    for (int y = 0; y != 3; ++y)
+        for (int x = 0; x != 5; ++x)
+            TEST_ASSERT_TRUE(fb.at(x, y) == ref.at(wrap_ref(x + 7, 5), wrap_ref(y - 4, 3)));
+
+    // without wrap vacated pixels are filled
+    fb.setWrap(wrap_t::y);
+    fb.scroll(2, 0, CRGB(9, 9, 9));
+    TEST_ASSERT_TRUE(fb.at(0, 0) == CRGB(9, 9, 9) && fb.at(1, 2) == CRGB(9, 9, 9));
+}
+
+// wrapped scattered writes on 30x16 (odd) and 32x16 (power-of-two) cylinders
+void bench_wrapped_at(){
+    std::vector<int16_t> xs(4096), ys(4096);
+    uint32_t seed = 1;
+    for (size_t i = 0; i != xs.size(); ++i){
+        seed = seed * 1664525 + 1013904223;
+        xs[i] = static_cast<int16_t>(seed >> 16) % 96 - 32;
+        ys[i] = static_cast<int16_t>(seed >> 8 & 0xff) % 16;
+    }
+    for (uint16_t w : {30, 32}){
+        LedFB<CRGB> fb(w, 16);
+        fb.setWrap(wrap_t::x);
+        char name[48];
+        snprintf(name, sizeof(name), "wrapped at() %ux16", w);
+        bench_report(name, bench_us([&](){
+            for (size_t i = 0; i != xs.size(); ++i) fb.at(xs[i], ys[i]) += CRGB(1, 1, 1);
+        }, 1000), xs.size());
+        fb.setWrap(wrap_t::none);
+        snprintf(name, sizeof(name), "clipped at() %ux16", w);
+        bench_report(name, bench_us([&](){
+            for (size_t i = 0; i != xs.size(); ++i) fb.at(xs[i], ys[i]) += CRGB(1, 1, 1);
+        }, 1000), xs.size());
+    }
+}
+
+int main(int argc, char **argv){
+    UNITY_BEGIN();
+    RUN_TEST(test_wrapped_at_matches_modulo);
+    RUN_TEST(test_single_axis_wrap);
+    RUN_TEST(test_empty_canvas_wrap);
+    RUN_TEST(test_batch_index_and_blit);
+    RUN_TEST(test_scroll_wraps);
+    RUN_TEST(bench_wrapped_at);
+    return UNITY_END();
+}